@@ -0,0 +1,177 @@
+using System;
+using System.Runtime.InteropServices;
+using AOT;
+using Unity.UIWidgets.foundation;
+using Unity.UIWidgets.ui;
+using UnityEngine;
+
+namespace Unity.UIWidgets.engine {
+    public class UIWidgetsHeadlessPanel : IDisposable {
+        // Called on the raster thread for every presented frame. The pixels are kN32 premultiplied and only valid
+        // until the callback returns.
+        public delegate void FrameCallback(IntPtr pixels, int rowBytes, int width, int height, long frameNumber);
+
+        IntPtr _ptr;
+        GCHandle _handle;
+
+        readonly Action _main;
+        readonly FrameCallback _frameCallback;
+
+        public Isolate isolate { get; private set; }
+
+        public UIWidgetsHeadlessPanel(Action main, FrameCallback frameCallback = null) {
+            D.assert(main != null);
+            _main = main;
+            _frameCallback = frameCallback;
+
+            _handle = GCHandle.Alloc(this);
+            _ptr = UIWidgetsHeadlessPanel_constructor((IntPtr) _handle,
+                entrypointCallback: _entrypointCallback,
+                frameCallback: _frameCallbackDelegate);
+        }
+
+        // A maxFrameRate of zero renders frames as fast as they are scheduled. A non-zero rasterTileSize
+        // rasterizes each frame in tiles of that many pixels on several threads. rasterCacheAsyncPopulation
+        // rasterizes raster cache entries on worker threads instead of during the frame that first uses them.
+        public bool enable(int width, int height, float devicePixelRatio, string fontSettings,
+            int maxFrameRate = 0, int rasterTileSize = 0, bool rasterCacheAsyncPopulation = false) {
+            D.assert(_ptr != IntPtr.Zero);
+            return UIWidgetsHeadlessPanel_onEnable(_ptr, (UIntPtr) width, (UIntPtr) height, devicePixelRatio,
+                Application.streamingAssetsPath, fontSettings, maxFrameRate, (UIntPtr) rasterTileSize,
+                rasterCacheAsyncPopulation);
+        }
+
+        public void disable() {
+            if (_ptr != IntPtr.Zero) {
+                UIWidgetsHeadlessPanel_onDisable(_ptr);
+            }
+        }
+
+        public void setViewport(int width, int height, float devicePixelRatio) {
+            UIWidgetsHeadlessPanel_setViewport(_ptr, width, height, devicePixelRatio);
+        }
+
+        public void sendPointerEvents(UIWidgetsPointerEvent[] events) {
+            if (events == null || events.Length == 0) {
+                return;
+            }
+
+            UIWidgetsHeadlessPanel_sendPointerEvents(_ptr, events, events.Length);
+        }
+
+        public long frameCount {
+            get { return UIWidgetsHeadlessPanel_getFrameCount(_ptr); }
+        }
+
+        // The per stage timings of the frames rendered since the last call with reset as JSON, or an empty
+        // string while the panel is disabled.
+        public string getFrameStageTimings(bool reset = false) {
+            IntPtr timings = UIWidgetsHeadlessPanel_getFrameStageTimings(_ptr, reset);
+            try {
+                return Marshal.PtrToStringAnsi(timings);
+            }
+            finally {
+                UIWidgetsHeadlessPanel_freeFrameStageTimings(timings);
+            }
+        }
+
+        public void Dispose() {
+            if (_ptr != IntPtr.Zero) {
+                UIWidgetsHeadlessPanel_onDisable(_ptr);
+                UIWidgetsHeadlessPanel_dispose(_ptr);
+                _ptr = IntPtr.Zero;
+            }
+
+            if (_handle.IsAllocated) {
+                _handle.Free();
+            }
+        }
+
+        void _entryPoint() {
+            try {
+                isolate = Isolate.current;
+                _main();
+            }
+            catch (Exception ex) {
+                Debug.LogException(new Exception("exception in main", innerException: ex));
+            }
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        public struct UIWidgetsPointerEvent {
+            public UIntPtr structSize;
+            public int phase;
+            public UIntPtr timestamp;
+            public float x;
+            public float y;
+            public int device;
+            public int signalKind;
+            public float scrollDeltaX;
+            public float scrollDeltaY;
+            public int deviceKind;
+            public long buttons;
+            public long modifier;
+        }
+
+        delegate void UIWidgetsHeadlessPanel_EntrypointCallback(IntPtr handle);
+
+        delegate void UIWidgetsHeadlessPanel_FrameCallback(IntPtr handle, IntPtr pixels, UIntPtr rowBytes,
+            UIntPtr width, UIntPtr height, long frameNumber);
+
+        // The native panel keeps calling these, so they must not be collected.
+        static readonly UIWidgetsHeadlessPanel_EntrypointCallback _entrypointCallback =
+            UIWidgetsHeadlessPanel_entrypoint;
+
+        static readonly UIWidgetsHeadlessPanel_FrameCallback _frameCallbackDelegate = UIWidgetsHeadlessPanel_frame;
+
+        [MonoPInvokeCallback(typeof(UIWidgetsHeadlessPanel_EntrypointCallback))]
+        static void UIWidgetsHeadlessPanel_entrypoint(IntPtr handle) {
+            var gcHandle = (GCHandle) handle;
+            var panel = (UIWidgetsHeadlessPanel) gcHandle.Target;
+            panel._entryPoint();
+        }
+
+        [MonoPInvokeCallback(typeof(UIWidgetsHeadlessPanel_FrameCallback))]
+        static void UIWidgetsHeadlessPanel_frame(IntPtr handle, IntPtr pixels, UIntPtr rowBytes,
+            UIntPtr width, UIntPtr height, long frameNumber) {
+            var gcHandle = (GCHandle) handle;
+            var panel = (UIWidgetsHeadlessPanel) gcHandle.Target;
+            panel._frameCallback?.Invoke(pixels, (int) rowBytes, (int) width, (int) height, frameNumber);
+        }
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern IntPtr UIWidgetsHeadlessPanel_constructor(IntPtr handle,
+            UIWidgetsHeadlessPanel_EntrypointCallback entrypointCallback,
+            UIWidgetsHeadlessPanel_FrameCallback frameCallback);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern void UIWidgetsHeadlessPanel_dispose(IntPtr ptr);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        static extern bool UIWidgetsHeadlessPanel_onEnable(IntPtr ptr, UIntPtr width, UIntPtr height,
+            float devicePixelRatio, string streamingAssetsPath, string settings, int maxFrameRate,
+            UIntPtr rasterTileSize, [MarshalAs(UnmanagedType.U1)] bool rasterCacheAsyncPopulation);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern void UIWidgetsHeadlessPanel_onDisable(IntPtr ptr);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern void UIWidgetsHeadlessPanel_setViewport(IntPtr ptr, int width, int height,
+            float devicePixelRatio);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern void UIWidgetsHeadlessPanel_sendPointerEvents(IntPtr ptr, UIWidgetsPointerEvent[] events,
+            int count);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern long UIWidgetsHeadlessPanel_getFrameCount(IntPtr ptr);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern IntPtr UIWidgetsHeadlessPanel_getFrameStageTimings(IntPtr ptr,
+            [MarshalAs(UnmanagedType.U1)] bool reset);
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern void UIWidgetsHeadlessPanel_freeFrameStageTimings(IntPtr timings);
+    }
+}
@@ -325,13 +325,7 @@ namespace Unity.UIWidgets.painting {
             }
 
             _needsLayout = false;
-            if (_paragraph == null) {
-                var builder = new ParagraphBuilder(_createParagraphStyle());
-                _text.build(builder, textScaleFactor: textScaleFactor,
-                    dimensions: _placeholderDimensions);
-                _inlinePlaceholderScales = builder.placeholderScales;
-                _paragraph = builder.build();
-            }
+            _ensureParagraph();
 
             _lastMinWidth = minWidth;
             _lastMaxWidth = maxWidth;
@@ -346,6 +340,70 @@ namespace Unity.UIWidgets.painting {
             _inlinePlaceholderBoxes = _paragraph.getBoxesForPlaceholders();
         }
 
+        // Lays out all |painters| like layout does, but lays out their paragraphs
+        // together, which the engine does in parallel.
+        public static void layoutAll(IList<TextPainter> painters, float minWidth = 0.0f,
+            float maxWidth = float.PositiveInfinity) {
+            var pending = new List<TextPainter>();
+            foreach (var painter in painters) {
+                Debug.Assert(painter.text != null,
+                    "TextPainter.text must be set to a non-null value before using the TextPainter.");
+                Debug.Assert(painter.textDirection != null,
+                    "TextPainter.textDirection must be set to a non-null value before using the TextPainter.");
+                if (!painter._needsLayout && minWidth == painter._lastMinWidth &&
+                    maxWidth == painter._lastMaxWidth) {
+                    continue;
+                }
+
+                painter._needsLayout = false;
+                painter._ensureParagraph();
+                painter._lastMinWidth = minWidth;
+                painter._lastMaxWidth = maxWidth;
+                pending.Add(painter);
+            }
+
+            if (pending.Count == 0) {
+                return;
+            }
+
+            var paragraphs = new List<Paragraph>(pending.Count);
+            var constraints = new List<ParagraphConstraints>(pending.Count);
+            foreach (var painter in pending) {
+                paragraphs.Add(painter._paragraph);
+                constraints.Add(new ParagraphConstraints(maxWidth));
+            }
+
+            Paragraph.layoutBatch(paragraphs, constraints);
+
+            if (minWidth != maxWidth) {
+                paragraphs.Clear();
+                constraints.Clear();
+                foreach (var painter in pending) {
+                    var newWidth = MathUtils.clamp(painter.maxIntrinsicWidth, minWidth, maxWidth);
+                    if (newWidth != painter.width) {
+                        paragraphs.Add(painter._paragraph);
+                        constraints.Add(new ParagraphConstraints(newWidth));
+                    }
+                }
+
+                Paragraph.layoutBatch(paragraphs, constraints);
+            }
+
+            foreach (var painter in pending) {
+                painter._inlinePlaceholderBoxes = painter._paragraph.getBoxesForPlaceholders();
+            }
+        }
+
+        void _ensureParagraph() {
+            if (_paragraph == null) {
+                var builder = new ParagraphBuilder(_createParagraphStyle());
+                _text.build(builder, textScaleFactor: textScaleFactor,
+                    dimensions: _placeholderDimensions);
+                _inlinePlaceholderScales = builder.placeholderScales;
+                _paragraph = builder.build();
+            }
+        }
+
         public void paint(Canvas canvas, Offset offset) {
             Debug.Assert(!_needsLayout);
             canvas.drawParagraph(_paragraph, offset);
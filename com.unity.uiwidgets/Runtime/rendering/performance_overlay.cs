@@ -7,6 +7,7 @@ namespace Unity.UIWidgets.rendering {
         visualizeRasterizerStatistics,
         displayEngineStatistics,
         visualizeEngineStatistics,
+        displayTextCacheStatistics,
     }
 
 
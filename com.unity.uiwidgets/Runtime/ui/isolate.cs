@@ -19,6 +19,10 @@ namespace Unity.UIWidgets.ui {
 
         bool _inShutdown = false;
 
+        // The ids of the text styles registered with the font collection of this isolate, see
+        // ParagraphBuilder.pushStyle.
+        internal readonly Dictionary<TextStyle, int> textStyleIds = new Dictionary<TextStyle, int>();
+
         internal void addNativeWrapper(NativeWrapper wrapper) {
             lock (_nativeWrappers) {
                 _nativeWrappers.putIfAbsent(wrapper._ptr, ()=>new WeakReference<NativeWrapper>(wrapper));
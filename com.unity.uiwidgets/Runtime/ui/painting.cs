@@ -442,7 +442,7 @@ namespace Unity.UIWidgets.ui {
         // If you add more fields, remember to update _kDataByteCount.
         const int _kDataByteCount = 56;
 
-        object[] _objects;
+        internal object[] _objects;
         internal IntPtr[] _objectPtrs;
         const int _kShaderIndex = 0;
         const int _kColorFilterIndex = 1;
@@ -736,11 +736,32 @@ namespace Unity.UIWidgets.ui {
         }
     }
 
+    // The counters of the cache the engine decodes paints of the current isolate
+    // through, e.g. to check how many of them a frame reuses.
+    public static class PaintCache {
+        public static ulong entryCount => (ulong) PaintCache_entryCount();
+
+        public static ulong hitCount => (ulong) PaintCache_hitCount();
+
+        public static ulong missCount => (ulong) PaintCache_missCount();
+
+        [DllImport(NativeBindings.dllName)]
+        static extern UIntPtr PaintCache_entryCount();
+
+        [DllImport(NativeBindings.dllName)]
+        static extern UIntPtr PaintCache_hitCount();
+
+        [DllImport(NativeBindings.dllName)]
+        static extern UIntPtr PaintCache_missCount();
+    }
+
 
     public enum ImageByteFormat {
         rawRgba,
         rawUnmodified,
         png,
+        jpeg,
+        webp,
     }
 
     public enum PixelFormat {
@@ -775,15 +796,19 @@ namespace Unity.UIWidgets.ui {
 
         public int height => Image_height(_ptr);
 
+        // The quality of JPEG and WebP images, from 0 to 100.
+        public const int kDefaultEncodeQuality = 90;
+
         public Future<byte[]> toByteData(
-            ImageByteFormat format = ImageByteFormat.rawRgba
+            ImageByteFormat format = ImageByteFormat.rawRgba,
+            int quality = kDefaultEncodeQuality
         ) {
             return ui_._futurize(
                 (_Callback<byte[]> callback) => {
                     GCHandle callbackHandle = GCHandle.Alloc(callback);
 
                     IntPtr error = Image_toByteData(_ptr,
-                        (int) format, _toByteDataCallback, (IntPtr) callbackHandle);
+                        (int) format, quality, _toByteDataCallback, (IntPtr) callbackHandle);
                     if (error != IntPtr.Zero) {
                         callbackHandle.Free();
                         return Marshal.PtrToStringAnsi(error);
@@ -817,7 +842,68 @@ namespace Unity.UIWidgets.ui {
                 Debug.LogException(ex);
             }
         }
-        
+
+        // Encodes the image like toByteData, but hands the encoded bytes to onChunk as they are produced
+        // instead of collecting them. The future completes with false if the image could not be encoded.
+        public Future<bool> toByteChunks(
+            Action<byte[]> onChunk,
+            ImageByteFormat format = ImageByteFormat.png,
+            int quality = kDefaultEncodeQuality
+        ) {
+            return ui_._futurize(
+                (_Callback<bool> callback) => {
+                    GCHandle callbackHandle = GCHandle.Alloc(new _ByteChunksState(onChunk, callback));
+
+                    IntPtr error = Image_toByteChunks(_ptr,
+                        (int) format, quality, _toByteChunksCallback, (IntPtr) callbackHandle);
+                    if (error != IntPtr.Zero) {
+                        callbackHandle.Free();
+                        return Marshal.PtrToStringAnsi(error);
+                    }
+
+                    return null;
+                });
+        }
+
+        class _ByteChunksState {
+            internal _ByteChunksState(Action<byte[]> onChunk, _Callback<bool> callback) {
+                this.onChunk = onChunk;
+                this.callback = callback;
+            }
+
+            internal readonly Action<byte[]> onChunk;
+            internal readonly _Callback<bool> callback;
+        }
+
+        [MonoPInvokeCallback(typeof(Image_toByteChunksCallback))]
+        static void _toByteChunksCallback(IntPtr callbackHandle, IntPtr data, int length,
+            [MarshalAs(UnmanagedType.U1)] bool isLast) {
+            GCHandle handle = (GCHandle) callbackHandle;
+            var state = (_ByteChunksState) handle.Target;
+            if (isLast) {
+                handle.Free();
+            }
+
+            if (!Isolate.checkExists()) {
+                return;
+            }
+
+            try {
+                if (data != IntPtr.Zero && length > 0) {
+                    var bytes = new byte[length];
+                    Marshal.Copy(data, bytes, 0, length);
+                    state.onChunk(bytes);
+                }
+
+                if (isLast) {
+                    state.callback(data != IntPtr.Zero && length > 0);
+                }
+            }
+            catch (Exception ex) {
+                Debug.LogException(ex);
+            }
+        }
+
         public override string ToString() => $"[{width}\u00D7{height}]";
 
         [DllImport(NativeBindings.dllName)]
@@ -832,8 +918,15 @@ namespace Unity.UIWidgets.ui {
         delegate void Image_toByteDataCallback(IntPtr callbackHandle, IntPtr data, int length);
 
         [DllImport(NativeBindings.dllName)]
-        static extern IntPtr Image_toByteData(IntPtr ptr, int format, Image_toByteDataCallback callback,
-            IntPtr callbackHandle);
+        static extern IntPtr Image_toByteData(IntPtr ptr, int format, int quality,
+            Image_toByteDataCallback callback, IntPtr callbackHandle);
+
+        delegate void Image_toByteChunksCallback(IntPtr callbackHandle, IntPtr data, int length,
+            [MarshalAs(UnmanagedType.U1)] bool isLast);
+
+        [DllImport(NativeBindings.dllName)]
+        static extern IntPtr Image_toByteChunks(IntPtr ptr, int format, int quality,
+            Image_toByteChunksCallback callback, IntPtr callbackHandle);
 
         public bool Equals(Image other) {
             return other != null && width == other.width && height == other.height && _ptr.Equals(other._ptr);
@@ -1001,6 +1094,72 @@ namespace Unity.UIWidgets.ui {
             IntPtr callbackHandle, _ImageInfo imageInfo, bool hasImageInfo, int targetWidth, int targetHeight);
     }
 
+    // A codec for an image whose encoded data arrives in chunks, e.g. while it is downloaded.
+    // The rows decoded so far are passed to onProgress at most once per minPublishInterval,
+    // getNextFrame completes with the whole image once the last chunk was added and decoded.
+    public class ProgressiveCodec : Codec {
+        public ProgressiveCodec(Action<FrameInfo> onProgress = null, TimeSpan? minPublishInterval = null)
+            : this(onProgress == null ? default : GCHandle.Alloc(onProgress),
+                (int) (minPublishInterval ?? TimeSpan.FromMilliseconds(100)).TotalMilliseconds) {
+        }
+
+        ProgressiveCodec(GCHandle progressHandle, int minPublishIntervalMillis)
+            : base(ProgressiveCodec_constructor(
+                progressHandle.IsAllocated ? _progressCallback : (ProgressiveCodec_progressCallback) null,
+                GCHandle.ToIntPtr(progressHandle), minPublishIntervalMillis)) {
+            _progressHandle = progressHandle;
+        }
+
+        GCHandle _progressHandle;
+
+        // May run on the finalizer thread. ProgressiveCodec_dispose only returns once the progress callback is
+        // cleared and not running, so the handle is freed after native code is done with it.
+        public override void DisposePtr(IntPtr ptr) {
+            ProgressiveCodec_dispose(ptr);
+            if (_progressHandle.IsAllocated) {
+                _progressHandle.Free();
+            }
+        }
+
+        public unsafe void addChunk(byte[] chunk, bool isLast = false) {
+            fixed (byte* bytes = chunk) {
+                IntPtr error = ProgressiveCodec_addChunk(_ptr, bytes, chunk?.Length ?? 0, isLast);
+                if (error != IntPtr.Zero) {
+                    throw new Exception(Marshal.PtrToStringAnsi(error));
+                }
+            }
+        }
+
+        [MonoPInvokeCallback(typeof(ProgressiveCodec_progressCallback))]
+        static void _progressCallback(IntPtr callbackHandle, IntPtr ptr) {
+            GCHandle handle = GCHandle.FromIntPtr(callbackHandle);
+            var callback = (Action<FrameInfo>) handle.Target;
+
+            if (!Isolate.checkExists()) {
+                return;
+            }
+
+            try {
+                callback(new FrameInfo(ptr));
+            }
+            catch (Exception ex) {
+                Debug.LogException(ex);
+            }
+        }
+
+        delegate void ProgressiveCodec_progressCallback(IntPtr callbackHandle, IntPtr ptr);
+
+        [DllImport(NativeBindings.dllName)]
+        static extern IntPtr ProgressiveCodec_constructor(ProgressiveCodec_progressCallback progressCallback,
+            IntPtr progressCallbackHandle, int minPublishIntervalMillis);
+
+        [DllImport(NativeBindings.dllName)]
+        static extern void ProgressiveCodec_dispose(IntPtr ptr);
+
+        [DllImport(NativeBindings.dllName)]
+        static extern unsafe IntPtr ProgressiveCodec_addChunk(IntPtr ptr, byte* data, int dataLength, bool isLast);
+    }
+
     public static partial class ui_ {
         public static Future<Codec> instantiateImageCodec(byte[] list, int? targetWidth = null,
             int? targetHeight = null) {
@@ -2844,6 +3003,473 @@ namespace Unity.UIWidgets.ui {
             bool transparentOccluder);
     }
 
+    // Records canvas operations into a buffer of 32-bit words, which submit replays on a Canvas with a single
+    // native call instead of one per operation. The layout of each operation matches CanvasOp in canvas.cc.
+    // The objects referenced by the operations are kept alive until the buffer is submitted or cleared.
+    public class CanvasCommandBuffer {
+        enum _Op : uint {
+            save = 0,
+            saveLayerWithoutBounds = 1,
+            saveLayer = 2,
+            restore = 3,
+            translate = 4,
+            scale = 5,
+            rotate = 6,
+            skew = 7,
+            transform = 8,
+            clipRect = 9,
+            clipRRect = 10,
+            clipPath = 11,
+            drawColor = 12,
+            drawLine = 13,
+            drawPaint = 14,
+            drawRect = 15,
+            drawRRect = 16,
+            drawDRRect = 17,
+            drawOval = 18,
+            drawCircle = 19,
+            drawArc = 20,
+            drawPath = 21,
+            drawImage = 22,
+            drawImageRect = 23,
+            drawImageNine = 24,
+            drawPicture = 25,
+            drawPoints = 26,
+            drawVertices = 27,
+            drawAtlas = 28,
+            drawShadow = 29,
+        }
+
+        const uint _kNullPaint = 0;
+        const uint _kInlinePaint = 1;
+        const uint _kPreviousPaint = 2;
+
+        const int _kPaintObjectCount = 3;
+        const int _kPaintDataWordCount = 14;
+
+        uint[] _words = new uint[256];
+        int _length;
+
+        readonly List<IntPtr> _objectPtrs = new List<IntPtr>();
+        readonly List<object> _objects = new List<object>();
+        readonly Dictionary<IntPtr, int> _objectIndices = new Dictionary<IntPtr, int>();
+
+        // The last inline paint, so that drawing with an unchanged paint again only encodes a reference to it.
+        Paint _previousPaint;
+        readonly byte[] _previousPaintData = new byte[_kPaintDataWordCount * 4];
+        readonly IntPtr[] _previousPaintObjectPtrs = new IntPtr[_kPaintObjectCount];
+
+        public bool isEmpty {
+            get { return _length == 0; }
+        }
+
+        public void save() {
+            _addOp(_Op.save);
+        }
+
+        public void saveLayer(Rect bounds, Paint paint) {
+            D.assert(paint != null);
+            if (bounds == null) {
+                _addOp(_Op.saveLayerWithoutBounds);
+                _addPaint(paint);
+            }
+            else {
+                D.assert(PaintingUtils._rectIsValid(bounds));
+                _addOp(_Op.saveLayer);
+                _addRect(bounds);
+                _addPaint(paint);
+            }
+        }
+
+        public void restore() {
+            _addOp(_Op.restore);
+        }
+
+        public void translate(float dx, float dy) {
+            _addOp(_Op.translate);
+            _addFloat(dx);
+            _addFloat(dy);
+        }
+
+        public void scale(float sx, float? sy = null) {
+            _addOp(_Op.scale);
+            _addFloat(sx);
+            _addFloat(sy ?? sx);
+        }
+
+        public void rotate(float radians) {
+            _addOp(_Op.rotate);
+            _addFloat(radians);
+        }
+
+        public void skew(float sx, float sy) {
+            _addOp(_Op.skew);
+            _addFloat(sx);
+            _addFloat(sy);
+        }
+
+        public void transform(float[] matrix4) {
+            D.assert(matrix4 != null);
+            if (matrix4.Length != 16)
+                throw new ArgumentException("\"matrix4\" must have 16 entries.");
+            _addOp(_Op.transform);
+            _addFloats(matrix4);
+        }
+
+        public void clipRect(Rect rect, ClipOp clipOp = ClipOp.intersect, bool doAntiAlias = true) {
+            D.assert(PaintingUtils._rectIsValid(rect));
+            _addOp(_Op.clipRect);
+            _addRect(rect);
+            _add((uint) clipOp);
+            _addBool(doAntiAlias);
+        }
+
+        public void clipRRect(RRect rrect, bool doAntiAlias = true) {
+            D.assert(PaintingUtils._rrectIsValid(rrect));
+            _addOp(_Op.clipRRect);
+            _addFloats(rrect._value32);
+            _addBool(doAntiAlias);
+        }
+
+        public void clipPath(Path path, bool doAntiAlias = true) {
+            D.assert(path != null);
+            _addOp(_Op.clipPath);
+            _addObject(path);
+            _addBool(doAntiAlias);
+        }
+
+        public void drawColor(Color color, BlendMode blendMode) {
+            D.assert(color != null);
+            _addOp(_Op.drawColor);
+            _add(color.value);
+            _add((uint) blendMode);
+        }
+
+        public void drawLine(Offset p1, Offset p2, Paint paint) {
+            D.assert(PaintingUtils._offsetIsValid(p1));
+            D.assert(PaintingUtils._offsetIsValid(p2));
+            D.assert(paint != null);
+            _addOp(_Op.drawLine);
+            _addFloat(p1.dx);
+            _addFloat(p1.dy);
+            _addFloat(p2.dx);
+            _addFloat(p2.dy);
+            _addPaint(paint);
+        }
+
+        public void drawPaint(Paint paint) {
+            D.assert(paint != null);
+            _addOp(_Op.drawPaint);
+            _addPaint(paint);
+        }
+
+        public void drawRect(Rect rect, Paint paint) {
+            D.assert(PaintingUtils._rectIsValid(rect));
+            D.assert(paint != null);
+            _addOp(_Op.drawRect);
+            _addRect(rect);
+            _addPaint(paint);
+        }
+
+        public void drawRRect(RRect rrect, Paint paint) {
+            D.assert(PaintingUtils._rrectIsValid(rrect));
+            D.assert(paint != null);
+            _addOp(_Op.drawRRect);
+            _addFloats(rrect._value32);
+            _addPaint(paint);
+        }
+
+        public void drawDRRect(RRect outer, RRect inner, Paint paint) {
+            D.assert(PaintingUtils._rrectIsValid(outer));
+            D.assert(PaintingUtils._rrectIsValid(inner));
+            D.assert(paint != null);
+            _addOp(_Op.drawDRRect);
+            _addFloats(outer._value32);
+            _addFloats(inner._value32);
+            _addPaint(paint);
+        }
+
+        public void drawOval(Rect rect, Paint paint) {
+            D.assert(PaintingUtils._rectIsValid(rect));
+            D.assert(paint != null);
+            _addOp(_Op.drawOval);
+            _addRect(rect);
+            _addPaint(paint);
+        }
+
+        public void drawCircle(Offset c, float radius, Paint paint) {
+            D.assert(PaintingUtils._offsetIsValid(c));
+            D.assert(paint != null);
+            _addOp(_Op.drawCircle);
+            _addFloat(c.dx);
+            _addFloat(c.dy);
+            _addFloat(radius);
+            _addPaint(paint);
+        }
+
+        public void drawArc(Rect rect, float startAngle, float sweepAngle, bool useCenter, Paint paint) {
+            D.assert(PaintingUtils._rectIsValid(rect));
+            D.assert(paint != null);
+            _addOp(_Op.drawArc);
+            _addRect(rect);
+            _addFloat(startAngle);
+            _addFloat(sweepAngle);
+            _addBool(useCenter);
+            _addPaint(paint);
+        }
+
+        public void drawPath(Path path, Paint paint) {
+            D.assert(path != null);
+            D.assert(paint != null);
+            _addOp(_Op.drawPath);
+            _addObject(path);
+            _addPaint(paint);
+        }
+
+        public void drawImage(Image image, Offset p, Paint paint) {
+            D.assert(image != null);
+            D.assert(PaintingUtils._offsetIsValid(p));
+            D.assert(paint != null);
+            _addOp(_Op.drawImage);
+            _addObject(image);
+            _addFloat(p.dx);
+            _addFloat(p.dy);
+            _addPaint(paint);
+        }
+
+        public void drawImageRect(Image image, Rect src, Rect dst, Paint paint) {
+            D.assert(image != null);
+            D.assert(PaintingUtils._rectIsValid(src));
+            D.assert(PaintingUtils._rectIsValid(dst));
+            D.assert(paint != null);
+            _addOp(_Op.drawImageRect);
+            _addObject(image);
+            _addRect(src);
+            _addRect(dst);
+            _addPaint(paint);
+        }
+
+        public void drawImageNine(Image image, Rect center, Rect dst, Paint paint) {
+            D.assert(image != null);
+            D.assert(PaintingUtils._rectIsValid(center));
+            D.assert(PaintingUtils._rectIsValid(dst));
+            D.assert(paint != null);
+            _addOp(_Op.drawImageNine);
+            _addObject(image);
+            _addRect(center);
+            _addRect(dst);
+            _addPaint(paint);
+        }
+
+        public void drawPicture(Picture picture) {
+            D.assert(picture != null);
+            _addOp(_Op.drawPicture);
+            _addObject(picture);
+        }
+
+        public void drawRawPoints(PointMode pointMode, float[] points, Paint paint) {
+            D.assert(points != null);
+            D.assert(paint != null);
+            if (points.Length % 2 != 0)
+                throw new ArgumentException("\"points\" must have an even number of values.");
+            _addOp(_Op.drawPoints);
+            _addPaint(paint);
+            _add((uint) pointMode);
+            _add((uint) points.Length);
+            _addFloats(points);
+        }
+
+        public void drawPoints(PointMode pointMode, List<Offset> points, Paint paint) {
+            D.assert(points != null);
+            drawRawPoints(pointMode, PaintingUtils._encodePointList(points), paint);
+        }
+
+        public void drawVertices(Vertices vertices, BlendMode blendMode, Paint paint) {
+            D.assert(vertices != null);
+            D.assert(paint != null);
+            _addOp(_Op.drawVertices);
+            _addObject(vertices);
+            _add((uint) blendMode);
+            _addPaint(paint);
+        }
+
+        public void drawRawAtlas(Image atlas,
+            float[] rstTransforms,
+            float[] rects,
+            uint[] colors,
+            BlendMode blendMode,
+            Rect cullRect,
+            Paint paint) {
+            D.assert(atlas != null);
+            D.assert(rstTransforms != null);
+            D.assert(rects != null);
+            D.assert(paint != null);
+
+            int rectCount = rects.Length;
+            if (rstTransforms.Length != rectCount)
+                throw new ArgumentException("\"rstTransforms\" and \"rects\" lengths must match.");
+            if (rectCount % 4 != 0)
+                throw new ArgumentException("\"rstTransforms\" and \"rects\" lengths must be a multiple of four.");
+            if (colors != null && colors.Length > 0 && colors.Length * 4 != rectCount)
+                throw new ArgumentException(
+                    "If non-null, \"colors\" length must be one fourth the length of \"rstTransforms\" and \"rects\".");
+
+            _addOp(_Op.drawAtlas);
+            _addPaint(paint);
+            _addObject(atlas);
+            _add((uint) rstTransforms.Length);
+            _addFloats(rstTransforms);
+            _add((uint) rects.Length);
+            _addFloats(rects);
+            int colorsLength = colors?.Length ?? 0;
+            _add((uint) colorsLength);
+            _ensureCapacity(colorsLength);
+            if (colorsLength > 0) {
+                Array.Copy(colors, 0, _words, _length, colorsLength);
+                _length += colorsLength;
+            }
+
+            _add((uint) blendMode);
+            _addBool(cullRect != null);
+            if (cullRect != null) {
+                _addRect(cullRect);
+            }
+        }
+
+        public void drawShadow(Path path, Color color, float elevation, bool transparentOccluder) {
+            D.assert(path != null);
+            D.assert(color != null);
+            _addOp(_Op.drawShadow);
+            _addObject(path);
+            _add(color.value);
+            _addFloat(elevation);
+            _addBool(transparentOccluder);
+        }
+
+        // Replays the recorded operations on canvas and clears the buffer.
+        public unsafe void submit(Canvas canvas) {
+            D.assert(canvas != null);
+            if (_length > 0) {
+                IntPtr[] objectPtrs = _objectPtrs.ToArray();
+                fixed (uint* opsPtr = _words)
+                fixed (IntPtr* objectsPtr = objectPtrs) {
+                    Canvas_submitCommands(canvas._ptr, (byte*) opsPtr, _length * 4, objectsPtr, objectPtrs.Length);
+                }
+            }
+
+            clear();
+        }
+
+        public void clear() {
+            _length = 0;
+            _objectPtrs.Clear();
+            _objects.Clear();
+            _objectIndices.Clear();
+            _previousPaint = null;
+        }
+
+        void _ensureCapacity(int count) {
+            if (_length + count > _words.Length) {
+                Array.Resize(ref _words, Math.Max(_words.Length * 2, _length + count));
+            }
+        }
+
+        void _add(uint word) {
+            _ensureCapacity(1);
+            _words[_length++] = word;
+        }
+
+        void _addOp(_Op op) {
+            _add((uint) op);
+        }
+
+        void _addBool(bool value) {
+            _add(value ? 1u : 0u);
+        }
+
+        unsafe void _addFloat(float value) {
+            _add(*(uint*) &value);
+        }
+
+        void _addFloats(float[] values) {
+            _ensureCapacity(values.Length);
+            Buffer.BlockCopy(values, 0, _words, _length * 4, values.Length * 4);
+            _length += values.Length;
+        }
+
+        void _addRect(Rect rect) {
+            _addFloat(rect.left);
+            _addFloat(rect.top);
+            _addFloat(rect.right);
+            _addFloat(rect.bottom);
+        }
+
+        void _addObject(NativeWrapper obj) {
+            _addObjectPtr(obj?._ptr ?? IntPtr.Zero, obj);
+        }
+
+        void _addObjectPtr(IntPtr ptr, object obj) {
+            if (ptr == IntPtr.Zero) {
+                _add(unchecked((uint) -1));
+                return;
+            }
+
+            if (!_objectIndices.TryGetValue(ptr, out var index)) {
+                index = _objectPtrs.Count;
+                _objectPtrs.Add(ptr);
+                _objectIndices.Add(ptr, index);
+            }
+
+            if (obj != null) {
+                _objects.Add(obj);
+            }
+
+            _add((uint) index);
+        }
+
+        void _addPaint(Paint paint) {
+            if (ReferenceEquals(paint, _previousPaint) && _isPreviousPaint(paint)) {
+                _add(_kPreviousPaint);
+                return;
+            }
+
+            _add(_kInlinePaint);
+            for (int i = 0; i < _kPaintObjectCount; i++) {
+                IntPtr ptr = paint._objectPtrs?[i] ?? IntPtr.Zero;
+                _addObjectPtr(ptr, paint._objects?[i]);
+                _previousPaintObjectPtrs[i] = ptr;
+            }
+
+            _ensureCapacity(_kPaintDataWordCount);
+            Buffer.BlockCopy(paint._data, 0, _words, _length * 4, _kPaintDataWordCount * 4);
+            _length += _kPaintDataWordCount;
+
+            Buffer.BlockCopy(paint._data, 0, _previousPaintData, 0, _previousPaintData.Length);
+            _previousPaint = paint;
+        }
+
+        // Whether paint was not changed since it was last encoded.
+        bool _isPreviousPaint(Paint paint) {
+            for (int i = 0; i < _kPaintObjectCount; i++) {
+                if ((paint._objectPtrs?[i] ?? IntPtr.Zero) != _previousPaintObjectPtrs[i]) {
+                    return false;
+                }
+            }
+
+            for (int i = 0; i < _previousPaintData.Length; i++) {
+                if (paint._data[i] != _previousPaintData[i]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        [DllImport(NativeBindings.dllName)]
+        static extern unsafe void Canvas_submitCommands(IntPtr ptr, byte* ops, int opsLength, IntPtr* objects,
+            int objectsLength);
+    }
+
     public class Picture : NativeWrapperDisposable {
         internal Picture(IntPtr ptr) : base(ptr) {
         }
@@ -3091,8 +3717,10 @@ namespace Unity.UIWidgets.ui {
     }
     
     public class Skottie : NativeWrapper {
-        public Skottie(string path) {
-            var Id = Skottie_Construct(path);
+        // If cacheFrames is set, the frames are rasterized at the size they are painted at ahead of time and
+        // shared with the other Skotties of the same file, and painting a frame draws its image.
+        public Skottie(string path, bool cacheFrames = false) {
+            var Id = Skottie_Construct(path, cacheFrames);
             if(Id == IntPtr.Zero){
                 Debug.Log($"cannot load lottie from {path}, please check file exist and valid");
             }else {
@@ -3105,7 +3733,8 @@ namespace Unity.UIWidgets.ui {
         }
 
         public void paint(Canvas canvas, Offset offset, float width, float height, float frame) {
-            Skottie_Paint(_ptr, canvas._ptr, offset.dx, offset.dy, width, height, frame);
+            Skottie_Paint(_ptr, canvas._ptr, offset.dx, offset.dy, width, height, frame,
+                Window.instance.devicePixelRatio);
         }
         
         public float duration() {
@@ -3113,14 +3742,14 @@ namespace Unity.UIWidgets.ui {
         }
 
         [DllImport(NativeBindings.dllName)]
-        static extern IntPtr Skottie_Construct(string path);
+        static extern IntPtr Skottie_Construct(string path, [MarshalAs(UnmanagedType.U1)] bool cacheFrames);
 
         [DllImport(NativeBindings.dllName)]
         static extern void Skottie_Dispose(IntPtr skottie);
 
         [DllImport(NativeBindings.dllName)]
         static extern void Skottie_Paint(IntPtr skottie, IntPtr canvas, float x, float y, float width, float height,
-            float frame);
+            float frame, float devicePixelRatio);
         
         [DllImport(NativeBindings.dllName)]
         static extern float Skottie_Duration(IntPtr skottie);
@@ -893,9 +893,9 @@ namespace Unity.UIWidgets.ui {
 
         public override int GetHashCode() {
             unchecked {
-                var hashCode = _encoded != null ? _encoded.GetHashCode() : 0;
+                var hashCode = _encoded.hashList();
                 hashCode = (hashCode * 397) ^ (_fontFamily != null ? _fontFamily.GetHashCode() : 0);
-                hashCode = (hashCode * 397) ^ (_fontFamilyFallback != null ? _fontFamilyFallback.GetHashCode() : 0);
+                hashCode = (hashCode * 397) ^ _fontFamilyFallback.hashList();
                 hashCode = (hashCode * 397) ^ _fontSize.GetHashCode();
                 hashCode = (hashCode * 397) ^ _letterSpacing.GetHashCode();
                 hashCode = (hashCode * 397) ^ _wordSpacing.GetHashCode();
@@ -904,8 +904,8 @@ namespace Unity.UIWidgets.ui {
                 hashCode = (hashCode * 397) ^ (_locale != null ? _locale.GetHashCode() : 0);
                 hashCode = (hashCode * 397) ^ (_background != null ? _background.GetHashCode() : 0);
                 hashCode = (hashCode * 397) ^ (_foreground != null ? _foreground.GetHashCode() : 0);
-                hashCode = (hashCode * 397) ^ (_shadows != null ? _shadows.GetHashCode() : 0);
-                hashCode = (hashCode * 397) ^ (_fontFeatures != null ? _fontFeatures.GetHashCode() : 0);
+                hashCode = (hashCode * 397) ^ _shadows.hashList();
+                hashCode = (hashCode * 397) ^ _fontFeatures.hashList();
                 return hashCode;
             }
         }
@@ -1532,37 +1532,17 @@ namespace Unity.UIWidgets.ui {
         }
 
         [DllImport(dllName: NativeBindings.dllName)]
-        static extern float Paragraph_width(IntPtr ptr);
-
-        [DllImport(dllName: NativeBindings.dllName)]
-        static extern float Paragraph_height(IntPtr ptr);
-
-        [DllImport(dllName: NativeBindings.dllName)]
-        static extern float Paragraph_longestLine(IntPtr ptr);
-
-        [DllImport(dllName: NativeBindings.dllName)]
-        static extern float Paragraph_minIntrinsicWidth(IntPtr ptr);
-
-        [DllImport(dllName: NativeBindings.dllName)]
-        static extern float Paragraph_maxIntrinsicWidth(IntPtr ptr);
-
-        [DllImport(dllName: NativeBindings.dllName)]
-        static extern float Paragraph_alphabeticBaseline(IntPtr ptr);
+        static extern unsafe void Paragraph_getMetrics(IntPtr ptr, float* metrics);
 
         [DllImport(dllName: NativeBindings.dllName)]
-        static extern float Paragraph_ideographicBaseline(IntPtr ptr);
-
-        [DllImport(dllName: NativeBindings.dllName)]
-        [return: MarshalAs(UnmanagedType.U1)]
-        static extern bool Paragraph_didExceedMaxLines(IntPtr ptr);
+        static extern void Paragraph_layout(IntPtr ptr, float width);
 
         [DllImport(dllName: NativeBindings.dllName)]
-        static extern void Paragraph_layout(IntPtr ptr, float width);
+        static extern unsafe void Paragraph_layoutBatch(IntPtr* items, float* widths, int n);
 
         [DllImport(dllName: NativeBindings.dllName)]
-        static extern Float32List Paragraph_getRectsForRange(IntPtr ptr, int start, int end,
-            int boxHeightStyle,
-            int boxWidthStyle);
+        static extern unsafe int Paragraph_getRectsForRangeInto(IntPtr ptr, int start, int end,
+            int boxHeightStyle, int boxWidthStyle, float* data, int capacity);
 
         [DllImport(dllName: NativeBindings.dllName)]
         static extern Float32List Paragraph_getRectsForPlaceholders(IntPtr ptr);
@@ -1580,7 +1560,7 @@ namespace Unity.UIWidgets.ui {
         static extern void Paragraph_paint(IntPtr ptr, IntPtr canvas, float x, float y);
 
         [DllImport(dllName: NativeBindings.dllName)]
-        static extern Float32List Paragraph_computeLineMetrics(IntPtr ptr);
+        static extern unsafe int Paragraph_computeLineMetricsInto(IntPtr ptr, float* data, int capacity);
 
         [DllImport(dllName: NativeBindings.dllName)]
         static extern void Paragraph_dispose(IntPtr ptr);
@@ -1591,6 +1571,51 @@ namespace Unity.UIWidgets.ui {
 
         void _layout(float width) {
             Paragraph_layout(ptr: _ptr, width: width);
+            _metricsValid = false;
+        }
+
+        // Lays out the paragraphs, each with its own constraints, as if one
+        // after the other. The engine lays them out in parallel.
+        public static unsafe void layoutBatch(IList<Paragraph> paragraphs, IList<ParagraphConstraints> constraints) {
+            D.assert(paragraphs.Count == constraints.Count);
+            var count = paragraphs.Count;
+            if (count == 0) {
+                return;
+            }
+
+            var items = new IntPtr[count];
+            var widths = new float[count];
+            for (var i = 0; i < count; i++) {
+                items[i] = paragraphs[i]._ptr;
+                widths[i] = constraints[i].width;
+                paragraphs[i]._metricsValid = false;
+            }
+
+            fixed (IntPtr* itemsPtr = items)
+            fixed (float* widthsPtr = widths) {
+                Paragraph_layoutBatch(items: itemsPtr, widths: widthsPtr, n: count);
+            }
+        }
+
+        // See Paragraph::getMetrics in paragraph.cc for the layout.
+        const int _metricsLength = 8;
+        readonly float[] _metrics = new float[_metricsLength];
+        bool _metricsValid;
+
+        // Shared by the queries that return a variable number of values, which
+        // only ever run on the UI thread.
+        static float[] _scratch = new float[64];
+
+        unsafe float[] _getMetrics() {
+            if (!_metricsValid) {
+                fixed (float* metricsPtr = _metrics) {
+                    Paragraph_getMetrics(ptr: _ptr, metrics: metricsPtr);
+                }
+
+                _metricsValid = true;
+            }
+
+            return _metrics;
         }
 
         List<TextBox> _decodeTextBoxes(float[] encoded, int size) {
@@ -1615,49 +1640,60 @@ namespace Unity.UIWidgets.ui {
         }
 
         public float width() {
-            return Paragraph_width(ptr: _ptr);
+            return _getMetrics()[0];
         }
 
         public float height() {
-            return Paragraph_height(ptr: _ptr);
+            return _getMetrics()[1];
         }
 
         public float longestLine() {
-            return Paragraph_longestLine(ptr: _ptr);
+            return _getMetrics()[2];
         }
 
         public float minIntrinsicWidth() {
-            return Paragraph_minIntrinsicWidth(ptr: _ptr);
+            return _getMetrics()[3];
         }
 
         public float maxIntrinsicWidth() {
-            return Paragraph_maxIntrinsicWidth(ptr: _ptr);
+            return _getMetrics()[4];
         }
 
         public float alphabeticBaseline() {
-            return Paragraph_alphabeticBaseline(ptr: _ptr);
+            return _getMetrics()[5];
         }
 
         public float ideographicBaseline() {
-            return Paragraph_ideographicBaseline(ptr: _ptr);
+            return _getMetrics()[6];
         }
 
         public bool didExceedMaxLines() {
-            return Paragraph_didExceedMaxLines(ptr: _ptr);
+            return _getMetrics()[7] != 0;
         }
 
         public List<TextBox> getBoxesForRange(int start, int end,
             BoxHeightStyle boxHeightStyle = BoxHeightStyle.tight,
             BoxWidthStyle boxWidthStyle = BoxWidthStyle.tight) {
-            var data = _getBoxesForRange(start: start, end: end, (int) boxHeightStyle, (int) boxWidthStyle)
-                .toFloatArrayAndFree();
-            return _decodeTextBoxes(encoded: data, size: data.Length);
-        }
+            var size = _getBoxesForRange(start: start, end: end, (int) boxHeightStyle, (int) boxWidthStyle);
+            return _decodeTextBoxes(encoded: _scratch, size: size);
+        }
+
+        // See paragraph.cc for the layout of the values written to _scratch.
+        unsafe int _getBoxesForRange(int start, int end, int boxHeightStyle, int boxWidthStyle) {
+            while (true) {
+                int size;
+                fixed (float* data = _scratch) {
+                    size = Paragraph_getRectsForRangeInto(ptr: _ptr, start: start, end: end,
+                        boxHeightStyle: boxHeightStyle, boxWidthStyle: boxWidthStyle, data: data,
+                        capacity: _scratch.Length);
+                }
 
-        // See paragraph.cc for the layout of this return value.
-        Float32List _getBoxesForRange(int start, int end, int boxHeightStyle, int boxWidthStyle) {
-            return Paragraph_getRectsForRange(ptr: _ptr, start: start, end: end, boxHeightStyle: boxHeightStyle,
-                boxWidthStyle: boxWidthStyle);
+                if (size <= _scratch.Length) {
+                    return size;
+                }
+
+                _scratch = new float[size];
+            }
         }
 
 
@@ -1714,8 +1750,8 @@ namespace Unity.UIWidgets.ui {
         }
 
         public List<LineMetrics> computeLineMetrics() {
-            var data = _computeLineMetrics().toFloatArrayAndFree();
-            var count = data.Length / 9;
+            var count = _computeLineMetrics() / 9;
+            var data = _scratch;
             var position = 0;
             var metrics = new List<LineMetrics>();
 
@@ -1736,8 +1772,20 @@ namespace Unity.UIWidgets.ui {
             return metrics;
         }
 
-        Float32List _computeLineMetrics() {
-            return Paragraph_computeLineMetrics(ptr: _ptr);
+        // Writes the line metrics to _scratch and returns the number of values.
+        unsafe int _computeLineMetrics() {
+            while (true) {
+                int size;
+                fixed (float* data = _scratch) {
+                    size = Paragraph_computeLineMetricsInto(ptr: _ptr, data: data, capacity: _scratch.Length);
+                }
+
+                if (size <= _scratch.Length) {
+                    return size;
+                }
+
+                _scratch = new float[size];
+            }
         }
     }
 
@@ -1811,12 +1859,36 @@ namespace Unity.UIWidgets.ui {
             int fontFeatureDataSize
         );
 
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern unsafe int ParagraphBuilder_registerStyle(
+            int[] encoded,
+            int encodedSize,
+            string[] fontFamilies,
+            int fontFamiliesSize,
+            float fontSize,
+            float letterSpacing,
+            float wordSpacing,
+            float height,
+            float decorationThickness,
+            string locale,
+            IntPtr* backgroundObjects,
+            byte[] backgroundData,
+            IntPtr* foregroundObjects,
+            byte[] foregroundData,
+            byte[] shadowsData,
+            int shadowDataSize,
+            byte[] fontFeaturesData,
+            int fontFeatureDataSize
+        );
+
+        [DllImport(dllName: NativeBindings.dllName)]
+        static extern IntPtr ParagraphBuilder_pushStyleById(IntPtr ptr, int id);
+
         [DllImport(dllName: NativeBindings.dllName)]
         static extern void ParagraphBuilder_pop(IntPtr ptr);
 
         [DllImport(dllName: NativeBindings.dllName)]
-        static extern IntPtr ParagraphBuilder_addText(IntPtr ptr, [MarshalAs(unmanagedType: UnmanagedType.LPWStr)]
-            string text);
+        static extern unsafe IntPtr ParagraphBuilder_addTextWithLength(IntPtr ptr, char* text, int length);
 
         [DllImport(dllName: NativeBindings.dllName)]
         static extern IntPtr ParagraphBuilder_addPlaceholder(IntPtr ptr, float width, float height, int alignment,
@@ -1857,7 +1929,25 @@ namespace Unity.UIWidgets.ui {
             ParagraphBuilder_dispose(ptr: ptr);
         }
 
+        // The most style ids an isolate remembers. The native table keeps every registered style, so forgetting
+        // an id only costs registering the style again, which returns the same id.
+        const int _kMaxRegisteredStyles = 1024;
+
         public void pushStyle(TextStyle style) {
+            // Styles without paints are registered once and then pushed by id, which saves encoding and
+            // decoding them for every run. Paints can change after the style was registered. Equal styles are
+            // usually different instances, so they are looked up by value.
+            var registers = style._foreground == null && style._background == null;
+            Dictionary<TextStyle, int> styleIds = null;
+            if (registers) {
+                styleIds = Isolate.current.textStyleIds;
+                if (styleIds.TryGetValue(style, out var id)) {
+                    IntPtr error = ParagraphBuilder_pushStyleById(_ptr, id);
+                    D.assert(error == IntPtr.Zero);
+                    return;
+                }
+            }
+
             var fullFontFamilies = new List<string>();
 
             fullFontFamilies.Add(item: style._fontFamily);
@@ -1879,6 +1969,30 @@ namespace Unity.UIWidgets.ui {
                 }
             }
 
+            if (registers) {
+                int id = _registerStyle(
+                    style._encoded.ToArray(),
+                    fullFontFamilies.ToArray(),
+                    fontSize: style._fontSize,
+                    letterSpacing: style._letterSpacing,
+                    wordSpacing: style._wordSpacing,
+                    height: style._height,
+                    decorationThickness: style._decorationThickness,
+                    _encodeLocale(locale: style._locale),
+                    Shadow._encodeShadows(shadows: style._shadows),
+                    fontFeaturesData: encodedFontFeatures
+                );
+
+                if (styleIds.Count >= _kMaxRegisteredStyles) {
+                    styleIds.Clear();
+                }
+
+                styleIds[style] = id;
+                IntPtr error = ParagraphBuilder_pushStyleById(_ptr, id);
+                D.assert(error == IntPtr.Zero);
+                return;
+            }
+
             _pushStyle(
                 style._encoded.ToArray(),
                 fullFontFamilies.ToArray(),
@@ -1897,6 +2011,40 @@ namespace Unity.UIWidgets.ui {
             );
         }
 
+        static unsafe int _registerStyle(
+            int[] encoded,
+            string[] fontFamilies,
+            float? fontSize,
+            float? letterSpacing,
+            float? wordSpacing,
+            float? height,
+            float? decorationThickness,
+            string locale,
+            byte[] shadowsData,
+            byte[] fontFeaturesData
+        ) {
+            return ParagraphBuilder_registerStyle(
+                encoded: encoded,
+                encodedSize: encoded.Length,
+                fontFamilies: fontFamilies,
+                fontFamiliesSize: fontFamilies.Length,
+                fontSize.GetValueOrDefault(0),
+                letterSpacing.GetValueOrDefault(0),
+                wordSpacing.GetValueOrDefault(0),
+                height.GetValueOrDefault(0),
+                decorationThickness.GetValueOrDefault(0),
+                locale: locale,
+                backgroundObjects: null,
+                backgroundData: null,
+                foregroundObjects: null,
+                foregroundData: null,
+                shadowsData: shadowsData,
+                shadowsData?.Length ?? 0,
+                fontFeaturesData: fontFeaturesData,
+                fontFeaturesData?.Length ?? 0
+            );
+        }
+
         unsafe void _pushStyle(
             int[] encoded,
             string[] fontFamilies,
@@ -1953,8 +2101,10 @@ namespace Unity.UIWidgets.ui {
             }
         }
 
-        IntPtr _addText(string text) {
-            return ParagraphBuilder_addText(ptr: _ptr, text: text);
+        unsafe IntPtr _addText(string text) {
+            fixed (char* textPtr = text) {
+                return ParagraphBuilder_addTextWithLength(ptr: _ptr, text: textPtr, length: text?.Length ?? 0);
+            }
         }
 
         public void addPlaceholder(float width, float height, PlaceholderAlignment alignment,
@@ -12,9 +12,9 @@ namespace Unity.UIWidgets.widgets {
         public float _duration = 0;
         public Size _size = null;
 
-        public Lottie(string path, float frame = 0, Size size = null, int round = -1) {
+        public Lottie(string path, float frame = 0, Size size = null, int round = -1, bool cacheFrames = false) {
             D.assert(path != null);
-            _skottie = new Skottie(Path.Combine(Application.streamingAssetsPath, path));
+            _skottie = new Skottie(Path.Combine(Application.streamingAssetsPath, path), cacheFrames);
             _duration = _skottie.duration();
             _round = round;
             _frame = frame * _duration;
@@ -266,11 +266,13 @@ class Build
         if (BuildUtils.IsHostWindows())
         {
             DeployWindows();
+            DeployBenchmarks(UIWidgetsBuildTargetPlatform.windows);
         }
         //available target platforms of MacOS
         else if (BuildUtils.IsHostMac())
         {
             DeployMac();
+            DeployBenchmarks(UIWidgetsBuildTargetPlatform.mac);
             DeployAndroid();
             DeployAndroid(true);
             DeployIOS();
@@ -286,9 +288,25 @@ class Build
     //refer to the readme file for the details
     private static bool ios_bitcode_enabled = false;
 
-    static NativeProgram SetupLibUIWidgets(UIWidgetsBuildTargetPlatform platform, out List<NPath> dependencies_debug, out List<NPath> dependencies_release)
+    //bee.exe benchmarks
+    //builds the engine together with its benchmarks into an executable, run it with
+    //--benchmark_out=<file> to get the results as JSON in the format of Google Benchmark
+    static void DeployBenchmarks(UIWidgetsBuildTargetPlatform platform)
     {
-        var np = new NativeProgram("libUIWidgets")
+        SetupLibUIWidgets(platform, out var dependencies_debug, out var dependencies_release, benchmarks: true);
+        foreach (var dep in dependencies_release)
+        {
+            Backend.Current.AddAliasDependency("benchmarks", dep);
+        }
+        foreach (var dep in dependencies_debug)
+        {
+            Backend.Current.AddAliasDependency("benchmarks_debug", dep);
+        }
+    }
+
+    static NativeProgram SetupLibUIWidgets(UIWidgetsBuildTargetPlatform platform, out List<NPath> dependencies_debug, out List<NPath> dependencies_release, bool benchmarks = false)
+    {
+        var np = new NativeProgram(benchmarks ? "uiwidgets_benchmarks" : "libUIWidgets")
         {
             Sources =
             {
@@ -339,6 +357,8 @@ class Build
                 "src/flow/layers/transform_layer.h",
                 "src/flow/compositor_context.cc",
                 "src/flow/compositor_context.h",
+                "src/flow/damage_context.cc",
+                "src/flow/damage_context.h",
                 "src/flow/embedded_views.cc",
                 "src/flow/embedded_views.h",
                 "src/flow/instrumentation.cc",
@@ -370,10 +390,16 @@ class Build
                 "src/lib/ui/text/asset_manager_font_provider.h",
                 "src/lib/ui/text/paragraph_builder.cc",
                 "src/lib/ui/text/paragraph_builder.h",
+                "src/lib/ui/text/paragraph_layout_cache.cc",
+                "src/lib/ui/text/paragraph_layout_cache.h",
                 "src/lib/ui/text/font_collection.cc",
                 "src/lib/ui/text/font_collection.h",
+                "src/lib/ui/text/font_fallback_index.cc",
+                "src/lib/ui/text/font_fallback_index.h",
                 "src/lib/ui/text/paragraph.cc",
                 "src/lib/ui/text/paragraph.h",
+                "src/lib/ui/text/text_style_table.cc",
+                "src/lib/ui/text/text_style_table.h",
 
                 "src/lib/ui/painting/canvas.cc",
                 "src/lib/ui/painting/canvas.h",
@@ -381,6 +407,8 @@ class Build
                 "src/lib/ui/painting/codec.h",
                 "src/lib/ui/painting/color_filter.cc",
                 "src/lib/ui/painting/color_filter.h",
+                "src/lib/ui/painting/decoded_image_cache.cc",
+                "src/lib/ui/painting/decoded_image_cache.h",
                 "src/lib/ui/painting/engine_layer.cc",
                 "src/lib/ui/painting/engine_layer.h",
                 "src/lib/ui/painting/frame_info.cc",
@@ -407,10 +435,16 @@ class Build
                 "src/lib/ui/painting/path_measure.h",
                 "src/lib/ui/painting/paint.cc",
                 "src/lib/ui/painting/paint.h",
+                "src/lib/ui/painting/paint_cache.cc",
+                "src/lib/ui/painting/paint_cache.h",
                 "src/lib/ui/painting/picture.cc",
                 "src/lib/ui/painting/picture.h",
                 "src/lib/ui/painting/picture_recorder.cc",
                 "src/lib/ui/painting/picture_recorder.h",
+                "src/lib/ui/painting/pixel_buffer_pool.cc",
+                "src/lib/ui/painting/pixel_buffer_pool.h",
+                "src/lib/ui/painting/progressive_codec.cc",
+                "src/lib/ui/painting/progressive_codec.h",
                 "src/lib/ui/painting/rrect.cc",
                 "src/lib/ui/painting/rrect.h",
                 "src/lib/ui/painting/shader.cc",
@@ -419,6 +453,8 @@ class Build
                 "src/lib/ui/painting/single_frame_codec.h",
                 "src/lib/ui/painting/skottie.cc",
                 "src/lib/ui/painting/skottie.h",
+                "src/lib/ui/painting/skottie_frame_cache.cc",
+                "src/lib/ui/painting/skottie_frame_cache.h",
                 "src/lib/ui/painting/vertices.cc",
                 "src/lib/ui/painting/vertices.h",
 
@@ -543,6 +579,10 @@ class Build
 
                 "src/shell/platform/unity/gfx_worker_task_runner.cc",
                 "src/shell/platform/unity/gfx_worker_task_runner.h",
+                "src/shell/platform/unity/headless/headless_task_runner.cc",
+                "src/shell/platform/unity/headless/headless_task_runner.h",
+                "src/shell/platform/unity/headless/uiwidgets_headless_panel.cc",
+                "src/shell/platform/unity/headless/uiwidgets_headless_panel.h",
                 "src/shell/platform/unity/uiwidgets_system.h",
 
               
@@ -555,7 +595,20 @@ class Build
                 "src/engine.cc",
                 "src/platform_base.h",
             },
-            OutputName = { c => "libUIWidgets" },
+            OutputName = { c => benchmarks ? "uiwidgets_benchmarks" : "libUIWidgets" },
+        };
+
+        // the benchmarks are only built into the benchmark executable
+        var benchmarkSources = new NPath[] {
+                "src/benchmarking/benchmark_main.cc",
+                "src/benchmarking/benchmarking.cc",
+                "src/benchmarking/benchmarking.h",
+                "src/flow/flow_benchmarks.cc",
+                "src/lib/ui/painting/painting_benchmarks.cc",
+                "src/lib/ui/text/asset_manager_font_provider_benchmarks.cc",
+                "src/lib/ui/text/icu_util_benchmarks.cc",
+                "src/lib/ui/text/paragraph_benchmarks.cc",
+                "src/lib/ui/window/pointer_data_packet_converter_benchmarks.cc",
         };
 
         // include these files for test only
@@ -623,6 +676,10 @@ class Build
         np.Sources.Add(c => IsMac(c), macSources);
         np.Sources.Add(c => IsIosOrTvos(c), iosSources);
         np.Sources.Add(c => IsAndroid(c), androidSource);
+        if (benchmarks)
+        {
+            np.Sources.Add(benchmarkSources);
+        }
 
         np.Libraries.Add(c => IsWindows(c), new BagOfObjectFilesLibrary(
             new NPath[]{
@@ -875,6 +932,7 @@ class Build
         if (platform == UIWidgetsBuildTargetPlatform.windows)
         {
             var toolchain = ToolChain.Store.Windows().VS2019().Sdk_17134().x64();
+            NativeProgramFormat format = benchmarks ? toolchain.ExecutableFormat : toolchain.DynamicLibraryFormat;
 
             foreach (var codegen in codegens)
             {
@@ -883,14 +941,14 @@ class Build
             
                 if(codegen == CodeGen.Debug)
                 {
-                    var builtNP = np.SetupSpecificConfiguration(config, toolchain.DynamicLibraryFormat)
-                    .DeployTo("build_debug");
+                    var builtNP = np.SetupSpecificConfiguration(config, format)
+                    .DeployTo(benchmarks ? "build_benchmarks_debug" : "build_debug");
                     dependencies_debug.Add(builtNP.Path);
                 }
                 else if(codegen == CodeGen.Release)
                 {
-                    var builtNP = np.SetupSpecificConfiguration(config, toolchain.DynamicLibraryFormat)
-                    .DeployTo("build_release");
+                    var builtNP = np.SetupSpecificConfiguration(config, format)
+                    .DeployTo(benchmarks ? "build_benchmarks" : "build_release");
                     dependencies_release.Add(builtNP.Path);
                 }
                 
@@ -941,16 +999,17 @@ class Build
                 var config = new NativeProgramConfiguration(codegen, toolchain, lump: true);
                 validConfigurations.Add(config);
 
-                var buildProgram = np.SetupSpecificConfiguration(config, toolchain.DynamicLibraryFormat);
+                NativeProgramFormat format = benchmarks ? toolchain.ExecutableFormat : toolchain.DynamicLibraryFormat;
+                var buildProgram = np.SetupSpecificConfiguration(config, format);
                 
                 if(codegen == CodeGen.Debug)
                 {
-                    var buildNp = buildProgram.DeployTo("build_debug");
+                    var buildNp = buildProgram.DeployTo(benchmarks ? "build_benchmarks_debug" : "build_debug");
                     dependencies_debug.Add(buildNp.Path);
                 }
                 else if(codegen == CodeGen.Release)
                 {
-                    var buildNp = buildProgram.DeployTo("build_release");
+                    var buildNp = buildProgram.DeployTo(benchmarks ? "build_benchmarks" : "build_release");
                     dependencies_release.Add(buildNp.Path);
                 }
             }
@@ -0,0 +1,133 @@
+import getopt
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# Trims an ICU data package down to what the engine uses at runtime: the
+# Unicode properties and normalization data, the break iterator rules and
+# dictionaries used by txt and ParagraphBuilder, and the break iterator
+# locale data of the chosen locales. Requires a host build of ICU's icupkg.
+
+icupkg_path=""
+input_path=""
+output_path=""
+locales=["en"]
+dropped_dictionaries=[]
+
+# Item names as listed by icupkg, without the package name prefix.
+KEEP_PATTERNS = [
+    r"^[^/]+\.icu$",                 # core properties (uprops, ubidi, ucase, ...)
+    r"^[^/]+\.nrm$",                 # normalization
+    r"^(res_index|root|pool)\.res$", # resource bundle lookup
+    r"^likelySubtags\.res$",
+    r"^brkitr/[^/]+\.brk$",          # break iterator rules
+    r"^brkitr/(res_index|root)\.res$",
+]
+
+def get_opts():
+    global icupkg_path
+    global input_path
+    global output_path
+    global locales
+    global dropped_dictionaries
+
+    options, args = getopt.getopt(sys.argv[1:], 'h', ["icupkg=", "input=", "output=", "locales=", "drop-dictionary=", "help"])
+    for opt, arg in options:
+        if opt == '--icupkg':
+            icupkg_path = arg
+        elif opt == '--input':
+            input_path = arg
+        elif opt == '--output':
+            output_path = arg
+        elif opt == '--locales':
+            locales = [locale for locale in arg.split(",") if locale]
+        elif opt == '--drop-dictionary':
+            dropped_dictionaries.append(arg)
+        elif opt in ("-h", "--help"):
+            show_help()
+            sys.exit()
+    if icupkg_path == "" or input_path == "" or output_path == "":
+        show_help()
+        sys.exit(1)
+
+def list_items():
+    output = subprocess.check_output([icupkg_path, "-l", input_path]).decode("utf-8")
+    return [line.strip() for line in output.splitlines() if line.strip()]
+
+def strip_package_name(item):
+    # Some versions of icupkg list items with the package name, e.g. icudt64l/.
+    return re.sub(r"^icudt\d+[lbe]/", "", item)
+
+def keep_item(item):
+    name = strip_package_name(item)
+    for pattern in KEEP_PATTERNS:
+        if re.match(pattern, name):
+            return True
+    match = re.match(r"^brkitr/([^/]+)\.dict$", name)
+    if match:
+        return match.group(1) not in dropped_dictionaries
+    match = re.match(r"^brkitr/([^/]+)\.res$", name)
+    if match:
+        # Keep the parent locales as well, e.g. zh for zh_Hant.
+        locale = match.group(1)
+        return any(locale == kept or kept.startswith(locale + "_") for kept in locales)
+    return False
+
+def slim():
+    items = list_items()
+    removed = [item for item in items if not keep_item(item)]
+
+    output_dir = os.path.dirname(os.path.abspath(output_path))
+    if not os.path.exists(output_dir):
+        os.makedirs(output_dir)
+
+    # icupkg only treats the remove list as a file if it ends with .txt.
+    with tempfile.TemporaryDirectory() as temp_dir:
+        remove_list = os.path.join(temp_dir, "remove.txt")
+        with open(remove_list, "w") as f:
+            for item in removed:
+                f.write(item + "\n")
+        subprocess.check_call([icupkg_path, "-r", remove_list, input_path, output_path])
+
+    input_size = os.path.getsize(input_path)
+    output_size = os.path.getsize(output_path)
+    print("ICU data: kept %d of %d items, %d -> %d bytes (%.1f%%)" % (
+        len(items) - len(removed), len(items), input_size, output_size,
+        100.0 * output_size / input_size))
+
+def show_help():
+    help_note = '''
+SYNOPSIS
+    python3 icu_slim.py --icupkg <icupkg_path> --input <icudtl.dat> --output <icudtl.dat> [--locales <en,ja,...>] [--drop-dictionary <name>] [-h] [--help].
+
+DESCRIPTION
+    icu_slim.py removes the ICU data the engine does not use from an ICU data package.
+
+    The following options are available:
+
+    required parameters:
+
+    --icupkg            The path of a host build of ICU's icupkg tool
+
+    --input             The ICU data package to trim, e.g. third_party/icu/flutter/icudtl.dat
+
+    --output            Where to write the trimmed package. Keep the file name icudtl.dat, the embedded symbol names are derived from it
+
+    optional parameters:
+
+    -h, --help          Show this help message
+
+    --locales           Comma separated locales whose break iterator data is kept, "en" by default
+
+    --drop-dictionary   Removes a break iterator dictionary, e.g. cjdict, which is only used for word boundaries in CJK text. Can be repeated
+'''
+    print(help_note)
+
+def main():
+    get_opts()
+    slim()
+
+if __name__=="__main__":
+    main()
@@ -21,6 +21,8 @@ bitcode=""
 flutter_root_path=""
 visual_studio_path=""
 architecture=""
+icupkg_path=""
+icu_locales=""
 
 def get_opts():
     # get intput agrs
@@ -31,11 +33,13 @@ def get_opts():
     global visual_studio_path
     global platform
     global architecture
+    global icupkg_path
+    global icu_locales
 
     if len(sys.argv) < 2:
         show_help()
         sys.exit()
-    options, args = getopt.getopt(sys.argv[1:], 'r:p:m:v:eh',["arm64","help"])
+    options, args = getopt.getopt(sys.argv[1:], 'r:p:m:v:eh',["arm64","help","slim-icu=","icu-locales="])
     for opt, arg in options:
         if opt == '-r':
             engine_path = arg # set engine_path, depot_tools and flutter engine folder will be put into this path
@@ -54,6 +58,10 @@ def get_opts():
             architecture = "arm64"
             if platform == "android":
                 gn_params += " --android-cpu=arm64"
+        elif opt == '--slim-icu':
+            icupkg_path = arg
+        elif opt == '--icu-locales':
+            icu_locales = arg
         elif opt in ("-h","--help"):
             show_help()
             sys.exit()
@@ -193,6 +201,26 @@ solutions = [
     os.system("git checkout flutter-1.17-candidate.5")
     os.system("gclient sync -D")
 
+def slim_icu_data():
+    global flutter_root_path
+    global work_path
+    global icupkg_path
+    global icu_locales
+    if icupkg_path == "":
+        return
+
+    # The trimmed data replaces icudtl.dat in place, since every platform
+    # embeds it from there and derives the symbol names from the file name.
+    print("\nSlimming ICU data...")
+    icu_path = Path(flutter_root_path + "/third_party/icu/flutter/icudtl.dat")
+    original_path = Path(flutter_root_path + "/third_party/icu/flutter/icudtl.dat.orig")
+    if not os.path.exists(original_path):
+        shutil.copy(icu_path, original_path)
+    command = "python3 " + str(Path(work_path + "/icu_slim.py")) + " --icupkg " + icupkg_path + " --input " + str(original_path) + " --output " + str(icu_path)
+    if icu_locales != "":
+        command += " --locales " + icu_locales
+    os.system(command)
+
 def compile_engine():
     global flutter_root_path
     global work_path
@@ -378,6 +406,10 @@ def revert_patches():
     global flutter_root_path
     print("\nRevert patches...")
 
+    original_icu_path = Path(flutter_root_path + "/third_party/icu/flutter/icudtl.dat.orig")
+    if os.path.exists(original_icu_path):
+        shutil.move(original_icu_path, Path(flutter_root_path + "/third_party/icu/flutter/icudtl.dat"))
+
     os.chdir(Path(flutter_root_path + "/third_party/skia/"))
     os.system("patch -p1 -R < skia.patch")
 
@@ -492,7 +524,7 @@ def get_rsp(tundra_file, runtime_mode):
 def show_help():
     help_note = '''
 SYNOPSIS
-    python3 lib_build.py <-p <android|ios|windows|mac>> <-r <engine_path>> <-m <debug|release>> [-v [visual_studio_path]] [-e] [-h] [--help].
+    python3 lib_build.py <-p <android|ios|windows|mac>> <-r <engine_path>> <-m <debug|release>> [-v [visual_studio_path]] [-e] [--slim-icu <icupkg_path>] [--icu-locales <locales>] [-h] [--help].
 
 NOTION
     python3 is required to run this script. For windows, visual studio 2017 need to be installed. For mac, Xcode need to be installed and Mac version should be 10 or 11.
@@ -518,6 +550,10 @@ DESCRIPTION
     -e                Enable bitcode for ios targets and can only be used when "-p ios" is specified
 
     -v                The visual studio path in your PC, e.g., "C:\Program Files (x86)/Microsoft Visual Studio/2017/Community". It is required if "-p window" is specified
+
+    --slim-icu        Embeds ICU data trimmed by icu_slim.py to what the engine uses. Takes the path of a host build of ICU's icupkg
+
+    --icu-locales     Comma separated locales whose break iterator data is kept by --slim-icu, "en" by default
 '''
     print(help_note)
 
@@ -530,6 +566,7 @@ def main():
     set_env_verb()   
     get_depot_tools()
     get_flutter_engine()
+    slim_icu_data()
     compile_engine()
     build_engine()
     revert_patches()
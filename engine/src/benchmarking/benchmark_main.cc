@@ -0,0 +1,34 @@
+#include <cstring>
+#include <string>
+
+#include "benchmarking.h"
+#include "flutter/fml/build_config.h"
+#include "lib/ui/text/icu_util.h"
+#include "shell/common/switches.h"
+
+// Runs the engine benchmarks. Besides the flags of Google Benchmark, takes
+// --icu_data_path=<file> for where the ICU data is. By default it is linked
+// in, or read from icudtl.dat next to the executable. The font benchmarks
+// load the fonts in --font_dir=<dir>.
+int main(int argc, char** argv) {
+  const char kIcuDataPathFlag[] = "--icu_data_path=";
+  std::string icu_data_path;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], kIcuDataPathFlag, strlen(kIcuDataPathFlag)) == 0) {
+      icu_data_path = argv[i] + strlen(kIcuDataPathFlag);
+    }
+  }
+
+  if (!icu_data_path.empty()) {
+    uiwidgets::icu::InitializeICU(icu_data_path);
+  } else {
+#if OS_ANDROID || OS_WIN
+    uiwidgets::icu::InitializeICUFromMapping(
+        uiwidgets::GetICUStaticMapping());
+#else
+    uiwidgets::icu::InitializeICU("icudtl.dat");
+#endif
+  }
+
+  return uiwidgets::benchmark::RunBenchmarks(argc, argv);
+}
@@ -0,0 +1,487 @@
+#include "benchmarking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <thread>
+
+#include "flutter/fml/logging.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <unistd.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace uiwidgets {
+namespace benchmark {
+
+namespace {
+
+// The CPU time of the process in nanoseconds.
+int64_t ProcessCpuNanos() {
+#if defined(_WIN32)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!::GetProcessTimes(::GetCurrentProcess(), &creation_time, &exit_time,
+                         &kernel_time, &user_time)) {
+    return 0;
+  }
+  auto to_nanos = [](const FILETIME& time) {
+    ULARGE_INTEGER value;
+    value.LowPart = time.dwLowDateTime;
+    value.HighPart = time.dwHighDateTime;
+    return static_cast<int64_t>(value.QuadPart) * 100;
+  };
+  return to_nanos(kernel_time) + to_nanos(user_time);
+#else
+  timespec time;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+    return 0;
+  }
+  return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+}
+
+std::vector<std::string>& Arguments() {
+  static std::vector<std::string>* arguments = new std::vector<std::string>();
+  return *arguments;
+}
+
+std::vector<Benchmark*>& Registry() {
+  static std::vector<Benchmark*>* benchmarks = new std::vector<Benchmark*>();
+  return *benchmarks;
+}
+
+std::string HostName() {
+#if defined(_WIN32)
+  char name[MAX_COMPUTERNAME_LENGTH + 1];
+  DWORD size = sizeof(name);
+  if (::GetComputerNameA(name, &size)) {
+    return std::string(name, size);
+  }
+#else
+  char name[256];
+  if (gethostname(name, sizeof(name)) == 0) {
+    name[sizeof(name) - 1] = '\0';
+    return name;
+  }
+#endif
+  return "";
+}
+
+std::string LocalTime() {
+  std::time_t now = std::time(nullptr);
+  std::tm local;
+#if defined(_WIN32)
+  localtime_s(&local, &now);
+#else
+  localtime_r(&now, &local);
+#endif
+  char text[64];
+  std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S%z", &local);
+  return text;
+}
+
+struct Result {
+  std::string name;
+  int64_t iterations = 0;
+  double real_time = 0;
+  double cpu_time = 0;
+  int64_t items_processed = 0;
+  int64_t bytes_processed = 0;
+  std::string label;
+  std::string error;
+  std::map<std::string, double> counters;
+};
+
+struct Options {
+  std::string filter = ".";
+  double min_time = -1;
+  bool json = false;
+  std::string out;
+  bool list = false;
+};
+
+bool ParseFlag(const char* arg, const char* flag, std::string* value) {
+  const size_t length = strlen(flag);
+  if (strncmp(arg, flag, length) != 0 || arg[length] != '=') {
+    return false;
+  }
+  *value = arg + length + 1;
+  return true;
+}
+
+}  // namespace
+
+State::State(int64_t max_iterations, std::vector<int64_t> ranges)
+    : max_iterations_(max_iterations), ranges_(std::move(ranges)) {}
+
+State::~State() = default;
+
+State::Iterator State::begin() {
+  StartKeepRunning();
+  return Iterator(this);
+}
+
+bool State::KeepRunning() {
+  if (!started_) {
+    StartKeepRunning();
+  }
+  if (remaining_ > 0) {
+    remaining_--;
+    return true;
+  }
+  FinishKeepRunning();
+  return false;
+}
+
+int64_t State::range(size_t index) const {
+  FML_CHECK(index < ranges_.size());
+  return ranges_[index];
+}
+
+void State::PauseTiming() {
+  FML_DCHECK(running_);
+  real_time_ = real_time_ + (fml::TimePoint::Now() - start_);
+  cpu_time_ += ProcessCpuNanos() - start_cpu_;
+  running_ = false;
+}
+
+void State::ResumeTiming() {
+  FML_DCHECK(!running_);
+  start_ = fml::TimePoint::Now();
+  start_cpu_ = ProcessCpuNanos();
+  running_ = true;
+}
+
+void State::SkipWithError(std::string error) {
+  error_ = std::move(error);
+  // Ends the loop of the benchmark.
+  remaining_ = 0;
+}
+
+void State::StartKeepRunning() {
+  FML_CHECK(!started_) << "A benchmark may only loop once.";
+  started_ = true;
+  remaining_ = error_.empty() ? max_iterations_ : 0;
+  ResumeTiming();
+}
+
+void State::FinishKeepRunning() {
+  if (running_) {
+    PauseTiming();
+  }
+}
+
+Benchmark::Benchmark(std::string name, Function function)
+    : name_(std::move(name)), function_(function) {}
+
+Benchmark::~Benchmark() = default;
+
+Benchmark* Benchmark::Arg(int64_t value) {
+  args_.push_back({value});
+  return this;
+}
+
+Benchmark* Benchmark::Args(std::vector<int64_t> values) {
+  args_.push_back(std::move(values));
+  return this;
+}
+
+Benchmark* Benchmark::Range(int64_t start, int64_t limit, int multiplier) {
+  FML_CHECK(start > 0 && multiplier > 1);
+  for (int64_t value = start; value < limit; value *= multiplier) {
+    Arg(value);
+  }
+  return Arg(limit);
+}
+
+Benchmark* Benchmark::MinTime(double seconds) {
+  min_time_ = seconds;
+  return this;
+}
+
+Benchmark* Benchmark::UseRealTime() {
+  use_real_time_ = true;
+  return this;
+}
+
+Benchmark* RegisterBenchmark(Benchmark* benchmark) {
+  Registry().push_back(benchmark);
+  return benchmark;
+}
+
+// Runs each benchmark with a growing number of iterations until they take
+// long enough to be measured, as Google Benchmark does.
+class Runner {
+ public:
+  static Result RunOne(const Benchmark& benchmark,
+                       const std::vector<int64_t>& args, double min_time) {
+    Result run;
+    run.name = benchmark.name();
+    for (int64_t arg : args) {
+      run.name += "/" + std::to_string(arg);
+    }
+
+    const int64_t kMaxIterations = 1000000000;
+    int64_t iterations = 1;
+    while (true) {
+      State state(iterations, args);
+      benchmark.function_(state);
+      if (!state.error_.empty()) {
+        run.error = state.error_;
+        return run;
+      }
+      FML_CHECK(state.started_) << run.name << " did not loop.";
+
+      const double seconds = benchmark.use_real_time_
+                                 ? state.real_time_.ToSecondsF()
+                                 : state.cpu_time_ / 1e9;
+      if (seconds >= min_time || iterations >= kMaxIterations) {
+        run.iterations = iterations;
+        run.real_time = state.real_time_.ToNanoseconds() /
+                        static_cast<double>(iterations);
+        run.cpu_time = state.cpu_time_ / static_cast<double>(iterations);
+        const double elapsed = std::max(seconds, 1e-9);
+        run.items_processed = state.items_processed_;
+        run.bytes_processed = state.bytes_processed_;
+        if (state.items_processed_ > 0) {
+          run.counters["items_per_second"] = state.items_processed_ / elapsed;
+        }
+        if (state.bytes_processed_ > 0) {
+          run.counters["bytes_per_second"] = state.bytes_processed_ / elapsed;
+        }
+        run.label = state.label_;
+        for (const auto& counter : state.counters) {
+          run.counters[counter.first] = counter.second;
+        }
+        return run;
+      }
+
+      // Aims a little past the minimum time, but grows by at most ten times
+      // at once in case the first iterations were unusually fast.
+      double multiplier = seconds > 0 ? min_time * 1.4 / seconds : 10;
+      multiplier = std::min(10.0, std::max(2.0, multiplier));
+      iterations = std::min<int64_t>(
+          kMaxIterations,
+          static_cast<int64_t>(std::ceil(iterations * multiplier)));
+    }
+  }
+
+  static void RunAll(const Options& options, std::vector<Result>* runs) {
+    std::regex filter(options.filter);
+    for (const Benchmark* benchmark : Registry()) {
+      std::vector<std::vector<int64_t>> arg_sets = benchmark->args_;
+      if (arg_sets.empty()) {
+        arg_sets.emplace_back();
+      }
+      for (const auto& args : arg_sets) {
+        std::string name = benchmark->name();
+        for (int64_t arg : args) {
+          name += "/" + std::to_string(arg);
+        }
+        if (!std::regex_search(name, filter)) {
+          continue;
+        }
+        if (options.list) {
+          std::cout << name << std::endl;
+          continue;
+        }
+
+        const double min_time =
+            options.min_time > 0 ? options.min_time : benchmark->min_time_;
+        runs->push_back(RunOne(*benchmark, args, min_time));
+        const Result& run = runs->back();
+        if (!options.json) {
+          PrintConsole(run);
+        }
+      }
+    }
+  }
+
+  static void PrintConsole(const Result& run) {
+    if (!run.error.empty()) {
+      printf("%-48s ERROR: %s\n", run.name.c_str(), run.error.c_str());
+      return;
+    }
+    printf("%-48s %14.0f ns %14.0f ns %12lld", run.name.c_str(),
+           run.real_time, run.cpu_time,
+           static_cast<long long>(run.iterations));
+    for (const auto& counter : run.counters) {
+      printf(" %s=%g", counter.first.c_str(), counter.second);
+    }
+    if (!run.label.empty()) {
+      printf(" %s", run.label.c_str());
+    }
+    printf("\n");
+    fflush(stdout);
+  }
+
+  static std::string ToJson(const std::vector<Result>& runs,
+                            const char* executable) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+
+    writer.Key("context");
+    writer.StartObject();
+    writer.Key("date");
+    writer.String(LocalTime().c_str());
+    writer.Key("host_name");
+    writer.String(HostName().c_str());
+    writer.Key("executable");
+    writer.String(executable);
+    writer.Key("num_cpus");
+    writer.Uint(std::thread::hardware_concurrency());
+    writer.Key("library_build_type");
+#if defined(NDEBUG)
+    writer.String("release");
+#else
+    writer.String("debug");
+#endif
+    writer.EndObject();
+
+    writer.Key("benchmarks");
+    writer.StartArray();
+    for (const auto& run : runs) {
+      writer.StartObject();
+      writer.Key("name");
+      writer.String(run.name.c_str());
+      writer.Key("run_name");
+      writer.String(run.name.c_str());
+      writer.Key("run_type");
+      writer.String("iteration");
+      writer.Key("repetitions");
+      writer.Int(1);
+      writer.Key("repetition_index");
+      writer.Int(0);
+      writer.Key("threads");
+      writer.Int(1);
+      if (!run.error.empty()) {
+        writer.Key("error_occurred");
+        writer.Bool(true);
+        writer.Key("error_message");
+        writer.String(run.error.c_str());
+        writer.EndObject();
+        continue;
+      }
+      writer.Key("iterations");
+      writer.Int64(run.iterations);
+      writer.Key("real_time");
+      writer.Double(run.real_time);
+      writer.Key("cpu_time");
+      writer.Double(run.cpu_time);
+      writer.Key("time_unit");
+      writer.String("ns");
+      for (const auto& counter : run.counters) {
+        writer.Key(counter.first.c_str());
+        writer.Double(counter.second);
+      }
+      if (!run.label.empty()) {
+        writer.Key("label");
+        writer.String(run.label.c_str());
+      }
+      writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+    return std::string(buffer.GetString(), buffer.GetSize());
+  }
+};
+
+int RunBenchmarks(int argc, char** argv) {
+  Options options;
+  Arguments().assign(argv, argv + argc);
+  for (int i = 1; i < argc; i++) {
+    std::string value;
+    if (ParseFlag(argv[i], "--benchmark_filter", &value)) {
+      options.filter = value;
+    } else if (ParseFlag(argv[i], "--benchmark_min_time", &value)) {
+      options.min_time = std::atof(value.c_str());
+    } else if (ParseFlag(argv[i], "--benchmark_format", &value)) {
+      options.json = value == "json";
+    } else if (ParseFlag(argv[i], "--benchmark_out", &value)) {
+      options.out = value;
+    } else if (strcmp(argv[i], "--benchmark_list_tests") == 0 ||
+               strcmp(argv[i], "--benchmark_list_tests=true") == 0) {
+      options.list = true;
+    }
+  }
+
+  std::vector<Result> runs;
+  Runner::RunAll(options, &runs);
+  if (options.list) {
+    return 0;
+  }
+
+  const std::string json = Runner::ToJson(runs, argc > 0 ? argv[0] : "");
+  if (options.json) {
+    std::cout << json << std::endl;
+  }
+  if (!options.out.empty()) {
+    std::ofstream out(options.out, std::ios::binary);
+    out << json << std::endl;
+    if (!out) {
+      FML_LOG(ERROR) << "Could not write " << options.out;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+std::string GetFlag(const std::string& name) {
+  const std::string flag = "--" + name;
+  std::string value;
+  for (const auto& argument : Arguments()) {
+    if (ParseFlag(argument.c_str(), flag.c_str(), &value)) {
+      return value;
+    }
+  }
+  return "";
+}
+
+size_t ResidentBytes() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!::K32GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                                 sizeof(counters))) {
+    return 0;
+  }
+  return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return 0;
+  }
+  return info.resident_size;
+#else
+  // The second field of statm is the number of resident pages.
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0;
+  size_t resident_pages = 0;
+  if (!(statm >> pages >> resident_pages)) {
+    return 0;
+  }
+  return resident_pages * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+}  // namespace benchmark
+}  // namespace uiwidgets
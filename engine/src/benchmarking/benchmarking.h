@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_point.h"
+
+namespace uiwidgets {
+
+// A small in-tree harness with the interface and the JSON output of Google
+// Benchmark, so that results can be compared with its tools:
+//
+//   static void BM_Something(benchmark::State& state) {
+//     for (auto _ : state) {
+//       DoSomething(state.range(0));
+//     }
+//   }
+//   BENCHMARK(BM_Something)->Arg(8)->Arg(64);
+namespace benchmark {
+
+class State {
+ public:
+  State(int64_t max_iterations, std::vector<int64_t> ranges);
+
+  ~State();
+
+  class Iterator {
+   public:
+    explicit Iterator(State* state) : state_(state) {}
+
+    // Iterates over nothing, the counter is the state's.
+    struct Value {};
+
+    Value operator*() const { return Value(); }
+
+    Iterator& operator++() {
+      state_->remaining_--;
+      return *this;
+    }
+
+    bool operator!=(const Iterator&) const {
+      if (state_->remaining_ > 0) {
+        return true;
+      }
+      state_->FinishKeepRunning();
+      return false;
+    }
+
+   private:
+    State* state_;
+  };
+
+  Iterator begin();
+
+  Iterator end() { return Iterator(this); }
+
+  // For loops that cannot use a range-based for.
+  bool KeepRunning();
+
+  int64_t range(size_t index = 0) const;
+
+  int64_t iterations() const { return max_iterations_; }
+
+  // Keeps the time until ResumeTiming out of the measurement, e.g. for
+  // setting up the next iteration.
+  void PauseTiming();
+
+  void ResumeTiming();
+
+  void SetItemsProcessed(int64_t items) { items_processed_ = items; }
+
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+
+  void SetLabel(std::string label) { label_ = std::move(label); }
+
+  // Skips the benchmark, e.g. because something it needs is missing.
+  void SkipWithError(std::string error);
+
+  // Reported along with the times, as is.
+  std::map<std::string, double> counters;
+
+ private:
+  friend class Runner;
+
+  const int64_t max_iterations_;
+  const std::vector<int64_t> ranges_;
+  int64_t remaining_ = 0;
+  bool started_ = false;
+  bool running_ = false;
+  fml::TimePoint start_;
+  int64_t start_cpu_ = 0;
+  fml::TimeDelta real_time_;
+  int64_t cpu_time_ = 0;
+  int64_t items_processed_ = 0;
+  int64_t bytes_processed_ = 0;
+  std::string label_;
+  std::string error_;
+
+  void StartKeepRunning();
+
+  void FinishKeepRunning();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(State);
+};
+
+typedef void (*Function)(State& state);
+
+class Benchmark {
+ public:
+  Benchmark(std::string name, Function function);
+
+  ~Benchmark();
+
+  // Runs the benchmark once more with state.range(0) set to |value|.
+  Benchmark* Arg(int64_t value);
+
+  Benchmark* Args(std::vector<int64_t> values);
+
+  // Runs the benchmark with the powers of |multiplier| from |start| to
+  // |limit|, both included.
+  Benchmark* Range(int64_t start, int64_t limit, int multiplier = 8);
+
+  // Runs at least this long instead of the default half second.
+  Benchmark* MinTime(double seconds);
+
+  // Reports the wall clock time as the time of the benchmark. Benchmarks
+  // that keep workers busy should, as the CPU time is that of the process.
+  Benchmark* UseRealTime();
+
+  const std::string& name() const { return name_; }
+
+ private:
+  friend class Runner;
+
+  const std::string name_;
+  const Function function_;
+  std::vector<std::vector<int64_t>> args_;
+  double min_time_ = 0.5;
+  bool use_real_time_ = false;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(Benchmark);
+};
+
+// Keeps |benchmark| for RunBenchmarks and returns it.
+Benchmark* RegisterBenchmark(Benchmark* benchmark);
+
+// Runs the registered benchmarks. Understands the flags of Google Benchmark
+// that matter here: --benchmark_filter=<regex>, --benchmark_min_time=<s>,
+// --benchmark_format=<console|json>, --benchmark_out=<file> and
+// --benchmark_list_tests. Returns the exit code of the program.
+int RunBenchmarks(int argc, char** argv);
+
+// Returns the value of --<name>=<value> given to RunBenchmarks, or an empty
+// string, for benchmarks that need e.g. a directory of test data.
+std::string GetFlag(const std::string& name);
+
+// The resident set size of the process in bytes, or zero where it is unknown.
+size_t ResidentBytes();
+
+// Keeps the compiler from optimizing |value| and what computed it away.
+template <class T>
+inline void DoNotOptimize(T const& value) {
+#if defined(_MSC_VER)
+  static volatile const void* sink;
+  sink = &value;
+#else
+  asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+}  // namespace benchmark
+}  // namespace uiwidgets
+
+#define UIWIDGETS_BENCHMARK_CONCAT2(a, b) a##b
+#define UIWIDGETS_BENCHMARK_CONCAT(a, b) UIWIDGETS_BENCHMARK_CONCAT2(a, b)
+
+#define BENCHMARK(function)                                        \
+  static ::uiwidgets::benchmark::Benchmark* UIWIDGETS_BENCHMARK_CONCAT( \
+      benchmark_, __LINE__) =                                      \
+      ::uiwidgets::benchmark::RegisterBenchmark(                   \
+          new ::uiwidgets::benchmark::Benchmark(#function, function))
@@ -46,6 +46,11 @@ std::string Settings::ToString() const {
   stream << "use_test_fonts: " << use_test_fonts << std::endl;
   stream << "enable_software_rendering: " << enable_software_rendering
          << std::endl;
+  stream << "raster_cache_max_bytes: " << raster_cache_max_bytes << std::endl;
+  stream << "raster_cache_max_unused_frames: "
+         << raster_cache_max_unused_frames << std::endl;
+  stream << "raster_cache_async_population: " << raster_cache_async_population
+         << std::endl;
   stream << "log_tag: " << log_tag << std::endl;
   stream << "icu_initialization_required: " << icu_initialization_required
          << std::endl;
@@ -164,6 +164,15 @@ struct Settings {
   UnhandledExceptionCallback unhandled_exception_callback;
   bool enable_software_rendering = false;
   bool skia_deterministic_rendering_on_cpu = false;
+  // The number of bytes the raster cache may use for rasterized pictures and
+  // layers. 0 keeps RasterCache::kDefaultMaxBytes.
+  size_t raster_cache_max_bytes = 0;
+  // The number of consecutive frames an unused raster cache entry is kept.
+  // 0 keeps RasterCache::kDefaultMaxUnusedFrames.
+  size_t raster_cache_max_unused_frames = 0;
+  // Whether the software backend rasterizes raster cache entries on the
+  // engine's concurrent worker threads instead of during the frame.
+  bool raster_cache_async_population = false;
   bool verbose_logging = false;
   std::string log_tag = "uiwidgets";
 
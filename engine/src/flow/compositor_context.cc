@@ -1,6 +1,7 @@
 #include "flow/compositor_context.h"
 
 #include "flow/layers/layer_tree.h"
+#include "flutter/fml/trace_event.h"
 #include "include/core/SkCanvas.h"
 
 namespace uiwidgets {
@@ -16,6 +17,7 @@ void CompositorContext::BeginFrame(ScopedFrame& frame,
     frame_count_.Increment();
     raster_time_.Start();
   }
+  cull_counters_.Reset();
 }
 
 void CompositorContext::EndFrame(ScopedFrame& frame,
@@ -23,6 +25,11 @@ void CompositorContext::EndFrame(ScopedFrame& frame,
   raster_cache_.SweepAfterFrame();
   if (enable_instrumentation) {
     raster_time_.Stop();
+    FML_TRACE_COUNTER("uiwidgets", "LayerCulling",
+                      reinterpret_cast<int64_t>(this),              //
+                      "Painted", cull_counters_.painted().count(),  //
+                      "Culled", cull_counters_.culled().count()     //
+    );
   }
 }
 
@@ -59,9 +66,15 @@ CompositorContext::ScopedFrame::~ScopedFrame() {
 }
 
 RasterStatus CompositorContext::ScopedFrame::Raster(
-    LayerTree& layer_tree, bool ignore_raster_cache) {
+    LayerTree& layer_tree, bool ignore_raster_cache, bool track_damage,
+    const LayerTree* previous_layer_tree) {
   TRACE_EVENT0("uiwidgets", "CompositorContext::ScopedFrame::Raster");
-  bool root_needs_readback = layer_tree.Preroll(*this, ignore_raster_cache);
+  FrameStageTimings& stage_timings = context_.stage_timings();
+  const fml::TimePoint preroll_start = fml::TimePoint::Now();
+  bool root_needs_readback =
+      layer_tree.Preroll(*this, ignore_raster_cache, track_damage);
+  stage_timings.Add(FrameStageTimings::kPreroll,
+                    fml::TimePoint::Now() - preroll_start);
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
   PostPrerollResult post_preroll_result = PostPrerollResult::kSuccess;
   if (view_embedder_ && raster_thread_merger_) {
@@ -72,9 +85,35 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (post_preroll_result == PostPrerollResult::kResubmitFrame) {
     return RasterStatus::kResubmit;
   }
+
+  damage_ = std::nullopt;
+  // The damage is in device space, so only use it when it can be applied as a
+  // clip to the untransformed canvas.
+  if (track_damage && previous_layer_tree &&
+      previous_layer_tree != &layer_tree &&
+      previous_layer_tree->damage_context() &&
+      previous_layer_tree->frame_size() == layer_tree.frame_size() &&
+      canvas() && canvas()->getTotalMatrix().isIdentity() &&
+      !needs_save_layer) {
+    damage_ = layer_tree.damage_context()->ComputeDamage(
+        *previous_layer_tree->damage_context(),
+        SkIRect::MakeSize(layer_tree.frame_size()));
+    if (damage_->isEmpty()) {
+      TRACE_EVENT_INSTANT0("uiwidgets", "no damage, skipping paint");
+      return RasterStatus::kSuccess;
+    }
+  }
+
   // Clearing canvas after preroll reduces one render target switch when preroll
   // paints some raster cache.
+  int save_count = canvas() ? canvas()->getSaveCount() : 0;
   if (canvas()) {
+    if (damage_) {
+      // Everything outside the damage still holds the pixels of the previous
+      // frame.
+      canvas()->save();
+      canvas()->clipRect(SkRect::Make(*damage_));
+    }
     if (needs_save_layer) {
       FML_LOG(INFO) << "Using SaveLayer to protect non-readback surface";
       SkRect bounds = SkRect::Make(layer_tree.frame_size());
@@ -84,10 +123,13 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
     }
     canvas()->clear(SK_ColorTRANSPARENT);
   }
+  const fml::TimePoint paint_start = fml::TimePoint::Now();
   layer_tree.Paint(*this, ignore_raster_cache);
-  if (canvas() && needs_save_layer) {
-    canvas()->restore();
+  if (canvas()) {
+    canvas()->restoreToCount(save_count);
   }
+  stage_timings.Add(FrameStageTimings::kPaint,
+                    fml::TimePoint::Now() - paint_start);
   return RasterStatus::kSuccess;
 }
 
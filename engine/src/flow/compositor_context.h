@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "flow/embedded_views.h"
@@ -56,8 +57,19 @@ class CompositorContext {
 
     GrContext* gr_context() const { return gr_context_; }
 
-    virtual RasterStatus Raster(LayerTree& layer_tree,
-                                bool ignore_raster_cache);
+    // Prerolls and paints |layer_tree| into the canvas of this frame.
+    //
+    // With |track_damage|, the layer tree records what it paints so that the
+    // next frame can be compared against it. If |previous_layer_tree| is also
+    // given, the canvas is expected to still hold the pixels of that tree and
+    // only the region that changed since then is repainted. See damage().
+    virtual RasterStatus Raster(LayerTree& layer_tree, bool ignore_raster_cache,
+                                bool track_damage = false,
+                                const LayerTree* previous_layer_tree = nullptr);
+
+    // The region of the canvas painted by the last call to Raster, or nullopt
+    // if the whole canvas was painted.
+    const std::optional<SkIRect>& damage() const { return damage_; }
 
    private:
     CompositorContext& context_;
@@ -68,6 +80,7 @@ class CompositorContext {
     const bool instrumentation_enabled_;
     const bool surface_supports_readback_;
     fml::RefPtr<fml::RasterThreadMerger> raster_thread_merger_;
+    std::optional<SkIRect> damage_;
 
     FML_DISALLOW_COPY_AND_ASSIGN(ScopedFrame);
   };
@@ -97,10 +110,16 @@ class CompositorContext {
 
   Stopwatch& ui_time() { return ui_time_; }
 
+  CullCounters& cull_counters() { return cull_counters_; }
+
+  FrameStageTimings& stage_timings() { return stage_timings_; }
+
  private:
   RasterCache raster_cache_;
   TextureRegistry texture_registry_;
   Counter frame_count_;
+  CullCounters cull_counters_;
+  FrameStageTimings stage_timings_;
   Stopwatch raster_time_;
   Stopwatch ui_time_;
 
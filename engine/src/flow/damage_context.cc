@@ -0,0 +1,259 @@
+#include "flow/damage_context.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/logging.h"
+
+namespace uiwidgets {
+
+namespace {
+
+constexpr uint64_t kRootState = 0xcbf29ce484222325ull;
+
+// Pixels painted by layers may land up to half a pixel outside their bounds
+// because of the integral translation snapping done while painting.
+constexpr int kBoundsOutset = 1;
+
+// The size of the cells entries are looked up by. Bounds beyond the outer
+// cells are clamped to them.
+constexpr int kCellSize = 256;
+constexpr int kMaxCell = 64;
+
+int CellOf(int coordinate) {
+  const int cell = coordinate >= 0 ? coordinate / kCellSize
+                                   : (coordinate + 1) / kCellSize - 1;
+  return std::clamp(cell, -kMaxCell, kMaxCell);
+}
+
+}  // namespace
+
+DamageContext::DamageContext() { Reset(); }
+
+DamageContext::~DamageContext() = default;
+
+void DamageContext::Reset() {
+  entries_.clear();
+  cells_.clear();
+  state_stack_.clear();
+  state_stack_.push_back(kRootState);
+  full_damage_ = false;
+}
+
+void DamageContext::PushState(uint64_t key) {
+  state_stack_.push_back(Combine(state_stack_.back(), key));
+}
+
+void DamageContext::PopState() {
+  FML_DCHECK(state_stack_.size() > 1);
+  state_stack_.pop_back();
+}
+
+void DamageContext::AddLeaf(uint64_t key, const SkMatrix& matrix,
+                            const SkRect& local_bounds,
+                            const SkRect& cull_rect) {
+  SkIRect bounds;
+  if (!ComputeDeviceBounds(matrix, local_bounds, cull_rect, &bounds)) {
+    return;
+  }
+  AddEntry(CombineMatrix(Combine(state_stack_.back(), key), matrix), bounds,
+           false);
+}
+
+void DamageContext::AddVolatileLeaf(const SkMatrix& matrix,
+                                    const SkRect& local_bounds,
+                                    const SkRect& cull_rect) {
+  SkIRect bounds;
+  if (!ComputeDeviceBounds(matrix, local_bounds, cull_rect, &bounds)) {
+    return;
+  }
+  AddEntry(0, bounds, true);
+}
+
+void DamageContext::EndGroup(size_t group_start, uint64_t key,
+                             const SkMatrix& matrix,
+                             const SkRect& local_bounds,
+                             const SkRect& cull_rect) {
+  FML_DCHECK(group_start <= entries_.size());
+
+  uint64_t group_key = CombineMatrix(Combine(state_stack_.back(), key), matrix);
+  bool is_volatile = false;
+  for (size_t i = group_start; i < entries_.size(); i++) {
+    group_key = Combine(group_key, entries_[i].key);
+    is_volatile = is_volatile || entries_[i].is_volatile;
+  }
+  RemoveEntries(group_start);
+
+  SkIRect bounds;
+  if (!ComputeDeviceBounds(matrix, local_bounds, cull_rect, &bounds)) {
+    return;
+  }
+  AddEntry(group_key, bounds, is_volatile);
+}
+
+SkIRect DamageContext::ComputeDamage(const DamageContext& previous,
+                                     const SkIRect& frame_rect) const {
+  if (full_damage_ || previous.full_damage_) {
+    return frame_rect;
+  }
+
+  auto entry_less = [](const Entry* a, const Entry* b) {
+    if (a->key != b->key) return a->key < b->key;
+    if (a->bounds.fLeft != b->bounds.fLeft)
+      return a->bounds.fLeft < b->bounds.fLeft;
+    if (a->bounds.fTop != b->bounds.fTop)
+      return a->bounds.fTop < b->bounds.fTop;
+    if (a->bounds.fRight != b->bounds.fRight)
+      return a->bounds.fRight < b->bounds.fRight;
+    return a->bounds.fBottom < b->bounds.fBottom;
+  };
+
+  SkIRect damage = SkIRect::MakeEmpty();
+  auto sorted_stable_entries = [&damage](const std::vector<Entry>& entries) {
+    std::vector<const Entry*> result;
+    result.reserve(entries.size());
+    for (const auto& entry : entries) {
+      if (entry.is_volatile) {
+        damage.join(entry.bounds);
+      } else {
+        result.push_back(&entry);
+      }
+    }
+    return result;
+  };
+
+  auto current_entries = sorted_stable_entries(entries_);
+  auto previous_entries = sorted_stable_entries(previous.entries_);
+  std::sort(current_entries.begin(), current_entries.end(), entry_less);
+  std::sort(previous_entries.begin(), previous_entries.end(), entry_less);
+
+  // Whatever is only present in one of the two frames has to be repainted.
+  auto current = current_entries.begin();
+  auto last = previous_entries.begin();
+  while (current != current_entries.end() && last != previous_entries.end()) {
+    if (entry_less(*current, *last)) {
+      damage.join((*current++)->bounds);
+    } else if (entry_less(*last, *current)) {
+      damage.join((*last++)->bounds);
+    } else {
+      current++;
+      last++;
+    }
+  }
+  for (; current != current_entries.end(); current++) {
+    damage.join((*current)->bounds);
+  }
+  for (; last != previous_entries.end(); last++) {
+    damage.join((*last)->bounds);
+  }
+
+  if (!damage.intersect(frame_rect)) {
+    return SkIRect::MakeEmpty();
+  }
+  return damage;
+}
+
+bool DamageContext::ComputeDeviceBounds(const SkMatrix& matrix,
+                                        const SkRect& local_bounds,
+                                        const SkRect& cull_rect,
+                                        SkIRect* bounds) const {
+  SkRect rect = local_bounds;
+  if (!rect.intersect(cull_rect)) {
+    return false;
+  }
+  matrix.mapRect(&rect);
+  *bounds = rect.roundOut().makeOutset(kBoundsOutset, kBoundsOutset);
+  return true;
+}
+
+template <class Function>
+void DamageContext::ForEachCell(const SkIRect& bounds, Function function) {
+  const int right = CellOf(bounds.fRight - 1);
+  const int bottom = CellOf(bounds.fBottom - 1);
+  for (int y = CellOf(bounds.fTop); y <= bottom; y++) {
+    for (int x = CellOf(bounds.fLeft); x <= right; x++) {
+      const uint64_t cell_key =
+          static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 |
+          static_cast<uint32_t>(y);
+      function(x, y, cells_[cell_key]);
+    }
+  }
+}
+
+void DamageContext::AddEntry(uint64_t key, const SkIRect& bounds,
+                             bool is_volatile) {
+  // Leaves painted on top of each other have to be repainted when their order
+  // changes, so the key of each leaf also covers the content of the leaves
+  // directly below it.
+  const auto index = static_cast<uint32_t>(entries_.size());
+  uint64_t below = 0;
+  ForEachCell(bounds, [this, &bounds, &below, index](
+                          int x, int y, std::vector<uint32_t>& cell) {
+    for (uint32_t i : cell) {
+      SkIRect overlap;
+      if (!overlap.intersect(entries_[i].bounds, bounds)) {
+        continue;
+      }
+      // Entries that share several cells are counted in the one with the
+      // top left corner of their overlap.
+      if (CellOf(overlap.fLeft) == x && CellOf(overlap.fTop) == y) {
+        below += entries_[i].content_key;
+      }
+    }
+    cell.push_back(index);
+  });
+  entries_.push_back({Combine(key, below), key, bounds, is_volatile});
+}
+
+void DamageContext::RemoveEntries(size_t start) {
+  for (size_t i = start; i < entries_.size(); i++) {
+    ForEachCell(entries_[i].bounds,
+                [start](int, int, std::vector<uint32_t>& cell) {
+                  while (!cell.empty() && cell.back() >= start) {
+                    cell.pop_back();
+                  }
+                });
+  }
+  entries_.resize(start);
+}
+
+uint64_t DamageContext::Combine(uint64_t seed, uint64_t value) {
+  seed = (seed ^ value) * 0x100000001b3ull;
+  return seed ^ (seed >> 29);
+}
+
+uint64_t DamageContext::CombinePointer(uint64_t seed, const void* pointer) {
+  return Combine(seed, reinterpret_cast<uintptr_t>(pointer));
+}
+
+uint64_t DamageContext::CombineFloat(uint64_t seed, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return Combine(seed, bits);
+}
+
+uint64_t DamageContext::CombineRect(uint64_t seed, const SkRect& rect) {
+  seed = CombineFloat(seed, rect.fLeft);
+  seed = CombineFloat(seed, rect.fTop);
+  seed = CombineFloat(seed, rect.fRight);
+  return CombineFloat(seed, rect.fBottom);
+}
+
+uint64_t DamageContext::CombineRRect(uint64_t seed, const SkRRect& rrect) {
+  seed = CombineRect(seed, rrect.rect());
+  for (int i = 0; i < 4; i++) {
+    SkVector radii = rrect.radii(static_cast<SkRRect::Corner>(i));
+    seed = CombineFloat(seed, radii.fX);
+    seed = CombineFloat(seed, radii.fY);
+  }
+  return seed;
+}
+
+uint64_t DamageContext::CombineMatrix(uint64_t seed, const SkMatrix& matrix) {
+  for (int i = 0; i < 9; i++) {
+    seed = CombineFloat(seed, matrix[i]);
+  }
+  return seed;
+}
+
+}  // namespace uiwidgets
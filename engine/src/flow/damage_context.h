@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+
+namespace uiwidgets {
+
+// Records what the layers of a LayerTree paint during Preroll so that two
+// consecutive frames can be compared and only the pixels that changed are
+// repainted.
+//
+// Every leaf is recorded with a key covering its content, its transformation
+// and the effects (opacity, clips, filters) of its ancestors, together with
+// the device bounds it paints into. Keys may be derived from the addresses of
+// Skia objects. This is safe because the previous LayerTree, which holds those
+// objects, is kept alive until the frames have been compared.
+class DamageContext {
+ public:
+  DamageContext();
+
+  ~DamageContext();
+
+  void Reset();
+
+  // Mixes the parameters of an effect into the keys of all leaves recorded
+  // until the matching PopState.
+  void PushState(uint64_t key);
+
+  void PopState();
+
+  // Records a leaf that paints |local_bounds| under |matrix|. |cull_rect| is
+  // the clip in the same local coordinates.
+  void AddLeaf(uint64_t key, const SkMatrix& matrix, const SkRect& local_bounds,
+               const SkRect& cull_rect);
+
+  // Records a leaf whose content can change while the layer tree stays the
+  // same, such as an external texture. It is repainted every frame.
+  void AddVolatileLeaf(const SkMatrix& matrix, const SkRect& local_bounds,
+                       const SkRect& cull_rect);
+
+  // Layers whose output reaches beyond what their children paint (such as
+  // image filters) collapse the leaves recorded since BeginGroup into a single
+  // leaf covering their own bounds.
+  size_t BeginGroup() const { return entries_.size(); }
+
+  void EndGroup(size_t group_start, uint64_t key, const SkMatrix& matrix,
+                const SkRect& local_bounds, const SkRect& cull_rect);
+
+  // The frame reads back what is below some of its layers (backdrop filters,
+  // platform views) and has to be repainted in full.
+  void MarkFullDamage() { full_damage_ = true; }
+
+  // Returns the part of |frame_rect| that differs between the frame recorded
+  // in |previous| and this one. The result is empty if nothing changed.
+  SkIRect ComputeDamage(const DamageContext& previous,
+                        const SkIRect& frame_rect) const;
+
+  // Helpers for building keys.
+  static uint64_t Combine(uint64_t seed, uint64_t value);
+
+  static uint64_t CombinePointer(uint64_t seed, const void* pointer);
+
+  static uint64_t CombineFloat(uint64_t seed, float value);
+
+  static uint64_t CombineRect(uint64_t seed, const SkRect& rect);
+
+  static uint64_t CombineRRect(uint64_t seed, const SkRRect& rrect);
+
+  static uint64_t CombineMatrix(uint64_t seed, const SkMatrix& matrix);
+
+ private:
+  struct Entry {
+    uint64_t key;
+    uint64_t content_key;
+    SkIRect bounds;
+    bool is_volatile;
+  };
+
+  std::vector<Entry> entries_;
+  // The indices of the entries, ascending, by the cells of a grid over the
+  // device space that their bounds touch. AddEntry only looks at the entries
+  // in the cells of the new one.
+  std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+  std::vector<uint64_t> state_stack_;
+  bool full_damage_ = false;
+
+  bool ComputeDeviceBounds(const SkMatrix& matrix, const SkRect& local_bounds,
+                           const SkRect& cull_rect, SkIRect* bounds) const;
+
+  void AddEntry(uint64_t key, const SkIRect& bounds, bool is_volatile);
+
+  // Removes the entries from |start| on.
+  void RemoveEntries(size_t start);
+
+  // Calls |function| with the coordinates and the contents of every cell that
+  // |bounds| touches.
+  template <class Function>
+  void ForEachCell(const SkIRect& bounds, Function function);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DamageContext);
+};
+
+// Pushes a state onto the DamageContext of a PrerollContext (if any) for the
+// lifetime of the object.
+class AutoDamageState {
+ public:
+  AutoDamageState(DamageContext* damage_context, uint64_t key)
+      : damage_context_(damage_context) {
+    if (damage_context_) damage_context_->PushState(key);
+  }
+
+  ~AutoDamageState() {
+    if (damage_context_) damage_context_->PopState();
+  }
+
+ private:
+  DamageContext* damage_context_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(AutoDamageState);
+};
+
+}  // namespace uiwidgets
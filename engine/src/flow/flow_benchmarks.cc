@@ -0,0 +1,227 @@
+#include <memory>
+#include <vector>
+
+#include "benchmarking/benchmarking.h"
+#include "flow/compositor_context.h"
+#include "flow/damage_context.h"
+#include "flow/layers/container_layer.h"
+#include "flow/layers/layer_tree.h"
+#include "flow/layers/opacity_layer.h"
+#include "flow/layers/picture_layer.h"
+#include "flow/layers/transform_layer.h"
+#include "flow/raster_cache.h"
+#include "flow/skia_gpu_object.h"
+#include "flutter/fml/message_loop.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkSurface.h"
+
+namespace uiwidgets {
+
+namespace {
+
+constexpr int kFrameWidth = 1024;
+constexpr int kFrameHeight = 1024;
+constexpr int kCellSize = 32;
+
+// Pictures are released through the queue on a message loop that never runs
+// here, which is fine as the trees live as long as their benchmark.
+fml::RefPtr<SkiaUnrefQueue> GetUnrefQueue() {
+  static fml::RefPtr<SkiaUnrefQueue>* queue = [] {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    return new fml::RefPtr<SkiaUnrefQueue>(
+        fml::MakeRefCounted<SkiaUnrefQueue>(
+            fml::MessageLoop::GetCurrent().GetTaskRunner(),
+            fml::TimeDelta::FromMilliseconds(8)));
+  }();
+  return *queue;
+}
+
+sk_sp<SkPicture> MakePicture(int seed) {
+  const SkRect bounds = SkRect::MakeWH(kCellSize, kCellSize);
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(bounds);
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  for (int i = 0; i < 8; i++) {
+    paint.setColor(SkColorSetRGB((seed * 37 + i * 11) & 0xFF,
+                                 (seed * 17 + i * 29) & 0xFF,
+                                 (i * 53) & 0xFF));
+    canvas->drawRRect(
+        SkRRect::MakeRectXY(bounds.makeInset(i * 2, i * 2), 4, 4), paint);
+  }
+  return recorder.finishRecordingAsPicture();
+}
+
+// A root with |count| children laid out in a grid, each a transform over an
+// opacity layer over a picture, like the layers of a list of items.
+std::shared_ptr<Layer> MakeLayers(int count) {
+  const int columns = kFrameWidth / kCellSize;
+  auto root = std::make_shared<ContainerLayer>();
+  for (int i = 0; i < count; i++) {
+    auto transform = std::make_shared<TransformLayer>(SkMatrix::MakeTrans(
+        (i % columns) * kCellSize, (i / columns) * kCellSize));
+    auto opacity = std::make_shared<OpacityLayer>(200, SkPoint::Make(0, 0));
+    opacity->Add(std::make_shared<PictureLayer>(
+        SkPoint::Make(0, 0),
+        SkiaGPUObject<SkPicture>(MakePicture(i), GetUnrefQueue()), false,
+        false));
+    transform->Add(std::move(opacity));
+    root->Add(std::move(transform));
+  }
+  return root;
+}
+
+std::unique_ptr<LayerTree> MakeLayerTree(int count) {
+  auto tree = std::make_unique<LayerTree>(
+      SkISize::Make(kFrameWidth, kFrameHeight), 1000, 1);
+  tree->set_root_layer(MakeLayers(count));
+  tree->set_checkerboard_raster_cache_images(false);
+  tree->set_checkerboard_offscreen_layers(false);
+  return tree;
+}
+
+}  // namespace
+
+static void BM_LayerTreePreroll(benchmark::State& state) {
+  auto tree = MakeLayerTree(state.range(0));
+  CompositorContext context;
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kFrameWidth, kFrameHeight);
+  const SkMatrix root_surface_transformation;
+  auto frame =
+      context.AcquireFrame(nullptr, surface->getCanvas(), nullptr,
+                           root_surface_transformation, false, true, nullptr);
+
+  for (auto _ : state) {
+    tree->Preroll(*frame, true);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LayerTreePreroll)->Arg(16)->Arg(256)->Arg(1024);
+
+static void BM_LayerTreePaint(benchmark::State& state) {
+  auto tree = MakeLayerTree(state.range(0));
+  CompositorContext context;
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kFrameWidth, kFrameHeight);
+  const SkMatrix root_surface_transformation;
+  auto frame =
+      context.AcquireFrame(nullptr, surface->getCanvas(), nullptr,
+                           root_surface_transformation, false, true, nullptr);
+  tree->Preroll(*frame, true);
+
+  for (auto _ : state) {
+    tree->Paint(*frame, true);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LayerTreePaint)->Arg(16)->Arg(256)->Arg(1024);
+
+namespace {
+
+std::vector<sk_sp<SkPicture>> MakePictures(int count) {
+  std::vector<sk_sp<SkPicture>> pictures;
+  for (int i = 0; i < count; i++) {
+    pictures.push_back(MakePicture(i));
+  }
+  return pictures;
+}
+
+SkMatrix GetPictureMatrix(int index) {
+  return SkMatrix::MakeTrans((index % 32) * kCellSize,
+                             (index / 32) * kCellSize);
+}
+
+// Prepares every picture once, as a frame that draws them all would.
+void PrepareFrame(RasterCache& cache,
+                  const std::vector<sk_sp<SkPicture>>& pictures) {
+  for (size_t i = 0; i < pictures.size(); i++) {
+    const SkMatrix matrix = GetPictureMatrix(i);
+    cache.Prepare(nullptr, pictures[i].get(), matrix, nullptr, true, false);
+    cache.Get(*pictures[i], matrix);
+  }
+  cache.SweepAfterFrame();
+}
+
+}  // namespace
+
+// A frame of pictures that are all cached already.
+static void BM_RasterCachePrepareHit(benchmark::State& state) {
+  const int count = state.range(0);
+  RasterCache cache(1, count);
+  auto pictures = MakePictures(count);
+  for (int i = 0; i < 3; i++) {
+    PrepareFrame(cache, pictures);
+  }
+  if (cache.GetPictureCachedEntriesCount() != static_cast<size_t>(count)) {
+    state.SkipWithError("The pictures were not cached.");
+  }
+
+  for (auto _ : state) {
+    PrepareFrame(cache, pictures);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RasterCachePrepareHit)->Arg(16)->Arg(256);
+
+// Rasterizing pictures into the cache.
+static void BM_RasterCachePrepareMiss(benchmark::State& state) {
+  const int count = state.range(0);
+  RasterCache cache(1, count);
+  auto pictures = MakePictures(count);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    cache.Clear();
+    // Makes the pictures reach the access threshold.
+    PrepareFrame(cache, pictures);
+    state.ResumeTiming();
+
+    for (int i = 0; i < count; i++) {
+      cache.Prepare(nullptr, pictures[i].get(), GetPictureMatrix(i), nullptr,
+                    true, false);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RasterCachePrepareMiss)->Arg(16)->Arg(64);
+
+static void BM_RasterCacheGet(benchmark::State& state) {
+  const int count = state.range(0);
+  RasterCache cache(1, count);
+  auto pictures = MakePictures(count);
+  for (int i = 0; i < 3; i++) {
+    PrepareFrame(cache, pictures);
+  }
+
+  for (auto _ : state) {
+    for (int i = 0; i < count; i++) {
+      benchmark::DoNotOptimize(cache.Get(*pictures[i], GetPictureMatrix(i)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RasterCacheGet)->Arg(16)->Arg(256);
+
+// Records |range(0)| leaves tiling a 1920 by 1080 frame, a few of them
+// overlapping, the way Preroll does every frame.
+static void BM_DamageContextAddLeaf(benchmark::State& state) {
+  const int count = state.range(0);
+  const SkRect cull_rect = SkRect::MakeWH(1920, 1080);
+  DamageContext damage_context;
+
+  for (auto _ : state) {
+    damage_context.Reset();
+    for (int i = 0; i < count; i++) {
+      const SkMatrix matrix =
+          SkMatrix::MakeTrans(i * 37 % 1900, i * 53 % 1060);
+      damage_context.AddLeaf(i, matrix, SkRect::MakeWH(48, 24), cull_rect);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DamageContextAddLeaf)->Arg(64)->Arg(1024)->Arg(8192);
+
+}  // namespace uiwidgets
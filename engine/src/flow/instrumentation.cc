@@ -5,6 +5,8 @@
 
 #include "include/core/SkPath.h"
 #include "include/core/SkSurface.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 
 namespace uiwidgets {
 
@@ -309,4 +311,80 @@ int64_t CounterValues::GetMinValue() const {
   return min;
 }
 
+fml::TimeDelta StageStatistics::average() const {
+  if (count_ == 0) {
+    return fml::TimeDelta::Zero();
+  }
+  return fml::TimeDelta::FromNanoseconds(total_.ToNanoseconds() / count_);
+}
+
+void StageStatistics::Add(fml::TimeDelta delta) {
+  if (count_ == 0 || delta < min_) {
+    min_ = delta;
+  }
+  if (count_ == 0 || delta > max_) {
+    max_ = delta;
+  }
+  total_ = total_ + delta;
+  count_++;
+}
+
+void StageStatistics::Reset() {
+  count_ = 0;
+  total_ = fml::TimeDelta::Zero();
+  min_ = fml::TimeDelta::Zero();
+  max_ = fml::TimeDelta::Zero();
+}
+
+const char* FrameStageTimings::GetStageName(Stage stage) {
+  switch (stage) {
+    case kBuild:
+      return "build";
+    case kPreroll:
+      return "preroll";
+    case kPaint:
+      return "paint";
+    case kSubmit:
+      return "submit";
+    case kRaster:
+      return "raster";
+    case kCount:
+      break;
+  }
+  return "unknown";
+}
+
+void FrameStageTimings::Reset() {
+  for (auto& stage : stages_) {
+    stage.Reset();
+  }
+}
+
+std::string FrameStageTimings::ToJSON() const {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+  writer.StartObject();
+  for (int i = 0; i < kCount; i++) {
+    const auto stage = static_cast<Stage>(i);
+    const StageStatistics& statistics = stages_[stage];
+    writer.Key(GetStageName(stage));
+    writer.StartObject();
+    writer.Key("count");
+    writer.Uint64(statistics.count());
+    writer.Key("total_us");
+    writer.Int64(statistics.total().ToMicroseconds());
+    writer.Key("min_us");
+    writer.Int64(statistics.min().ToMicroseconds());
+    writer.Key("max_us");
+    writer.Int64(statistics.max().ToMicroseconds());
+    writer.Key("average_us");
+    writer.Int64(statistics.average().ToMicroseconds());
+    writer.EndObject();
+  }
+  writer.EndObject();
+
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
 }  // namespace uiwidgets
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "flutter/fml/macros.h"
@@ -68,6 +69,86 @@ class Counter {
   FML_DISALLOW_COPY_AND_ASSIGN(Counter);
 };
 
+// Per frame count of the layers ContainerLayer::PaintChildren painted and of
+// the ones it skipped because they were entirely outside the cull rect.
+class CullCounters {
+ public:
+  CullCounters() = default;
+
+  const Counter& painted() const { return painted_; }
+
+  const Counter& culled() const { return culled_; }
+
+  void Reset() {
+    painted_.Reset();
+    culled_.Reset();
+  }
+
+  void IncrementPainted() { painted_.Increment(); }
+
+  void IncrementCulled() { culled_.Increment(); }
+
+ private:
+  Counter painted_;
+  Counter culled_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(CullCounters);
+};
+
+// Running statistics of the time one stage of the frame pipeline took.
+class StageStatistics {
+ public:
+  StageStatistics() = default;
+
+  size_t count() const { return count_; }
+
+  fml::TimeDelta total() const { return total_; }
+
+  fml::TimeDelta min() const { return min_; }
+
+  fml::TimeDelta max() const { return max_; }
+
+  fml::TimeDelta average() const;
+
+  void Add(fml::TimeDelta delta);
+
+  void Reset();
+
+ private:
+  size_t count_ = 0;
+  fml::TimeDelta total_;
+  fml::TimeDelta min_;
+  fml::TimeDelta max_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(StageStatistics);
+};
+
+// Timings of the stages of every frame rasterized since the last Reset, so
+// that runs of the same workload can be compared across builds.
+class FrameStageTimings {
+ public:
+  enum Stage { kBuild, kPreroll, kPaint, kSubmit, kRaster, kCount };
+
+  FrameStageTimings() = default;
+
+  static const char* GetStageName(Stage stage);
+
+  const StageStatistics& Get(Stage stage) const { return stages_[stage]; }
+
+  void Add(Stage stage, fml::TimeDelta delta) { stages_[stage].Add(delta); }
+
+  void Reset();
+
+  // Returns an object with the count, total, min, max and average
+  // microseconds of each stage, keyed by the stage name.
+  std::string ToJSON() const;
+
+ private:
+  StageStatistics stages_[kCount];
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FrameStageTimings);
+};
+
 class CounterValues {
  public:
   CounterValues();
@@ -9,6 +9,10 @@ void BackdropFilterLayer::Preroll(PrerollContext* context,
                                   const SkMatrix& matrix) {
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context, true, bool(filter_));
+  // The filter reads back everything painted below it.
+  if (context->damage_context) {
+    context->damage_context->MarkFullDamage();
+  }
   ContainerLayer::Preroll(context, matrix);
 }
 
@@ -19,7 +19,12 @@ void ClipRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
         Layer::AutoPrerollSaveLayerState::Create(context, UsesSaveLayer());
     context->mutators_stack.PushClipRect(clip_rect_);
     SkRect child_paint_bounds = SkRect::MakeEmpty();
-    PrerollChildren(context, matrix, &child_paint_bounds);
+    {
+      AutoDamageState damage_state(
+          context->damage_context,
+          DamageContext::CombineRect(clip_behavior_, clip_rect_));
+      PrerollChildren(context, matrix, &child_paint_bounds);
+    }
 
     if (child_paint_bounds.intersect(clip_rect_)) {
       set_paint_bounds(child_paint_bounds);
@@ -46,6 +51,11 @@ void ClipRectLayer::Paint(PaintContext& context) const {
   if (UsesSaveLayer()) {
     context.internal_nodes_canvas->saveLayer(clip_rect_, nullptr);
   }
+  SkRect child_cull_rect = context.cull_rect;
+  if (!child_cull_rect.intersect(clip_rect_)) {
+    child_cull_rect.setEmpty();
+  }
+  AutoCullRect cull(context, child_cull_rect);
   PaintChildren(context);
   if (UsesSaveLayer()) {
     context.internal_nodes_canvas->restore();
@@ -20,7 +20,12 @@ void ClipRRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
         Layer::AutoPrerollSaveLayerState::Create(context, UsesSaveLayer());
     context->mutators_stack.PushClipRRect(clip_rrect_);
     SkRect child_paint_bounds = SkRect::MakeEmpty();
-    PrerollChildren(context, matrix, &child_paint_bounds);
+    {
+      AutoDamageState damage_state(
+          context->damage_context,
+          DamageContext::CombineRRect(clip_behavior_, clip_rrect_));
+      PrerollChildren(context, matrix, &child_paint_bounds);
+    }
 
     if (child_paint_bounds.intersect(clip_rrect_bounds)) {
       set_paint_bounds(child_paint_bounds);
@@ -47,6 +52,11 @@ void ClipRRectLayer::Paint(PaintContext& context) const {
   if (UsesSaveLayer()) {
     context.internal_nodes_canvas->saveLayer(paint_bounds(), nullptr);
   }
+  SkRect child_cull_rect = context.cull_rect;
+  if (!child_cull_rect.intersect(clip_rrect_.getBounds())) {
+    child_cull_rect.setEmpty();
+  }
+  AutoCullRect cull(context, child_cull_rect);
   PaintChildren(context);
   if (UsesSaveLayer()) {
     context.internal_nodes_canvas->restore();
@@ -9,6 +9,9 @@ void ColorFilterLayer::Preroll(PrerollContext* context,
                                const SkMatrix& matrix) {
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
+  AutoDamageState damage_state(
+      context->damage_context,
+      DamageContext::CombinePointer(0, filter_.get()));
   ContainerLayer::Preroll(context, matrix);
 }
 
@@ -55,9 +55,19 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   // Intentionally not tracing here as there should be no self-time
   // and the trace event on this common function has a small overhead.
   for (auto& layer : layers_) {
-    if (layer->needs_painting()) {
-      layer->Paint(context);
+    if (!layer->needs_painting()) {
+      continue;
     }
+    if (!context.cull_rect.intersects(layer->paint_bounds())) {
+      if (context.cull_counters) {
+        context.cull_counters->IncrementCulled();
+      }
+      continue;
+    }
+    if (context.cull_counters) {
+      context.cull_counters->IncrementPainted();
+    }
+    layer->Paint(context);
   }
 }
 
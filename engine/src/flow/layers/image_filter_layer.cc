@@ -12,6 +12,11 @@ void ImageFilterLayer::Preroll(PrerollContext* context,
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
 
+  // The filter may spread what the children paint (e.g. a blur), so any
+  // change below it damages the whole filtered area.
+  DamageContext* damage_context = context->damage_context;
+  size_t damage_group = damage_context ? damage_context->BeginGroup() : 0;
+
   child_paint_bounds_ = SkRect::MakeEmpty();
   PrerollChildren(context, matrix, &child_paint_bounds_);
   if (filter_) {
@@ -24,6 +29,12 @@ void ImageFilterLayer::Preroll(PrerollContext* context,
     set_paint_bounds(child_paint_bounds_);
   }
 
+  if (damage_context) {
+    damage_context->EndGroup(damage_group,
+                             DamageContext::CombinePointer(0, filter_.get()),
+                             matrix, paint_bounds(), context->cull_rect);
+  }
+
   if (!context->has_platform_view && context->raster_cache &&
       SkRect::Intersects(context->cull_rect, paint_bounds())) {
     SkMatrix ctm = matrix;
@@ -63,6 +74,9 @@ void ImageFilterLayer::Paint(PaintContext& context) const {
   // Preroll on the children before we adjusted them based on the filter.
   Layer::AutoSaveLayer save_layer =
       Layer::AutoSaveLayer::Create(context, child_paint_bounds_, &paint);
+  // The filter may move content into view (e.g. an offset filter), so the
+  // children cannot be culled against the unfiltered cull rect.
+  AutoCullRect cull(context, kGiantRect);
   PaintChildren(context);
 }
 
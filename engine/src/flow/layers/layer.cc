@@ -80,4 +80,15 @@ Layer::AutoSaveLayer::~AutoSaveLayer() {
   paint_context_.internal_nodes_canvas->restore();
 }
 
+Layer::AutoCullRect::AutoCullRect(PaintContext& paint_context,
+                                  const SkRect& cull_rect)
+    : paint_context_(paint_context),
+      previous_cull_rect_(paint_context.cull_rect) {
+  paint_context_.cull_rect = cull_rect;
+}
+
+Layer::AutoCullRect::~AutoCullRect() {
+  paint_context_.cull_rect = previous_cull_rect_;
+}
+
 }  // namespace uiwidgets
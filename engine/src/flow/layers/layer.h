@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 
+#include "flow/damage_context.h"
 #include "flow/embedded_views.h"
 #include "flow/instrumentation.h"
 #include "flow/raster_cache.h"
@@ -53,6 +54,10 @@ struct PrerollContext {
   float total_elevation = 0.0f;
   bool has_platform_view = false;
   bool is_opaque = true;
+
+  // Collects what the layers paint so that the frame can be diffed against
+  // the previous one. Null if damage is not tracked for this preroll.
+  DamageContext* damage_context = nullptr;
 };
 
 // Represents a single composited layer. Created on the UI thread but then
@@ -113,6 +118,28 @@ class Layer {
     // These allow us to make use of the scene metrics during Paint.
     float frame_physical_depth;
     float frame_device_pixel_ratio;
+
+    // The area that can still be drawn to, in the local coordinates of
+    // internal_nodes_canvas. Children entirely outside of it are not painted.
+    SkRect cull_rect = kGiantRect;
+
+    // Counts painted and culled children. May be null.
+    CullCounters* cull_counters = nullptr;
+  };
+
+  // Replaces the cull rect of the PaintContext for the lifetime of this object
+  // and restores the previous one upon destruction.
+  class AutoCullRect {
+   public:
+    AutoCullRect(PaintContext& paint_context, const SkRect& cull_rect);
+
+    ~AutoCullRect();
+
+   private:
+    PaintContext& paint_context_;
+    const SkRect previous_cull_rect_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoCullRect);
   };
 
   // Calls SkCanvas::saveLayer and restores the layer upon destruction. Also
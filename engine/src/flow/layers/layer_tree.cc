@@ -24,7 +24,7 @@ void LayerTree::RecordBuildTime(fml::TimePoint build_start,
 }
 
 bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
-                        bool ignore_raster_cache) {
+                        bool ignore_raster_cache, bool track_damage) {
   TRACE_EVENT0("uiwidgets", "LayerTree::Preroll");
 
   if (!root_layer_) {
@@ -52,6 +52,12 @@ bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       frame_physical_depth_,
       frame_device_pixel_ratio_};
 
+  if (track_damage) {
+    damage_context_.Reset();
+    damage_tracked_ = true;
+    context.damage_context = &damage_context_;
+  }
+
   root_layer_->Preroll(&context, frame.root_surface_transformation());
   return context.surface_needs_readback;
 }
@@ -88,6 +94,13 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
       frame_physical_depth_,
       frame_device_pixel_ratio_};
 
+  // Platform view layers switch the leaf canvas when painted, so nothing may
+  // be culled when an external view embedder is in use.
+  if (frame.view_embedder() == nullptr) {
+    context.cull_rect = frame.canvas()->getLocalClipBounds();
+  }
+  context.cull_counters = &frame.context().cull_counters();
+
   if (root_layer_->needs_painting()) root_layer_->Paint(context);
 }
 
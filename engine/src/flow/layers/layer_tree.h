@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "flow/compositor_context.h"
+#include "flow/damage_context.h"
 #include "flow/layers/layer.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/time/time_delta.h"
@@ -25,8 +26,11 @@ class LayerTree {
   // - a boolean indicating whether or not the top level of the
   //   layer tree performs any operations that require readback
   //   from the root surface.
+  //
+  // If |track_damage| is set, what the layers paint is recorded in
+  // damage_context() so that the next frame can be compared against this one.
   bool Preroll(CompositorContext::ScopedFrame& frame,
-               bool ignore_raster_cache = false);
+               bool ignore_raster_cache = false, bool track_damage = false);
 
   void Paint(CompositorContext::ScopedFrame& frame,
              bool ignore_raster_cache = false) const;
@@ -35,6 +39,12 @@ class LayerTree {
 
   Layer* root_layer() const { return root_layer_.get(); }
 
+  // What the layers painted during the last Preroll that tracked damage, or
+  // null if damage was never tracked for this tree.
+  const DamageContext* damage_context() const {
+    return damage_tracked_ ? &damage_context_ : nullptr;
+  }
+
   void set_root_layer(std::shared_ptr<Layer> root_layer) {
     root_layer_ = std::move(root_layer);
   }
@@ -81,6 +91,8 @@ class LayerTree {
   uint32_t rasterizer_tracing_threshold_;
   bool checkerboard_raster_cache_images_;
   bool checkerboard_offscreen_layers_;
+  DamageContext damage_context_;
+  bool damage_tracked_ = false;
 
   FML_DISALLOW_COPY_AND_ASSIGN(LayerTree);
 };
@@ -37,7 +37,10 @@ void OpacityLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->mutators_stack.PushOpacity(alpha_);
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
-  ContainerLayer::Preroll(context, child_matrix);
+  {
+    AutoDamageState damage_state(context->damage_context, alpha_);
+    ContainerLayer::Preroll(context, child_matrix);
+  }
   context->mutators_stack.Pop();
   context->mutators_stack.Pop();
   context->is_opaque = parent_is_opaque;
@@ -65,10 +68,23 @@ void OpacityLayer::Paint(PaintContext& context) const {
   SkAutoCanvasRestore save(context.internal_nodes_canvas, true);
   context.internal_nodes_canvas->translate(offset_.fX, offset_.fY);
 
+  SkRect child_cull_rect = context.cull_rect.makeOffset(-offset_.fX,
+                                                        -offset_.fY);
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
-  context.internal_nodes_canvas->setMatrix(RasterCache::GetIntegralTransCTM(
-      context.leaf_nodes_canvas->getTotalMatrix()));
+  const SkMatrix unsnapped_ctm = context.leaf_nodes_canvas->getTotalMatrix();
+  const SkMatrix snapped_ctm = RasterCache::GetIntegralTransCTM(unsnapped_ctm);
+  context.internal_nodes_canvas->setMatrix(snapped_ctm);
+
+  // Keep the cull rect covering the same device area under the snapped matrix.
+  SkMatrix inverse_snapped_ctm;
+  if (snapped_ctm.invert(&inverse_snapped_ctm)) {
+    SkMatrix::Concat(inverse_snapped_ctm, unsnapped_ctm)
+        .mapRect(&child_cull_rect);
+  } else {
+    child_cull_rect = kGiantRect;
+  }
 #endif
+  AutoCullRect cull(context, child_cull_rect);
 
   if (context.raster_cache) {
     ContainerLayer* container = GetChildContainer();
@@ -10,6 +10,15 @@
 namespace uiwidgets {
 namespace {
 
+SkFont MakeLabelFont(const std::string& font_path) {
+  SkFont font;
+  if (font_path != "") {
+    font = SkFont(SkTypeface::MakeFromFile(font_path.c_str()));
+  }
+  font.setSize(15);
+  return font;
+}
+
 void VisualizeStopWatch(SkCanvas& canvas, const Stopwatch& stopwatch,
                         SkScalar x, SkScalar y, SkScalar width, SkScalar height,
                         bool show_graph, bool show_labels,
@@ -37,11 +46,7 @@ void VisualizeStopWatch(SkCanvas& canvas, const Stopwatch& stopwatch,
 sk_sp<SkTextBlob> PerformanceOverlayLayer::MakeStatisticsText(
     const Stopwatch& stopwatch, const std::string& label_prefix,
     const std::string& font_path) {
-  SkFont font;
-  if (font_path != "") {
-    font = SkFont(SkTypeface::MakeFromFile(font_path.c_str()));
-  }
-  font.setSize(15);
+  SkFont font = MakeLabelFont(font_path);
 
   double max_ms_per_frame = stopwatch.MaxDelta().ToMillisecondsF();
   double average_ms_per_frame = stopwatch.AverageDelta().ToMillisecondsF();
@@ -56,6 +61,23 @@ sk_sp<SkTextBlob> PerformanceOverlayLayer::MakeStatisticsText(
                                   SkTextEncoding::kUTF8);
 }
 
+sk_sp<SkTextBlob> PerformanceOverlayLayer::MakeTextCacheStatisticsText(
+    const TextCacheStatistics& statistics, const std::string& font_path) {
+  SkFont font = MakeLabelFont(font_path);
+
+  const size_t lookups = statistics.hit_count + statistics.miss_count;
+  const double hit_rate =
+      lookups > 0 ? 100.0 * statistics.hit_count / lookups : 0.0;
+  std::stringstream stream;
+  stream.setf(std::ios::fixed | std::ios::showpoint);
+  stream << std::setprecision(1);
+  stream << "Text  " << statistics.entry_count << " layouts, "
+         << statistics.byte_size / 1024 << " KB, " << hit_rate << "% hits";
+  auto text = stream.str();
+  return SkTextBlob::MakeFromText(text.c_str(), text.size(), font,
+                                  SkTextEncoding::kUTF8);
+}
+
 PerformanceOverlayLayer::PerformanceOverlayLayer(uint64_t options,
                                                  const char* font_path)
     : options_(options) {
@@ -64,6 +86,15 @@ PerformanceOverlayLayer::PerformanceOverlayLayer(uint64_t options,
   }
 }
 
+void PerformanceOverlayLayer::Preroll(PrerollContext* context,
+                                      const SkMatrix& matrix) {
+  // The statistics change every frame.
+  if (auto* damage_context = context->damage_context) {
+    damage_context->AddVolatileLeaf(matrix, paint_bounds(),
+                                    context->cull_rect);
+  }
+}
+
 void PerformanceOverlayLayer::Paint(PaintContext& context) const {
   const int padding = 8;
 
@@ -85,6 +116,16 @@ void PerformanceOverlayLayer::Paint(PaintContext& context) const {
                      width, height - padding,
                      options_ & kVisualizeEngineStatistics,
                      options_ & kDisplayEngineStatistics, "UI", font_path_);
+
+  if (options_ & kDisplayTextCacheStatistics) {
+    const int label_x = 8;
+    const int label_y = 20;
+    auto text = MakeTextCacheStatisticsText(text_cache_statistics_, font_path_);
+    SkPaint paint;
+    paint.setColor(SK_ColorGRAY);
+    context.leaf_nodes_canvas->drawTextBlob(text, x + label_x, y + label_y,
+                                            paint);
+  }
 }
 
 }  // namespace uiwidgets
@@ -14,6 +14,16 @@ const int kDisplayRasterizerStatistics = 1 << 0;
 const int kVisualizeRasterizerStatistics = 1 << 1;
 const int kDisplayEngineStatistics = 1 << 2;
 const int kVisualizeEngineStatistics = 1 << 3;
+const int kDisplayTextCacheStatistics = 1 << 4;
+
+// The state of the paragraph layout cache of the UI thread when the overlay
+// was added to the scene.
+struct TextCacheStatistics {
+  size_t entry_count = 0;
+  size_t byte_size = 0;
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+};
 
 class PerformanceOverlayLayer : public Layer {
  public:
@@ -21,14 +31,24 @@ class PerformanceOverlayLayer : public Layer {
                                               const std::string& label_prefix,
                                               const std::string& font_path);
 
+  static sk_sp<SkTextBlob> MakeTextCacheStatisticsText(
+      const TextCacheStatistics& statistics, const std::string& font_path);
+
   explicit PerformanceOverlayLayer(uint64_t options,
                                    const char* font_path = nullptr);
 
+  void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
+
   void Paint(PaintContext& context) const override;
 
+  void set_text_cache_statistics(const TextCacheStatistics& statistics) {
+    text_cache_statistics_ = statistics;
+  }
+
  private:
   int options_;
   std::string font_path_;
+  TextCacheStatistics text_cache_statistics_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(PerformanceOverlayLayer);
 };
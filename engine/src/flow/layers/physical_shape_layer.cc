@@ -47,8 +47,14 @@ void PhysicalShapeLayer::Preroll(PrerollContext* context,
   context->total_elevation += elevation_;
   total_elevation_ = context->total_elevation;
 
+  uint64_t damage_key =
+      DamageContext::Combine(clip_behavior_, path_.getGenerationID());
+
   SkRect child_paint_bounds;
-  PrerollChildren(context, matrix, &child_paint_bounds);
+  {
+    AutoDamageState damage_state(context->damage_context, damage_key);
+    PrerollChildren(context, matrix, &child_paint_bounds);
+  }
 
   context->total_elevation -= elevation_;
 
@@ -61,6 +67,17 @@ void PhysicalShapeLayer::Preroll(PrerollContext* context,
     set_paint_bounds(ComputeShadowBounds(path_.getBounds(), elevation_,
                                          context->frame_device_pixel_ratio));
   }
+
+  if (auto* damage_context = context->damage_context) {
+    // The shape and its shadow are painted below the children.
+    damage_key = DamageContext::Combine(damage_key, color_);
+    damage_key = DamageContext::Combine(damage_key, shadow_color_);
+    damage_key = DamageContext::CombineFloat(damage_key, elevation_);
+    damage_key = DamageContext::CombineFloat(damage_key,
+                                             context->frame_device_pixel_ratio);
+    damage_context->AddLeaf(damage_key, matrix, paint_bounds(),
+                            context->cull_rect);
+  }
 }
 
 void PhysicalShapeLayer::Paint(PaintContext& context) const {
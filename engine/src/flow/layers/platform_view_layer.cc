@@ -11,6 +11,10 @@ void PlatformViewLayer::Preroll(PrerollContext* context,
   set_paint_bounds(SkRect::MakeXYWH(offset_.x(), offset_.y(), size_.width(),
                                     size_.height()));
 
+  if (context->damage_context) {
+    context->damage_context->MarkFullDamage();
+  }
+
   if (context->view_embedder == nullptr) {
     FML_LOG(ERROR) << "Trying to embed a platform view but the PrerollContext "
                       "does not support embedding";
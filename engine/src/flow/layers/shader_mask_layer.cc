@@ -10,6 +10,11 @@ ShaderMaskLayer::ShaderMaskLayer(sk_sp<SkShader> shader,
 void ShaderMaskLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
+  uint64_t damage_key = DamageContext::CombinePointer(0, shader_.get());
+  damage_key = DamageContext::CombineRect(damage_key, mask_rect_);
+  damage_key = DamageContext::Combine(damage_key,
+                                      static_cast<uint64_t>(blend_mode_));
+  AutoDamageState damage_state(context->damage_context, damage_key);
   ContainerLayer::Preroll(context, matrix);
 }
 
@@ -13,6 +13,11 @@ void TextureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
 
   set_paint_bounds(SkRect::MakeXYWH(offset_.x(), offset_.y(), size_.width(),
                                     size_.height()));
+
+  if (auto* damage_context = context->damage_context) {
+    damage_context->AddVolatileLeaf(matrix, paint_bounds(),
+                                    context->cull_rect);
+  }
 }
 
 void TextureLayer::Paint(PaintContext& context) const {
@@ -53,6 +53,16 @@ void TransformLayer::Paint(PaintContext& context) const {
   SkAutoCanvasRestore save(context.internal_nodes_canvas, true);
   context.internal_nodes_canvas->concat(transform_);
 
+  // Mirrors the cull rect mapping done in Preroll.
+  SkRect child_cull_rect = context.cull_rect;
+  SkMatrix inverse_transform;
+  if (!transform_.hasPerspective() && transform_.invert(&inverse_transform)) {
+    inverse_transform.mapRect(&child_cull_rect);
+  } else {
+    child_cull_rect = kGiantRect;
+  }
+  AutoCullRect cull(context, child_cull_rect);
+
   PaintChildren(context);
 }
 
@@ -1,10 +1,12 @@
 #include "flow/raster_cache.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "flow/layers/layer.h"
 #include "flow/paint_utils.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkImage.h"
@@ -41,12 +43,25 @@ void RasterCacheResult::draw(SkCanvas& canvas, const SkPaint* paint) const {
   canvas.drawImage(image_, bounds.fLeft, bounds.fTop, paint);
 }
 
+// The estimated cost of replaying a single picture op, used next to the
+// measured raster time when weighing entries for eviction.
+static constexpr double kOpCostMicros = 0.5;
+
 RasterCache::RasterCache(size_t access_threshold,
-                         size_t picture_cache_limit_per_frame)
+                         size_t picture_cache_limit_per_frame,
+                         size_t max_bytes, size_t max_unused_frames)
     : access_threshold_(access_threshold),
       picture_cache_limit_per_frame_(picture_cache_limit_per_frame),
+      max_bytes_(max_bytes),
+      max_unused_frames_(max_unused_frames),
       checkerboard_images_(false) {}
 
+static size_t EstimateCacheBytes(const SkRect& logical_rect,
+                                 const SkMatrix& ctm) {
+  const SkIRect bounds = RasterCache::GetDeviceBounds(logical_rect, ctm);
+  return static_cast<size_t>(bounds.width()) * bounds.height() * 4;
+}
+
 static bool CanRasterizePicture(SkPicture* picture) {
   if (picture == nullptr) {
     return false;
@@ -141,6 +156,10 @@ void RasterCache::Prepare(PrerollContext* context, Layer* layer,
   entry.access_count++;
   entry.used_this_frame = true;
   if (!entry.image.is_valid()) {
+    if (!EvictToFit(EstimateCacheBytes(layer->paint_bounds(), ctm), false)) {
+      return;
+    }
+    const fml::TimePoint start = fml::TimePoint::Now();
     entry.image = Rasterize(
         context->gr_context, ctm, context->dst_color_space,
         checkerboard_images_, layer->paint_bounds(),
@@ -165,6 +184,8 @@ void RasterCache::Prepare(PrerollContext* context, Layer* layer,
             layer->Paint(paintContext);
           }
         });
+    entry.raster_time = fml::TimePoint::Now() - start;
+    layer_cache_bytes_ += entry.image.image_bytes();
   }
 }
 
@@ -176,9 +197,9 @@ bool RasterCache::Prepare(GrContext* context, SkPicture* picture,
   if (access_threshold_ == 0) {
     return false;
   }
-  if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
-    return false;
-  }
+  // Without a GrContext the image is a raster surface, which worker threads
+  // can produce without stalling the frame.
+  const bool rasterize_async = concurrent_task_runner_ && context == nullptr;
   if (!IsPictureWorthRasterizing(picture, will_change, is_complex)) {
     // We only deal with pictures that are worthy of rasterization.
     return false;
@@ -197,17 +218,44 @@ bool RasterCache::Prepare(GrContext* context, SkPicture* picture,
 
   // Creates an entry, if not present prior.
   Entry& entry = picture_cache_[cache_key];
+  // The picture is drawn this frame, so its image must not be evicted to
+  // make room for others, as with layers.
+  entry.used_this_frame = true;
   if (entry.access_count < access_threshold_) {
     // Frame threshold has not yet been reached.
     return false;
   }
 
   if (!entry.image.is_valid()) {
+    if (entry.pending) {
+      return false;
+    }
+    if (!rasterize_async &&
+        picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+      return false;
+    }
+    const size_t bytes =
+        EstimateCacheBytes(picture->cullRect(), transformation_matrix);
+    if (!EvictToFit(bytes, false)) {
+      return false;
+    }
+    entry.op_count = picture->approximateOpCount();
+    if (rasterize_async) {
+      entry.pending = true;
+      entry.pending_bytes = bytes;
+      pending_bytes_ += bytes;
+      RasterizePictureAsync(cache_key, picture, transformation_matrix,
+                            dst_color_space);
+      return false;
+    }
+    const fml::TimePoint start = fml::TimePoint::Now();
     entry.image = RasterizePicture(picture, context, transformation_matrix,
                                    dst_color_space, checkerboard_images_);
+    entry.raster_time = fml::TimePoint::Now() - start;
+    picture_cache_bytes_ += entry.image.image_bytes();
     picture_cached_this_frame_++;
   }
-  return true;
+  return entry.image.is_valid();
 }
 
 RasterCacheResult RasterCache::Get(const SkPicture& picture,
@@ -239,9 +287,70 @@ RasterCacheResult RasterCache::Get(Layer* layer, const SkMatrix& ctm) const {
   return entry.image;
 }
 
+void RasterCache::RasterizePictureAsync(const PictureRasterCacheKey& key,
+                                        SkPicture* picture,
+                                        const SkMatrix& ctm,
+                                        SkColorSpace* dst_color_space) {
+  concurrent_task_runner_->PostTask(
+      [results = async_results_, key, picture = sk_ref_sp(picture), ctm,
+       dst_color_space = sk_ref_sp(dst_color_space),
+       checkerboard = checkerboard_images_, generation = generation_]() {
+        const fml::TimePoint start = fml::TimePoint::Now();
+        RasterCacheResult image = RasterizePicture(
+            picture.get(), nullptr, ctm, dst_color_space.get(), checkerboard);
+        const fml::TimeDelta raster_time = fml::TimePoint::Now() - start;
+
+        std::scoped_lock lock(results->mutex);
+        results->results.push_back(
+            {key, std::move(image), raster_time, generation});
+      });
+}
+
+void RasterCache::InstallAsyncResults() {
+  if (!async_results_) {
+    return;
+  }
+
+  std::vector<AsyncResult> results;
+  {
+    std::scoped_lock lock(async_results_->mutex);
+    results.swap(async_results_->results);
+  }
+
+  for (auto& result : results) {
+    if (result.generation != generation_) {
+      continue;
+    }
+    auto it = picture_cache_.find(result.key);
+    if (it == picture_cache_.end() || !it->second.pending) {
+      // The entry was evicted while its image was being rasterized.
+      continue;
+    }
+    Entry& entry = it->second;
+    entry.pending = false;
+    pending_bytes_ -= entry.pending_bytes;
+    entry.pending_bytes = 0;
+    entry.image = std::move(result.image);
+    entry.raster_time = result.raster_time;
+    picture_cache_bytes_ += entry.image.image_bytes();
+  }
+}
+
+void RasterCache::SetConcurrentTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  // Drops the entries waiting for the previous task runner.
+  Clear();
+  concurrent_task_runner_ = std::move(task_runner);
+  if (concurrent_task_runner_ && !async_results_) {
+    async_results_ = std::make_shared<AsyncResults>();
+  }
+}
+
 void RasterCache::SweepAfterFrame() {
-  SweepOneCacheAfterFrame(picture_cache_);
-  SweepOneCacheAfterFrame(layer_cache_);
+  InstallAsyncResults();
+  SweepOneCacheAfterFrame(picture_cache_, &picture_cache_bytes_);
+  SweepOneCacheAfterFrame(layer_cache_, &layer_cache_bytes_);
+  EvictToFit(0, false);
   picture_cached_this_frame_ = 0;
   TraceStatsToTimeline();
 }
@@ -249,6 +358,104 @@ void RasterCache::SweepAfterFrame() {
 void RasterCache::Clear() {
   picture_cache_.clear();
   layer_cache_.clear();
+  picture_cache_bytes_ = 0;
+  layer_cache_bytes_ = 0;
+  pending_bytes_ = 0;
+  generation_++;
+}
+
+void RasterCache::SetMaxBytes(size_t max_bytes) {
+  max_bytes_ = max_bytes;
+  EvictToFit(0, true);
+}
+
+void RasterCache::SetMaxUnusedFrames(size_t max_unused_frames) {
+  max_unused_frames_ = max_unused_frames;
+}
+
+// Higher scores are worth keeping: the entry took long to produce relative to
+// the memory it holds and was used recently.
+double RasterCache::EvictionScore(const Entry& entry) {
+  const double cost_micros =
+      static_cast<double>(entry.raster_time.ToMicroseconds()) +
+      kOpCostMicros * entry.op_count;
+  const double bytes =
+      static_cast<double>(std::max<size_t>(entry.image.image_bytes(), 1));
+  return cost_micros / bytes / (1.0 + entry.unused_frames);
+}
+
+template <class Cache>
+static std::vector<typename Cache::iterator> CollectEvictionCandidates(
+    Cache& cache, bool include_used_this_frame) {
+  std::vector<typename Cache::iterator> candidates;
+  for (auto it = cache.begin(); it != cache.end(); ++it) {
+    if (!it->second.image.is_valid()) {
+      continue;
+    }
+    if (it->second.used_this_frame && !include_used_this_frame) {
+      continue;
+    }
+    candidates.push_back(it);
+  }
+  return candidates;
+}
+
+bool RasterCache::EvictToFit(size_t incoming_bytes,
+                             bool evict_used_this_frame) {
+  // Images still being rasterized count against the budget too.
+  incoming_bytes += pending_bytes_;
+  if (GetCachedBytes() + incoming_bytes <= max_bytes_) {
+    return true;
+  }
+  if (incoming_bytes > max_bytes_) {
+    return false;
+  }
+
+  TRACE_EVENT0("uiwidgets", "RasterCache::EvictToFit");
+
+  // Entries not used in the current frame go first, then the ones that are
+  // cheapest to produce again per byte.
+  auto evict_first = [](const Entry& lhs, const Entry& rhs) {
+    if (lhs.used_this_frame != rhs.used_this_frame) {
+      return !lhs.used_this_frame;
+    }
+    return EvictionScore(lhs) < EvictionScore(rhs);
+  };
+
+  auto pictures =
+      CollectEvictionCandidates(picture_cache_, evict_used_this_frame);
+  auto layers = CollectEvictionCandidates(layer_cache_, evict_used_this_frame);
+  std::sort(pictures.begin(), pictures.end(),
+            [&](const auto& lhs, const auto& rhs) {
+              return evict_first(lhs->second, rhs->second);
+            });
+  std::sort(layers.begin(), layers.end(),
+            [&](const auto& lhs, const auto& rhs) {
+              return evict_first(lhs->second, rhs->second);
+            });
+
+  size_t picture_index = 0;
+  size_t layer_index = 0;
+  while (GetCachedBytes() + incoming_bytes > max_bytes_) {
+    const bool has_picture = picture_index < pictures.size();
+    const bool has_layer = layer_index < layers.size();
+    if (!has_picture && !has_layer) {
+      break;
+    }
+    if (has_picture &&
+        (!has_layer || evict_first(pictures[picture_index]->second,
+                                   layers[layer_index]->second))) {
+      auto it = pictures[picture_index++];
+      picture_cache_bytes_ -= it->second.image.image_bytes();
+      picture_cache_.erase(it);
+    } else {
+      auto it = layers[layer_index++];
+      layer_cache_bytes_ -= it->second.image.image_bytes();
+      layer_cache_.erase(it);
+    }
+  }
+
+  return GetCachedBytes() + incoming_bytes <= max_bytes_;
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
@@ -270,29 +477,14 @@ void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
 void RasterCache::TraceStatsToTimeline() const {
 #if !UIWidgets_RELEASE
 
-  size_t layer_cache_count = 0;
-  size_t layer_cache_bytes = 0;
-  size_t picture_cache_count = 0;
-  size_t picture_cache_bytes = 0;
-
-  for (const auto& item : layer_cache_) {
-    const auto dimensions = item.second.image.image_dimensions();
-    layer_cache_count++;
-    layer_cache_bytes += dimensions.width() * dimensions.height() * 4;
-  }
-
-  for (const auto& item : picture_cache_) {
-    const auto dimensions = item.second.image.image_dimensions();
-    picture_cache_count++;
-    picture_cache_bytes += dimensions.width() * dimensions.height() * 4;
-  }
-
   FML_TRACE_COUNTER("uiwidgets", "RasterCache",
-                    reinterpret_cast<int64_t>(this),             //
-                    "LayerCount", layer_cache_count,             //
-                    "LayerMBytes", layer_cache_bytes * 1e-6,     //
-                    "PictureCount", picture_cache_count,         //
-                    "PictureMBytes", picture_cache_bytes * 1e-6  //
+                    reinterpret_cast<int64_t>(this),               //
+                    "LayerCount", layer_cache_.size(),             //
+                    "LayerMBytes", layer_cache_bytes_ * 1e-6,      //
+                    "PictureCount", picture_cache_.size(),         //
+                    "PictureMBytes", picture_cache_bytes_ * 1e-6,  //
+                    "PendingMBytes", pending_bytes_ * 1e-6,        //
+                    "BudgetMBytes", max_bytes_ * 1e-6              //
   );
 
 #endif  // !UIWidgets_RELEASE
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "flow/instrumentation.h"
 #include "flow/raster_cache_key.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/time/time_delta.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkSize.h"
 
@@ -30,6 +34,11 @@ class RasterCacheResult {
     return image_ ? image_->dimensions() : SkISize::Make(0, 0);
   };
 
+  size_t image_bytes() const {
+    const SkISize dimensions = image_dimensions();
+    return static_cast<size_t>(dimensions.width()) * dimensions.height() * 4;
+  }
+
  private:
   sk_sp<SkImage> image_;
   SkRect logical_rect_;
@@ -45,9 +54,18 @@ class RasterCache {
   // multiple frames.
   static constexpr int kDefaultPictureCacheLimitPerFrame = 3;
 
+  // The default number of bytes the rasterized pictures and layers may occupy.
+  static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+  // The default number of consecutive frames an entry is kept without being
+  // used before it is evicted.
+  static constexpr size_t kDefaultMaxUnusedFrames = 3;
+
   explicit RasterCache(
       size_t access_threshold = 3,
-      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame);
+      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame,
+      size_t max_bytes = kDefaultMaxBytes,
+      size_t max_unused_frames = kDefaultMaxUnusedFrames);
 
   static SkIRect GetDeviceBounds(const SkRect& rect, const SkMatrix& ctm) {
     SkRect device_rect;
@@ -71,7 +89,11 @@ class RasterCache {
   // 2. The matrix is singular
   // 3. The picture is accessed too few times
   // 4. There are too many pictures to be cached in the current frame.
-  //    (See also kDefaultPictureCacheLimitPerFrame.)
+  //    (See also kDefaultPictureCacheLimitPerFrame.) This limit does not
+  //    apply when the picture is rasterized asynchronously, in which case
+  //    false is returned until the image has been installed.
+  // 5. The image would not fit in the byte budget, even after evicting the
+  //    entries that were not used in the current frame.
   bool Prepare(GrContext* context, SkPicture* picture,
                const SkMatrix& transformation_matrix,
                SkColorSpace* dst_color_space, bool is_complex,
@@ -83,41 +105,129 @@ class RasterCache {
 
   RasterCacheResult Get(Layer* layer, const SkMatrix& ctm) const;
 
+  // Ages all entries, evicts the ones that went unused for too long and then
+  // shrinks the cache to its byte budget.
   void SweepAfterFrame();
 
   void Clear();
 
   void SetCheckboardCacheImages(bool checkerboard);
 
+  // Sets the number of bytes the cached images may occupy. Entries are
+  // evicted right away if the cache is over the new budget.
+  void SetMaxBytes(size_t max_bytes);
+
+  // Sets the number of consecutive frames an entry may go unused before it is
+  // evicted. Zero evicts entries as soon as a frame does not use them.
+  void SetMaxUnusedFrames(size_t max_unused_frames);
+
+  size_t GetMaxBytes() const { return max_bytes_; }
+
+  // Rasterizes pictures on |task_runner| instead of inside Prepare when there
+  // is no GrContext (the software backend). Until the image of an entry is
+  // ready Get misses, so the picture is drawn directly; finished images are
+  // installed by SweepAfterFrame and used from the next frame on. Passing null
+  // returns to synchronous rasterization.
+  void SetConcurrentTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
   size_t GetCachedEntriesCount() const;
 
+  size_t GetLayerCachedEntriesCount() const { return layer_cache_.size(); }
+
+  size_t GetPictureCachedEntriesCount() const { return picture_cache_.size(); }
+
+  // The number of bytes used by the cached images, assuming 4 bytes per pixel.
+  size_t GetCachedBytes() const {
+    return layer_cache_bytes_ + picture_cache_bytes_;
+  }
+
+  size_t GetLayerCachedBytes() const { return layer_cache_bytes_; }
+
+  size_t GetPictureCachedBytes() const { return picture_cache_bytes_; }
+
  private:
   struct Entry {
     bool used_this_frame = false;
     size_t access_count = 0;
+    // Consecutive frames, not counting the current one, in which the entry
+    // was not used.
+    size_t unused_frames = 0;
     RasterCacheResult image;
+    // What it took to produce |image|, used to weigh it against its size
+    // when the cache is over budget.
+    fml::TimeDelta raster_time;
+    int op_count = 0;
+    // Whether |image| is being rasterized on a worker thread, and the bytes
+    // reserved for it in the budget meanwhile.
+    bool pending = false;
+    size_t pending_bytes = 0;
   };
 
-  template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
-    std::vector<typename Cache::iterator> dead;
+  struct AsyncResult {
+    PictureRasterCacheKey key;
+    RasterCacheResult image;
+    fml::TimeDelta raster_time;
+    size_t generation;
+  };
 
-    for (auto it = cache.begin(); it != cache.end(); ++it) {
+  // Shared with the worker tasks, which may outlive the cache.
+  struct AsyncResults {
+    std::mutex mutex;
+    std::vector<AsyncResult> results;
+  };
+
+  template <class Cache>
+  void SweepOneCacheAfterFrame(Cache& cache, size_t* cache_bytes) {
+    for (auto it = cache.begin(); it != cache.end();) {
       Entry& entry = it->second;
-      if (!entry.used_this_frame) {
-        dead.push_back(it);
+      if (entry.used_this_frame) {
+        entry.unused_frames = 0;
+      } else {
+        entry.unused_frames++;
       }
       entry.used_this_frame = false;
-    }
 
-    for (auto it : dead) {
-      cache.erase(it);
+      // Entries that only count accesses must be used in consecutive frames
+      // to reach the access threshold.
+      if ((!entry.image.is_valid() && !entry.pending &&
+           entry.unused_frames > 0) ||
+          entry.unused_frames > max_unused_frames_) {
+        *cache_bytes -= entry.image.image_bytes();
+        pending_bytes_ -= entry.pending_bytes;
+        it = cache.erase(it);
+      } else {
+        ++it;
+      }
     }
   }
 
+  // Evicts entries until |incoming_bytes| more fit in the byte budget.
+  // Entries used in the current frame are only evicted if
+  // |evict_used_this_frame| is set. Returns whether the bytes fit.
+  bool EvictToFit(size_t incoming_bytes, bool evict_used_this_frame);
+
+  static double EvictionScore(const Entry& entry);
+
+  void RasterizePictureAsync(const PictureRasterCacheKey& key,
+                             SkPicture* picture, const SkMatrix& ctm,
+                             SkColorSpace* dst_color_space);
+
+  // Moves the images finished by worker threads into their entries.
+  void InstallAsyncResults();
+
   const size_t access_threshold_;
   const size_t picture_cache_limit_per_frame_;
+  size_t max_bytes_;
+  size_t max_unused_frames_;
   size_t picture_cached_this_frame_ = 0;
+  size_t layer_cache_bytes_ = 0;
+  size_t picture_cache_bytes_ = 0;
+  size_t pending_bytes_ = 0;
+  // Incremented by Clear so that late asynchronous results are dropped.
+  size_t generation_ = 0;
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  std::shared_ptr<AsyncResults> async_results_;
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
   bool checkerboard_images_;
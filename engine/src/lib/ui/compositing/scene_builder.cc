@@ -21,6 +21,7 @@
 #include "include/core/SkColorFilter.h"
 #include "lib/ui/painting/matrix.h"
 #include "lib/ui/painting/shader.h"
+#include "lib/ui/ui_mono_state.h"
 
 namespace uiwidgets {
 
@@ -156,6 +157,16 @@ void SceneBuilder::addPerformanceOverlay(uint64_t enabledOptions, float left,
   SkRect rect = SkRect::MakeLTRB(left, top, right, bottom);
   auto layer = std::make_unique<PerformanceOverlayLayer>(enabledOptions);
   layer->set_paint_bounds(rect);
+  if (enabledOptions & kDisplayTextCacheStatistics) {
+    ParagraphLayoutCache& cache =
+        UIMonoState::Current()->GetParagraphLayoutCache();
+    TextCacheStatistics statistics;
+    statistics.entry_count = cache.GetEntryCount();
+    statistics.byte_size = cache.GetByteSize();
+    statistics.hit_count = cache.hit_count();
+    statistics.miss_count = cache.miss_count();
+    layer->set_text_cache_statistics(statistics);
+  }
   AddLayer(std::move(layer));
 }
 
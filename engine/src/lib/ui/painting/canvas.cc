@@ -3,6 +3,8 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#include <cstring>
+
 #include "flow/layers/physical_shape_layer.h"
 #include "image.h"
 #include "include/core/SkBitmap.h"
@@ -266,6 +268,344 @@ void Canvas::drawShadow(const CanvasPath* path, SkColor color, float elevation,
                                  transparentOccluder, dpr);
 }
 
+namespace {
+
+constexpr int kPaintDataWordCount = kPaintDataByteCount / 4;
+constexpr int kRRectWordCount = 12;
+constexpr int kMatrix4WordCount = 16;
+
+class CanvasCommandReader {
+ public:
+  CanvasCommandReader(const uint8_t* ops, int ops_length, void** objects,
+                      int objects_length)
+      : words_(reinterpret_cast<const uint32_t*>(ops)),
+        length_(ops_length / 4),
+        objects_(objects),
+        objects_length_(objects_length),
+        ok_(ops != nullptr && ops_length % 4 == 0 &&
+            reinterpret_cast<uintptr_t>(ops) % 4 == 0) {}
+
+  bool ok() const { return ok_; }
+
+  // Marks the stream as malformed unless |condition| holds.
+  void Require(bool condition) {
+    if (!condition) ok_ = false;
+  }
+
+  bool HasMore() const { return ok_ && position_ < length_; }
+
+  uint32_t ReadUint() {
+    if (!Check(1)) return 0;
+    return words_[position_++];
+  }
+
+  int32_t ReadInt() { return static_cast<int32_t>(ReadUint()); }
+
+  bool ReadBool() { return ReadUint() != 0; }
+
+  float ReadFloat() {
+    uint32_t word = ReadUint();
+    float value;
+    memcpy(&value, &word, sizeof(value));
+    return value;
+  }
+
+  // Returns a view of the next |count| words, which stay owned by the caller
+  // of submitCommands.
+  float* ReadFloats(int count) {
+    if (count < 0 || !Check(count)) return nullptr;
+    auto* result = reinterpret_cast<float*>(
+        const_cast<uint32_t*>(words_ + position_));
+    position_ += count;
+    return result;
+  }
+
+  template <class T>
+  T* ReadObject() {
+    int32_t index = ReadInt();
+    if (index == -1) return nullptr;
+    if (index < 0 || index >= objects_length_ || objects_ == nullptr) {
+      ok_ = false;
+      return nullptr;
+    }
+    return static_cast<T*>(objects_[index]);
+  }
+
+  const Paint& ReadPaint() {
+    switch (ReadUint()) {
+      case kNullPaint:
+        return null_paint_;
+      case kInlinePaint: {
+        void* paint_objects[kPaintObjectCount];
+        for (int i = 0; i < kPaintObjectCount; i++) {
+          paint_objects[i] = ReadObject<void>();
+        }
+        auto* paint_data =
+            reinterpret_cast<uint8_t*>(ReadFloats(kPaintDataWordCount));
+        if (!ok_) return null_paint_;
+        previous_paint_ = Paint(paint_objects, paint_data);
+        has_previous_paint_ = true;
+        return previous_paint_;
+      }
+      case kPreviousPaint:
+        if (!has_previous_paint_) ok_ = false;
+        return previous_paint_;
+      default:
+        ok_ = false;
+        return null_paint_;
+    }
+  }
+
+ private:
+  bool Check(int count) {
+    if (ok_ && count <= length_ - position_) return true;
+    ok_ = false;
+    return false;
+  }
+
+  const uint32_t* words_;
+  const int length_;
+  int position_ = 0;
+  void** objects_;
+  const int objects_length_;
+  bool ok_;
+  const Paint null_paint_;
+  Paint previous_paint_;
+  bool has_previous_paint_ = false;
+};
+
+}  // namespace
+
+void Canvas::submitCommands(const uint8_t* ops, int ops_length, void** objects,
+                            int objects_length) {
+  if (!canvas_) return;
+
+  CanvasCommandReader reader(ops, ops_length, objects, objects_length);
+  while (reader.HasMore()) {
+    switch (reader.ReadUint()) {
+      case kSaveOp:
+        save();
+        break;
+      case kSaveLayerWithoutBoundsOp: {
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) saveLayerWithoutBounds(paint);
+        break;
+      }
+      case kSaveLayerOp: {
+        float* ltrb = reader.ReadFloats(4);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok())
+          saveLayer(ltrb[0], ltrb[1], ltrb[2], ltrb[3], paint);
+        break;
+      }
+      case kRestoreOp:
+        restore();
+        break;
+      case kTranslateOp: {
+        float dx = reader.ReadFloat();
+        float dy = reader.ReadFloat();
+        if (reader.ok()) translate(dx, dy);
+        break;
+      }
+      case kScaleOp: {
+        float sx = reader.ReadFloat();
+        float sy = reader.ReadFloat();
+        if (reader.ok()) scale(sx, sy);
+        break;
+      }
+      case kRotateOp: {
+        float radians = reader.ReadFloat();
+        if (reader.ok()) rotate(radians);
+        break;
+      }
+      case kSkewOp: {
+        float sx = reader.ReadFloat();
+        float sy = reader.ReadFloat();
+        if (reader.ok()) skew(sx, sy);
+        break;
+      }
+      case kTransformOp: {
+        float* matrix4 = reader.ReadFloats(kMatrix4WordCount);
+        if (reader.ok()) transform(matrix4);
+        break;
+      }
+      case kClipRectOp: {
+        float* ltrb = reader.ReadFloats(4);
+        auto clip_op = static_cast<SkClipOp>(reader.ReadUint());
+        bool anti_alias = reader.ReadBool();
+        if (reader.ok())
+          clipRect(ltrb[0], ltrb[1], ltrb[2], ltrb[3], clip_op, anti_alias);
+        break;
+      }
+      case kClipRRectOp: {
+        float* rrect = reader.ReadFloats(kRRectWordCount);
+        bool anti_alias = reader.ReadBool();
+        if (reader.ok()) clipRRect(RRect(rrect), anti_alias);
+        break;
+      }
+      case kClipPathOp: {
+        auto* path = reader.ReadObject<CanvasPath>();
+        bool anti_alias = reader.ReadBool();
+        if (reader.ok()) clipPath(path, anti_alias);
+        break;
+      }
+      case kDrawColorOp: {
+        SkColor color = reader.ReadUint();
+        auto blend_mode = static_cast<SkBlendMode>(reader.ReadUint());
+        if (reader.ok()) drawColor(color, blend_mode);
+        break;
+      }
+      case kDrawLineOp: {
+        float* points = reader.ReadFloats(4);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok())
+          drawLine(points[0], points[1], points[2], points[3], paint);
+        break;
+      }
+      case kDrawPaintOp: {
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawPaint(paint);
+        break;
+      }
+      case kDrawRectOp: {
+        float* ltrb = reader.ReadFloats(4);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawRect(ltrb[0], ltrb[1], ltrb[2], ltrb[3], paint);
+        break;
+      }
+      case kDrawRRectOp: {
+        float* rrect = reader.ReadFloats(kRRectWordCount);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawRRect(RRect(rrect), paint);
+        break;
+      }
+      case kDrawDRRectOp: {
+        float* outer = reader.ReadFloats(kRRectWordCount);
+        float* inner = reader.ReadFloats(kRRectWordCount);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawDRRect(RRect(outer), RRect(inner), paint);
+        break;
+      }
+      case kDrawOvalOp: {
+        float* ltrb = reader.ReadFloats(4);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawOval(ltrb[0], ltrb[1], ltrb[2], ltrb[3], paint);
+        break;
+      }
+      case kDrawCircleOp: {
+        float* circle = reader.ReadFloats(3);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawCircle(circle[0], circle[1], circle[2], paint);
+        break;
+      }
+      case kDrawArcOp: {
+        float* arc = reader.ReadFloats(6);
+        bool use_center = reader.ReadBool();
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok())
+          drawArc(arc[0], arc[1], arc[2], arc[3], arc[4], arc[5], use_center,
+                  paint);
+        break;
+      }
+      case kDrawPathOp: {
+        auto* path = reader.ReadObject<CanvasPath>();
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawPath(path, paint);
+        break;
+      }
+      case kDrawImageOp: {
+        auto* image = reader.ReadObject<CanvasImage>();
+        float x = reader.ReadFloat();
+        float y = reader.ReadFloat();
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawImage(image, x, y, paint);
+        break;
+      }
+      case kDrawImageRectOp: {
+        auto* image = reader.ReadObject<CanvasImage>();
+        float* src = reader.ReadFloats(4);
+        float* dst = reader.ReadFloats(4);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok())
+          drawImageRect(image, src[0], src[1], src[2], src[3], dst[0], dst[1],
+                        dst[2], dst[3], paint);
+        break;
+      }
+      case kDrawImageNineOp: {
+        auto* image = reader.ReadObject<CanvasImage>();
+        float* center = reader.ReadFloats(4);
+        float* dst = reader.ReadFloats(4);
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok())
+          drawImageNine(image, center[0], center[1], center[2], center[3],
+                        dst[0], dst[1], dst[2], dst[3], paint);
+        break;
+      }
+      case kDrawPictureOp: {
+        auto* picture = reader.ReadObject<Picture>();
+        if (reader.ok()) drawPicture(picture);
+        break;
+      }
+      case kDrawPointsOp: {
+        const Paint& paint = reader.ReadPaint();
+        auto point_mode = static_cast<SkCanvas::PointMode>(reader.ReadUint());
+        int points_length = reader.ReadInt();
+        float* points = reader.ReadFloats(points_length);
+        if (reader.ok()) drawPoints(paint, point_mode, points, points_length);
+        break;
+      }
+      case kDrawVerticesOp: {
+        auto* vertices = reader.ReadObject<Vertices>();
+        auto blend_mode = static_cast<SkBlendMode>(reader.ReadUint());
+        const Paint& paint = reader.ReadPaint();
+        if (reader.ok()) drawVertices(vertices, blend_mode, paint);
+        break;
+      }
+      case kDrawAtlasOp: {
+        const Paint& paint = reader.ReadPaint();
+        auto* atlas = reader.ReadObject<CanvasImage>();
+        int transforms_length = reader.ReadInt();
+        float* transforms = reader.ReadFloats(transforms_length);
+        int rects_length = reader.ReadInt();
+        float* rects = reader.ReadFloats(rects_length);
+        int colors_length = reader.ReadInt();
+        auto* colors =
+            reinterpret_cast<int32_t*>(reader.ReadFloats(colors_length));
+        auto blend_mode = static_cast<SkBlendMode>(reader.ReadUint());
+        float* cull_rect = reader.ReadBool() ? reader.ReadFloats(4) : nullptr;
+        // Every sprite has a transform and a rect of four floats, and a color
+        // if there are colors at all.
+        reader.Require(transforms_length % 4 == 0 &&
+                       rects_length == transforms_length &&
+                       (colors_length == 0 ||
+                        colors_length * 4 == rects_length));
+        if (reader.ok())
+          drawAtlas(paint, atlas, transforms, transforms_length, rects,
+                    rects_length, colors_length ? colors : nullptr,
+                    colors_length, blend_mode, cull_rect);
+        break;
+      }
+      case kDrawShadowOp: {
+        auto* path = reader.ReadObject<CanvasPath>();
+        SkColor color = reader.ReadUint();
+        float elevation = reader.ReadFloat();
+        bool transparent_occluder = reader.ReadBool();
+        if (reader.ok())
+          drawShadow(path, color, elevation, transparent_occluder);
+        break;
+      }
+      default:
+        Mono_ThrowException(
+            "Canvas.submitCommands called with an unknown opcode.");
+        return;
+    }
+  }
+
+  if (!reader.ok())
+    Mono_ThrowException(
+        "Canvas.submitCommands called with a malformed command buffer.");
+}
+
 void Canvas::Clear() { canvas_ = nullptr; }
 
 bool Canvas::IsRecording() const { return !!canvas_; }
@@ -455,4 +795,10 @@ Canvas_drawShadow(Canvas* ptr, CanvasPath* path, SkColor color, float elevation,
   ptr->drawShadow(path, color, elevation, transparentOccluder);
 }
 
+UIWIDGETS_API(void)
+Canvas_submitCommands(Canvas* ptr, const uint8_t* ops, int len, void** objects,
+                      int obj_count) {
+  ptr->submitCommands(ops, len, objects, obj_count);
+}
+
 }  // namespace uiwidgets
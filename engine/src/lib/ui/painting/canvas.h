@@ -15,6 +15,57 @@
 
 namespace uiwidgets {
 
+// Opcodes understood by Canvas::submitCommands, encoded on the managed side by
+// CanvasCommandBuffer. Arguments follow the opcode in the order of the
+// corresponding Canvas method, one 32-bit word each. Objects are encoded as an
+// index into the objects table (-1 for null), RRects as 12 floats and matrices
+// as 16 floats. A paint argument starts with a PaintTag word.
+enum CanvasOp : uint32_t {
+  kSaveOp = 0,
+  kSaveLayerWithoutBoundsOp = 1,  // paint
+  kSaveLayerOp = 2,               // l, t, r, b, paint
+  kRestoreOp = 3,
+  kTranslateOp = 4,  // dx, dy
+  kScaleOp = 5,      // sx, sy
+  kRotateOp = 6,     // radians
+  kSkewOp = 7,       // sx, sy
+  kTransformOp = 8,  // matrix4
+  kClipRectOp = 9,   // l, t, r, b, clip_op, anti_alias
+  kClipRRectOp = 10,  // rrect, anti_alias
+  kClipPathOp = 11,   // path, anti_alias
+  kDrawColorOp = 12,  // color, blend_mode
+  kDrawLineOp = 13,   // x1, y1, x2, y2, paint
+  kDrawPaintOp = 14,  // paint
+  kDrawRectOp = 15,   // l, t, r, b, paint
+  kDrawRRectOp = 16,  // rrect, paint
+  kDrawDRRectOp = 17,  // outer, inner, paint
+  kDrawOvalOp = 18,    // l, t, r, b, paint
+  kDrawCircleOp = 19,  // x, y, radius, paint
+  kDrawArcOp = 20,  // l, t, r, b, start_angle, sweep_angle, use_center, paint
+  kDrawPathOp = 21,   // path, paint
+  kDrawImageOp = 22,  // image, x, y, paint
+  kDrawImageRectOp = 23,  // image, src ltrb, dst ltrb, paint
+  kDrawImageNineOp = 24,  // image, center ltrb, dst ltrb, paint
+  kDrawPictureOp = 25,    // picture
+  kDrawPointsOp = 26,  // paint, point_mode, points_length, points...
+  kDrawVerticesOp = 27,  // vertices, blend_mode, paint
+  // paint, atlas, transforms_length, transforms..., rects_length, rects...,
+  // colors_length, colors..., blend_mode, has_cull_rect, [cull ltrb]
+  kDrawAtlasOp = 28,
+  kDrawShadowOp = 29,  // path, color, elevation, transparent_occluder
+};
+
+enum PaintTag : uint32_t {
+  // No paint, e.g. for saveLayer without a paint.
+  kNullPaint = 0,
+  // Shader, color filter and image filter indices, followed by the paint data
+  // words in the same layout as the paint_data of the Canvas_* entry points.
+  kInlinePaint = 1,
+  // Reuse the last inline paint of the same submission without decoding it
+  // again.
+  kPreviousPaint = 2,
+};
+
 class Canvas : public fml::RefCountedThreadSafe<Canvas> {
   FML_FRIEND_MAKE_REF_COUNTED(Canvas);
 
@@ -87,6 +138,14 @@ class Canvas : public fml::RefCountedThreadSafe<Canvas> {
   void drawShadow(const CanvasPath* path, SkColor color, float elevation,
                   bool transparentOccluder);
 
+  // Replays a stream of encoded canvas operations in a single call. The
+  // stream is a sequence of 32-bit words: an opcode followed by its inline
+  // arguments. Paths, images, pictures, vertices, shaders and filters are
+  // passed as indices into |objects|. See CanvasOp for the layout of each
+  // operation.
+  void submitCommands(const uint8_t* ops, int ops_length, void** objects,
+                      int objects_length);
+
   SkCanvas* canvas() const { return canvas_; }
   void Clear();
   bool IsRecording() const;
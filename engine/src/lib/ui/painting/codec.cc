@@ -10,6 +10,7 @@
 #include "include/codec/SkCodec.h"
 #include "include/core/SkPixelRef.h"
 #include "multi_frame_codec.h"
+#include "pixel_buffer_pool.h"
 #include "single_frame_codec.h"
 
 #if OS_ANDROID
@@ -26,14 +27,17 @@ enum PixelFormat {
   kBGRA8888,
 };
 
+}  // anonymous namespace
+
 #if OS_ANDROID
 
 // Compressed image buffers are allocated on the UI thread but are deleted on a
 // decoder worker thread.  Android's implementation of malloc appears to
 // continue growing the native heap size when the allocating thread is
 // different from the freeing thread.  To work around this, create an SkData
-// backed by an anonymous mapping.
-sk_sp<SkData> MakeSkDataWithCopy(const void* data, size_t length) {
+// backed by an anonymous mapping. Large buffers come from the
+// PixelBufferPool, which maps its buffers as well.
+static sk_sp<SkData> MakeMappedDataWithCopy(const void* data, size_t length) {
   if (length == 0) {
     return SkData::MakeEmpty();
   }
@@ -43,7 +47,7 @@ sk_sp<SkData> MakeSkDataWithCopy(const void* data, size_t length) {
                          MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
 
   if (mapping == MAP_FAILED) {
-    return SkData::MakeEmpty();
+    return nullptr;
   }
 
   *reinterpret_cast<size_t*>(mapping) = mapping_length;
@@ -61,15 +65,18 @@ sk_sp<SkData> MakeSkDataWithCopy(const void* data, size_t length) {
   return SkData::MakeWithProc(mapping_data, length, proc, mapping);
 }
 
-#else
+#endif  // OS_ANDROID
 
 sk_sp<SkData> MakeSkDataWithCopy(const void* data, size_t length) {
+  if (length >= PixelBufferPool::kMinPooledBytes) {
+    return PixelBufferPool::GetInstance().MakeDataWithCopy(data, length);
+  }
+#if OS_ANDROID
+  return MakeMappedDataWithCopy(data, length);
+#else
   return SkData::MakeWithCopy(data, length);
-}
-
 #endif  // OS_ANDROID
-
-}  // anonymous namespace
+}
 
 static std::variant<ImageDecoder::ImageInfo, std::string> ConvertImageInfo(
     Codec::_ImageInfo _image_info) {
@@ -131,6 +138,9 @@ Codec_instantiateImageCodec(uint8_t* data, int data_length,
   }
 
   sk_sp<SkData> buffer = MakeSkDataWithCopy(data, data_length);
+  if (!buffer) {
+    return "Could not allocate memory for the image data.";
+  }
 
   if (image_info) {
     const auto expected_size =
@@ -3,6 +3,7 @@
 #include "frame_info.h"
 #include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
 #include "include/core/SkImage.h"
 #include "runtime/mono_state.h"
 
@@ -43,4 +44,8 @@ class Codec : public fml::RefCountedThreadSafe<Codec> {
   };
 };
 
+// Copies encoded image data handed over from managed code. The copy may be
+// freed on a decoder thread. Returns null if memory could not be allocated.
+sk_sp<SkData> MakeSkDataWithCopy(const void* data, size_t length);
+
 }  // namespace uiwidgets
@@ -0,0 +1,123 @@
+#include "decoded_image_cache.h"
+
+#include "flutter/fml/trace_event.h"
+
+namespace uiwidgets {
+
+namespace {
+
+uint64_t HashCombine(uint64_t hash, uint64_t value) {
+  return (hash ^ value) * 0x100000001b3ull;
+}
+
+// Another reference to the image of |object|, also released through its
+// unref queue.
+SkiaGPUObject<SkImage> Share(const SkiaGPUObject<SkImage>& object) {
+  if (!object.get()) {
+    return {};
+  }
+  return {object.get(), object.queue()};
+}
+
+}  // namespace
+
+bool DecodedImageCache::Key::operator==(const Key& other) const {
+  if (data_hash != other.data_hash || target_width != other.target_width ||
+      target_height != other.target_height || color_type != other.color_type ||
+      width != other.width || height != other.height ||
+      row_bytes != other.row_bytes) {
+    return false;
+  }
+  if (data == other.data) {
+    return true;
+  }
+  return data && other.data && data->equals(other.data.get());
+}
+
+size_t DecodedImageCache::KeyHash::operator()(const Key& key) const {
+  uint64_t hash = key.data_hash;
+  hash = HashCombine(hash, key.data ? key.data->size() : 0);
+  hash = HashCombine(hash, (static_cast<uint64_t>(key.target_width) << 32) |
+                               key.target_height);
+  hash = HashCombine(hash, key.color_type);
+  hash = HashCombine(hash, (static_cast<uint64_t>(key.width) << 32) |
+                               static_cast<uint32_t>(key.height));
+  return static_cast<size_t>(hash);
+}
+
+DecodedImageCache::DecodedImageCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+DecodedImageCache::~DecodedImageCache() {
+  auto pending = std::move(pending_);
+  pending_.clear();
+  for (auto& [key, results] : pending) {
+    for (auto& result : results) {
+      result({});
+    }
+  }
+}
+
+SkiaGPUObject<SkImage> DecodedImageCache::Get(const Key& key) {
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    miss_count_++;
+    return {};
+  }
+
+  hit_count_++;
+  entries_.splice(entries_.begin(), entries_, found->second);
+  return Share(found->second->image);
+}
+
+bool DecodedImageCache::AddPending(const Key& key, ImageResult result) {
+  auto& results = pending_[key];
+  results.push_back(std::move(result));
+  return results.size() == 1;
+}
+
+void DecodedImageCache::Complete(const Key& key,
+                                 SkiaGPUObject<SkImage> image) {
+  auto found = pending_.find(key);
+  if (found == pending_.end()) {
+    return;
+  }
+  std::vector<ImageResult> results = std::move(found->second);
+  pending_.erase(found);
+
+  // The entry keeps the data of its key alive as well.
+  const size_t byte_size =
+      image.get() ? image.get()->imageInfo().computeMinByteSize() +
+                        key.data->size()
+                  : 0;
+  if (image.get() && byte_size <= max_bytes_ && index_.count(key) == 0) {
+    entries_.push_front({key, Share(image), byte_size});
+    index_.emplace(key, entries_.begin());
+    byte_size_ += byte_size;
+    while (byte_size_ > max_bytes_) {
+      RemoveLast();
+    }
+  }
+
+  // The first result takes the decoded object, the others share its image.
+  for (size_t i = 1; i < results.size(); i++) {
+    results[i](Share(image));
+  }
+  results.front()(std::move(image));
+}
+
+void DecodedImageCache::Purge() {
+  TRACE_EVENT0("uiwidgets", "DecodedImageCache::Purge");
+  index_.clear();
+  entries_.clear();
+  byte_size_ = 0;
+}
+
+void DecodedImageCache::RemoveLast() {
+  Entry& entry = entries_.back();
+  byte_size_ -= entry.byte_size;
+  index_.erase(entry.key);
+  entries_.pop_back();
+}
+
+}  // namespace uiwidgets
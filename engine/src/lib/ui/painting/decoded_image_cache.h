@@ -0,0 +1,97 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+
+namespace uiwidgets {
+
+// Decoded images by the data and size they were decoded from, so that codecs
+// for the same image share one decode and upload. Requests for an image whose
+// decode is in flight wait for that decode. Owned by the ImageDecoder and only
+// used on the UI thread.
+class DecodedImageCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+  struct Key {
+    // The encoded or decompressed data. Keys with equal hashes compare the
+    // bytes, so different images never share an entry.
+    sk_sp<SkData> data;
+    uint32_t data_hash = 0;
+    // Zero if not resized.
+    uint32_t target_width = 0;
+    uint32_t target_height = 0;
+    // The layout of decompressed data, unknown for encoded data.
+    SkColorType color_type = kUnknown_SkColorType;
+    int width = 0;
+    int height = 0;
+    size_t row_bytes = 0;
+
+    bool operator==(const Key& other) const;
+  };
+
+  using ImageResult = std::function<void(SkiaGPUObject<SkImage>)>;
+
+  explicit DecodedImageCache(size_t max_bytes = kDefaultMaxBytes);
+
+  // Passes an empty object to the results still queued, so that their
+  // callers release what they hold for the decode.
+  ~DecodedImageCache();
+
+  // Returns the image cached for |key|, or an empty object.
+  SkiaGPUObject<SkImage> Get(const Key& key);
+
+  // Queues |result| for the image of |key|. Returns true if no decode of
+  // |key| is in flight yet, in which case the caller decodes it and passes
+  // the image to Complete.
+  bool AddPending(const Key& key, ImageResult result);
+
+  // Caches the image decoded for |key| and passes it to the results queued
+  // for it. Failed decodes pass an empty object and are not cached.
+  void Complete(const Key& key, SkiaGPUObject<SkImage> image);
+
+  // Drops all cached images. Decodes in flight are not affected.
+  void Purge();
+
+  size_t GetEntryCount() const { return entries_.size(); }
+
+  size_t GetByteSize() const { return byte_size_; }
+
+  size_t hit_count() const { return hit_count_; }
+
+  size_t miss_count() const { return miss_count_; }
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    SkiaGPUObject<SkImage> image;
+    size_t byte_size;
+  };
+  using EntryList = std::list<Entry>;
+
+  const size_t max_bytes_;
+  EntryList entries_;  // Most recently used first.
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+  std::unordered_map<Key, std::vector<ImageResult>, KeyHash> pending_;
+  size_t byte_size_ = 0;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+
+  void RemoveLast();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodedImageCache);
+};
+
+}  // namespace uiwidgets
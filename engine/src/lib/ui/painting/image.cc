@@ -10,9 +10,16 @@ CanvasImage::CanvasImage() = default;
 
 CanvasImage::~CanvasImage() = default;
 
-const char* CanvasImage::toByteData(int format, RawEncodeImageCallback callback,
+const char* CanvasImage::toByteData(int format, int quality,
+                                    RawEncodeImageCallback callback,
                                     Mono_Handle callback_handle) {
-  return EncodeImage(this, format, callback, callback_handle);
+  return EncodeImage(this, format, quality, callback, callback_handle);
+}
+
+const char* CanvasImage::toByteChunks(int format, int quality,
+                                      RawEncodeImageChunkCallback callback,
+                                      Mono_Handle callback_handle) {
+  return EncodeImageInChunks(this, format, quality, callback, callback_handle);
 }
 
 void CanvasImage::dispose() {}
@@ -35,10 +42,19 @@ UIWIDGETS_API(int) Image_width(CanvasImage* ptr) { return ptr->width(); }
 UIWIDGETS_API(int) Image_height(CanvasImage* ptr) { return ptr->height(); }
 
 UIWIDGETS_API(const char*)
-Image_toByteData(CanvasImage* ptr, int format,
+Image_toByteData(CanvasImage* ptr, int format, int quality,
                  RawEncodeImageCallback encode_image_callback,
                  Mono_Handle callback_handle) {
-  return ptr->toByteData(format, encode_image_callback, callback_handle);
+  return ptr->toByteData(format, quality, encode_image_callback,
+                         callback_handle);
+}
+
+UIWIDGETS_API(const char*)
+Image_toByteChunks(CanvasImage* ptr, int format, int quality,
+                   RawEncodeImageChunkCallback encode_image_callback,
+                   Mono_Handle callback_handle) {
+  return ptr->toByteChunks(format, quality, encode_image_callback,
+                           callback_handle);
 }
 
 }  // namespace uiwidgets
@@ -19,9 +19,14 @@ class CanvasImage final : public fml::RefCountedThreadSafe<CanvasImage> {
 
   int height() { return image_.get()->height(); }
 
-  const char* toByteData(int format, RawEncodeImageCallback callback,
+  const char* toByteData(int format, int quality,
+                         RawEncodeImageCallback callback,
                          Mono_Handle callback_handle);
 
+  const char* toByteChunks(int format, int quality,
+                           RawEncodeImageChunkCallback callback,
+                           Mono_Handle callback_handle);
+
   void dispose();
 
   sk_sp<SkImage> image() const { return image_.get(); }
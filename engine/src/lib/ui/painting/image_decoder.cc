@@ -1,16 +1,195 @@
 #include "image_decoder.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "flutter/fml/make_copyable.h"
 #include "include/codec/SkCodec.h"
+#include "lib/ui/painting/pixel_buffer_pool.h"
 #include "src/codec/SkCodecImageGenerator.h"
+#include "src/core/SkOpts.h"
 
 namespace uiwidgets {
 namespace {
 
 constexpr double kAspectRatioChangedThreshold = 0.01;
 
+// Images with at least this many pixels to decode are decoded in bands of
+// rows straight into the resized image when they are resized down.
+constexpr int64_t kBandedDecodeMinPixels = 4 * 1024 * 1024;
+
+// The minimum number of resized rows per band. Each band skips the source
+// rows above it, which costs a fraction of decoding them.
+constexpr int kMinBandRows = 128;
+
+// The number of source rows decoded at a time.
+constexpr int kBandStripRows = 16;
+
+// Averages the source pixels that each pixel of a resized row covers.
+class RowAverager {
+ public:
+  RowAverager(int source_width, int target_width) : offsets_(1, 0) {
+    const double scale = static_cast<double>(source_width) / target_width;
+    for (int x = 0; x < target_width; x++) {
+      const double left = x * scale;
+      const double right =
+          x + 1 == target_width ? source_width : (x + 1) * scale;
+      const int first = static_cast<int>(left);
+      const int last =
+          std::min(source_width, static_cast<int>(std::ceil(right)));
+      firsts_.push_back(first);
+      for (int column = first; column < last; column++) {
+        const double overlap = std::min<double>(column + 1, right) -
+                               std::max<double>(column, left);
+        weights_.push_back(static_cast<float>(overlap / scale));
+      }
+      offsets_.push_back(weights_.size());
+    }
+  }
+
+  int target_width() const { return firsts_.size(); }
+
+  // Writes the 4 channels of each target pixel as floats.
+  void Average(const uint8_t* source, float* target) const {
+    for (size_t x = 0; x < firsts_.size(); x++) {
+      float sum[4] = {0, 0, 0, 0};
+      const uint8_t* pixel = source + firsts_[x] * 4;
+      for (size_t tap = offsets_[x]; tap < offsets_[x + 1]; tap++) {
+        const float weight = weights_[tap];
+        for (int channel = 0; channel < 4; channel++) {
+          sum[channel] += pixel[channel] * weight;
+        }
+        pixel += 4;
+      }
+      for (int channel = 0; channel < 4; channel++) {
+        target[x * 4 + channel] = sum[channel];
+      }
+    }
+  }
+
+ private:
+  std::vector<int> firsts_;
+  std::vector<size_t> offsets_;
+  std::vector<float> weights_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(RowAverager);
+};
+
+// Decodes an image in bands of rows of the resized image, each with its own
+// codec. Shared with the workers that help decoding it.
+struct BandedDecode {
+  BandedDecode(sk_sp<SkData> data,
+               const SkImageInfo& decode_info,
+               const SkPixmap& target)
+      : data(std::move(data)),
+        decode_info(decode_info),
+        target(target),
+        averager(decode_info.width(), target.width()) {}
+
+  const sk_sp<SkData> data;
+  const SkImageInfo decode_info;
+  const SkPixmap target;
+  const RowAverager averager;
+  std::vector<std::pair<int, int>> bands;
+  std::atomic<size_t> next_band{0};
+  std::atomic<bool> failed{false};
+  std::mutex mutex;
+  std::condition_variable done_condition;
+  size_t done_count = 0;
+
+  // Decodes bands until none are left to claim.
+  void Run() {
+    size_t done = 0;
+    for (size_t index = next_band++; index < bands.size();
+         index = next_band++) {
+      if (!failed && !DecodeBand(bands[index].first, bands[index].second)) {
+        failed = true;
+      }
+      done++;
+    }
+    if (done > 0) {
+      std::lock_guard<std::mutex> lock(mutex);
+      done_count += done;
+      if (done_count == bands.size()) {
+        done_condition.notify_all();
+      }
+    }
+  }
+
+  // Decodes the source rows that the target rows from |top| to |bottom|
+  // cover, a strip at a time, and averages them into the target.
+  bool DecodeBand(int top, int bottom) {
+    TRACE_EVENT0("uiwidgets", "ImageDecoder::DecodeBand");
+
+    auto codec = SkCodec::MakeFromData(data);
+    if (!codec ||
+        codec->startScanlineDecode(decode_info) != SkCodec::kSuccess) {
+      return false;
+    }
+
+    const int source_height = decode_info.height();
+    const int target_height = target.height();
+    const double scale = static_cast<double>(source_height) / target_height;
+    const int source_top = static_cast<int>(top * scale);
+    const int source_bottom = std::min(
+        source_height, static_cast<int>(std::ceil(bottom * scale)));
+    if (source_top > 0 && !codec->skipScanlines(source_top)) {
+      return false;
+    }
+
+    const size_t row_bytes = decode_info.minRowBytes();
+    const size_t channel_count = averager.target_width() * 4;
+    std::vector<uint8_t> strip(row_bytes * kBandStripRows);
+    std::vector<float> row(channel_count);
+    std::vector<float> sum(channel_count, 0);
+
+    int y = top;
+    for (int strip_top = source_top; strip_top < source_bottom && y < bottom;
+         strip_top += kBandStripRows) {
+      const int strip_rows =
+          std::min(kBandStripRows, source_bottom - strip_top);
+      // The codec fills in the rows that truncated data is missing.
+      codec->getScanlines(strip.data(), strip_rows, row_bytes);
+
+      for (int i = 0; i < strip_rows && y < bottom; i++) {
+        averager.Average(strip.data() + i * row_bytes, row.data());
+
+        // A source row adds to each target row it overlaps.
+        const int source_row = strip_top + i;
+        while (y < bottom) {
+          const double y_top = y * scale;
+          const double y_bottom =
+              y + 1 == target_height ? source_height : (y + 1) * scale;
+          const double overlap = std::min<double>(source_row + 1, y_bottom) -
+                                 std::max<double>(source_row, y_top);
+          if (overlap > 0) {
+            const float weight = static_cast<float>(overlap / scale);
+            for (size_t k = 0; k < channel_count; k++) {
+              sum[k] += row[k] * weight;
+            }
+          }
+          if (y_bottom > source_row + 1) {
+            break;
+          }
+
+          auto* out = static_cast<uint8_t*>(target.writable_addr(0, y));
+          for (size_t k = 0; k < channel_count; k++) {
+            out[k] = static_cast<uint8_t>(std::min(255.0f, sum[k] + 0.5f));
+          }
+          std::fill(sum.begin(), sum.end(), 0.0f);
+          y++;
+        }
+      }
+    }
+    return y == bottom;
+  }
+};
+
 }  // namespace
 
 ImageDecoder::ImageDecoder(
@@ -62,6 +241,25 @@ static SkISize GetResizedDimensions(SkISize current_size,
   return current_size;
 }
 
+// Like SkImage::makeRasterImage, but decodes lazy images into pooled pixels.
+static sk_sp<SkImage> MakeRasterImage(sk_sp<SkImage> image) {
+  if (!image || !image->isLazyGenerated()) {
+    return image ? image->makeRasterImage() : nullptr;
+  }
+
+  SkBitmap bitmap;
+  if (!PixelBufferPool::GetInstance().TryAllocPixels(&bitmap,
+                                                     image->imageInfo()) ||
+      !image->readPixels(bitmap.pixmap(), 0, 0)) {
+    return image->makeRasterImage();
+  }
+
+  // Marking this as immutable makes the MakeFromBitmap call share the pixels
+  // instead of copying.
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
 static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
                                         const SkISize& resized_dimensions,
                                         const fml::tracing::TraceFlow& flow) {
@@ -76,7 +274,7 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
   }
 
   if (image->dimensions() == resized_dimensions) {
-    return image->makeRasterImage();
+    return MakeRasterImage(std::move(image));
   }
 
   if (resized_dimensions.width() > image->dimensions().width() ||
@@ -106,7 +304,8 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
       image->imageInfo().makeDimensions(resized_dimensions);
 
   SkBitmap scaled_bitmap;
-  if (!scaled_bitmap.tryAllocPixels(scaled_image_info)) {
+  if (!PixelBufferPool::GetInstance().TryAllocPixels(&scaled_bitmap,
+                                                     scaled_image_info)) {
     FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
                    << scaled_image_info.computeMinByteSize() << "B";
     return nullptr;
@@ -131,6 +330,80 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
   return scaled_image;
 }
 
+// Decodes |data| at |decode_dimensions| and averages it down to
+// |resized_dimensions| in bands of rows, so that the image is never held at
+// its decoded size. Returns null if the codec cannot decode in bands.
+static sk_sp<SkImage> DecodeInBands(
+    sk_sp<SkData> data,
+    const SkCodec& codec,
+    const SkISize& decode_dimensions,
+    const SkISize& resized_dimensions,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner,
+    const fml::tracing::TraceFlow& flow) {
+  TRACE_EVENT0("uiwidgets", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  // Averaging needs premultiplied pixels.
+  const SkImageInfo& codec_info = codec.getInfo();
+  const SkImageInfo decode_info =
+      codec_info.makeColorType(kN32_SkColorType)
+          .makeAlphaType(codec_info.alphaType() == kOpaque_SkAlphaType
+                             ? kOpaque_SkAlphaType
+                             : kPremul_SkAlphaType)
+          .makeDimensions(decode_dimensions);
+
+  SkBitmap resized_bitmap;
+  if (!PixelBufferPool::GetInstance().TryAllocPixels(
+          &resized_bitmap, decode_info.makeDimensions(resized_dimensions))) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << decode_info.makeDimensions(resized_dimensions)
+                          .computeMinByteSize()
+                   << "B";
+    return nullptr;
+  }
+
+  auto banded = std::make_shared<BandedDecode>(std::move(data), decode_info,
+                                               resized_bitmap.pixmap());
+
+  // Skipping rows is cheap enough to decode in parallel for JPEG only. The
+  // other formats decode the rows they skip.
+  size_t band_count = 1;
+  if (task_runner &&
+      codec.getEncodedFormat() == SkEncodedImageFormat::kJPEG) {
+    band_count = std::clamp<size_t>(
+        resized_dimensions.height() / kMinBandRows, 1,
+        std::max(1u, std::thread::hardware_concurrency()));
+  }
+  for (size_t i = 0; i < band_count; i++) {
+    banded->bands.emplace_back(
+        resized_dimensions.height() * i / band_count,
+        resized_dimensions.height() * (i + 1) / band_count);
+  }
+
+  for (size_t i = 1; i < band_count; i++) {
+    task_runner->PostTask([banded]() { banded->Run(); });
+  }
+
+  // Only the bands claimed by a helper are waited for, so a helper that only
+  // starts once all bands are claimed does not hold up the decode.
+  banded->Run();
+  {
+    std::unique_lock<std::mutex> lock(banded->mutex);
+    banded->done_condition.wait(lock, [&banded]() {
+      return banded->done_count == banded->bands.size();
+    });
+  }
+
+  if (banded->failed) {
+    return nullptr;
+  }
+
+  // Marking this as immutable makes the MakeFromBitmap call share the pixels
+  // instead of copying.
+  resized_bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(resized_bitmap);
+}
+
 static sk_sp<SkImage> ImageFromDecompressedData(
     sk_sp<SkData> data, ImageDecoder::ImageInfo info,
     std::optional<uint32_t> target_width, std::optional<uint32_t> target_height,
@@ -146,7 +419,7 @@ static sk_sp<SkImage> ImageFromDecompressedData(
 
   if (!target_width && !target_height) {
     // No resizing requested. Just rasterize the image.
-    return image->makeRasterImage();
+    return MakeRasterImage(std::move(image));
   }
 
   auto resized_dimensions =
@@ -155,16 +428,18 @@ static sk_sp<SkImage> ImageFromDecompressedData(
   return ResizeRasterImage(std::move(image), resized_dimensions, flow);
 }
 
-sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
-                                       std::optional<uint32_t> target_width,
-                                       std::optional<uint32_t> target_height,
-                                       const fml::tracing::TraceFlow& flow) {
+sk_sp<SkImage> ImageFromCompressedData(
+    sk_sp<SkData> data,
+    std::optional<uint32_t> target_width,
+    std::optional<uint32_t> target_height,
+    const fml::tracing::TraceFlow& flow,
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
   TRACE_EVENT0("uiwidgets", __FUNCTION__);
   flow.Step(__FUNCTION__);
 
   if (!target_width && !target_height) {
     // No resizing requested. Just decode & rasterize the image.
-    return SkImage::MakeFromEncoded(data)->makeRasterImage();
+    return MakeRasterImage(SkImage::MakeFromEncoded(data));
   }
 
   auto codec = SkCodec::MakeFromData(data);
@@ -184,7 +459,7 @@ sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
 
   // No resize needed.
   if (resized_dimensions == source_dimensions) {
-    return SkImage::MakeFromEncoded(data)->makeRasterImage();
+    return MakeRasterImage(SkImage::MakeFromEncoded(data));
   }
 
   auto decode_dimensions = codec_ptr->getScaledDimensions(
@@ -193,6 +468,25 @@ sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
                static_cast<double>(resized_dimensions.height()) /
                    source_dimensions.height()));
 
+  // Large images that are only resized down are decoded straight into the
+  // resized bitmap, rather than decoding all of it and resizing after.
+  // Oriented images keep the path below, which applies the orientation.
+  const SkEncodedImageFormat format = codec_ptr->getEncodedFormat();
+  if (codec_ptr->getOrigin() == kTopLeft_SkEncodedOrigin &&
+      (format == SkEncodedImageFormat::kJPEG ||
+       format == SkEncodedImageFormat::kPNG ||
+       format == SkEncodedImageFormat::kBMP) &&
+      static_cast<int64_t>(decode_dimensions.width()) *
+              decode_dimensions.height() >=
+          kBandedDecodeMinPixels &&
+      resized_dimensions.width() <= decode_dimensions.width() &&
+      resized_dimensions.height() <= decode_dimensions.height()) {
+    if (auto image = DecodeInBands(data, *codec_ptr, decode_dimensions,
+                                   resized_dimensions, task_runner, flow)) {
+      return image;
+    }
+  }
+
   // If the codec supports efficient sub-pixel decoding, decoded at a resolution
   // close to the target resolution before resizing.
   if (decode_dimensions != codec_ptr->dimensions()) {
@@ -205,7 +499,8 @@ sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
         image_generator->getInfo().makeDimensions(decode_dimensions);
 
     SkBitmap scaled_bitmap;
-    if (!scaled_bitmap.tryAllocPixels(scaled_image_info)) {
+    if (!PixelBufferPool::GetInstance().TryAllocPixels(&scaled_bitmap,
+                                                       scaled_image_info)) {
       FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
                      << scaled_image_info.computeMinByteSize() << "B";
       return nullptr;
@@ -301,6 +596,120 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
   FML_DCHECK(callback);
   FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
 
+  if (!descriptor.data || descriptor.data->size() == 0) {
+    DecodeOnWorker(nullptr, false, std::move(flow), callback);
+    return;
+  }
+
+  // Hashing the data takes long for large images, so the key is made on a
+  // worker and looked up back on the UI thread.
+  concurrent_task_runner_->PostTask(fml::MakeCopyable(
+      [weak_this = weak_factory_.GetWeakPtr(),
+       ui_runner = runners_.GetUITaskRunner(), descriptor, callback,
+       flow = std::move(flow)]() mutable {
+        DecodedImageCache::Key key = MakeCacheKey(descriptor);
+        ui_runner->PostTask(fml::MakeCopyable(
+            [weak_this, descriptor = std::move(descriptor), callback,
+             key = std::move(key), flow = std::move(flow)]() mutable {
+              if (!weak_this) {
+                callback({});
+                return;
+              }
+              weak_this->DecodeCached(std::move(descriptor), std::move(key),
+                                      std::move(flow), callback);
+            }));
+      }));
+}
+
+void ImageDecoder::DecodeCached(ImageDescriptor descriptor,
+                                DecodedImageCache::Key key,
+                                fml::tracing::TraceFlow flow,
+                                const ImageResult& callback) {
+  TRACE_EVENT0("uiwidgets", __FUNCTION__);
+  if (auto image = cache_.Get(key); image.get()) {
+    callback(std::move(image));
+    return;
+  }
+
+  if (!cache_.AddPending(key, callback)) {
+    // Shares the decode of the same image in flight.
+    return;
+  }
+
+  DecodeOnWorker(
+      [descriptor, task_runner = concurrent_task_runner_](
+          const fml::tracing::TraceFlow& flow) mutable {
+        auto decompressed =
+            descriptor.decompressed_image_info
+                ? ImageFromDecompressedData(
+                      std::move(descriptor.data),                  //
+                      descriptor.decompressed_image_info.value(),  //
+                      descriptor.target_width,                     //
+                      descriptor.target_height,                    //
+                      flow                                         //
+                      )
+                : ImageFromCompressedData(std::move(descriptor.data),  //
+                                          descriptor.target_width,     //
+                                          descriptor.target_height,    //
+                                          flow,                        //
+                                          task_runner);
+        if (!decompressed) {
+          FML_LOG(ERROR) << "Could not decompress image.";
+        }
+        return decompressed;
+      },
+      false, std::move(flow),
+      [weak_this = weak_factory_.GetWeakPtr(), key](auto image) {
+        // If the decoder is gone, its cache already passed an empty object to
+        // the results queued for |key|.
+        if (weak_this) {
+          weak_this->cache_.Complete(key, std::move(image));
+        }
+      });
+}
+
+DecodedImageCache::Key ImageDecoder::MakeCacheKey(
+    const ImageDescriptor& descriptor) {
+  TRACE_EVENT0("uiwidgets", __FUNCTION__);
+  const sk_sp<SkData>& data = descriptor.data;
+
+  DecodedImageCache::Key key;
+  key.data = data;
+  key.data_hash = SkOpts::hash(data->data(), data->size(), 0);
+  key.target_width = descriptor.target_width.value_or(0);
+  key.target_height = descriptor.target_height.value_or(0);
+  if (const auto& info = descriptor.decompressed_image_info) {
+    key.color_type = info->sk_info.colorType();
+    key.width = info->sk_info.width();
+    key.height = info->sk_info.height();
+    key.row_bytes = info->row_bytes;
+  }
+  return key;
+}
+
+void ImageDecoder::PurgeCache() {
+  cache_.Purge();
+}
+
+void ImageDecoder::DecodeWith(DecodeFunction decode, bool reuses_pixels,
+                              const ImageResult& callback) {
+  TRACE_EVENT0("uiwidgets", __FUNCTION__);
+  fml::tracing::TraceFlow flow(__FUNCTION__);
+
+  FML_DCHECK(callback);
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  DecodeOnWorker(
+      [decode = std::move(decode)](const fml::tracing::TraceFlow& flow) {
+        return decode();
+      },
+      reuses_pixels, std::move(flow), callback);
+}
+
+void ImageDecoder::DecodeOnWorker(TracedDecodeFunction decode,
+                                  bool reuses_pixels,
+                                  fml::tracing::TraceFlow flow,
+                                  const ImageResult& callback) {
   // Always service the callback on the UI thread.
   auto result = [callback, ui_runner = runners_.GetUITaskRunner()](
                     SkiaGPUObject<SkImage> image,
@@ -315,13 +724,14 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
         }));
   };
 
-  if (!descriptor.data || descriptor.data->size() == 0) {
+  if (!decode) {
     result({}, std::move(flow));
     return;
   }
 
   concurrent_task_runner_->PostTask(
-      fml::MakeCopyable([descriptor,                              //
+      fml::MakeCopyable([decode = std::move(decode),              //
+                         reuses_pixels,                           //
                          io_manager = io_manager_,                //
                          io_runner = runners_.GetIOTaskRunner(),  //
                          result,                                  //
@@ -330,22 +740,9 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
         // Step 1: Decompress the image.
         // On Worker.
 
-        auto decompressed =
-            descriptor.decompressed_image_info
-                ? ImageFromDecompressedData(
-                      std::move(descriptor.data),                  //
-                      descriptor.decompressed_image_info.value(),  //
-                      descriptor.target_width,                     //
-                      descriptor.target_height,                    //
-                      flow                                         //
-                      )
-                : ImageFromCompressedData(std::move(descriptor.data),  //
-                                          descriptor.target_width,     //
-                                          descriptor.target_height,    //
-                                          flow);
+        auto decompressed = decode(flow);
 
         if (!decompressed) {
-          FML_LOG(ERROR) << "Could not decompress image.";
           result({}, std::move(flow));
           return;
         }
@@ -353,7 +750,8 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
         // Step 2: Update the image to the GPU.
         // On IO Thread.
 
-        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed,
+                                               reuses_pixels, result,
                                                flow =
                                                    std::move(flow)]() mutable {
           if (!io_manager) {
@@ -365,6 +763,10 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
           // might not have set one or a software backend could be in use.
           // Either way, just return the image as-is.
           if (!io_manager->GetResourceContext()) {
+            SkPixmap pixmap;
+            if (reuses_pixels && decompressed->peekPixels(&pixmap)) {
+              decompressed = SkImage::MakeRasterCopy(pixmap);
+            }
             result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
                    std::move(flow));
             return;
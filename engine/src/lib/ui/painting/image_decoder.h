@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <optional>
 
@@ -15,6 +16,7 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
 #include "lib/ui/io_manager.h"
+#include "lib/ui/painting/decoded_image_cache.h"
 
 namespace uiwidgets {
 
@@ -51,22 +53,65 @@ class ImageDecoder {
   // concurrently. Texture upload is done on the IO thread and the result
   // returned back on the UI thread. On error, the texture is null but the
   // callback is guaranteed to return on the UI thread.
+  //
+  // Images are cached by a hash of their data and their target size, so
+  // decoding the same data again, or while it is being decoded, shares the
+  // decoded image.
   void Decode(ImageDescriptor descriptor, const ImageResult& result);
 
+  // Drops the cached images, e.g. when memory runs low.
+  void PurgeCache();
+
+  using DecodeFunction = std::function<sk_sp<SkImage>()>;
+
+  // Runs |decode| on a worker and uploads the raster image it returns like
+  // Decode does. A null image is passed on to |result| as is. If
+  // |reuses_pixels| is set, the caller writes to the pixels of the image
+  // again once |result| was called, so when there is no resource context to
+  // upload to, |result| receives a copy.
+  void DecodeWith(DecodeFunction decode, bool reuses_pixels,
+                  const ImageResult& result);
+
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
+  // The workers of the engine's concurrent message loop. Other UI thread work
+  // that can be split up runs on them as well.
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentTaskRunner() const {
+    return concurrent_task_runner_;
+  }
+
  private:
   TaskRunners runners_;
   std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   fml::WeakPtr<IOManager> io_manager_;
+  DecodedImageCache cache_;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
 
+  static DecodedImageCache::Key MakeCacheKey(
+      const ImageDescriptor& descriptor);
+
+  // Passes the image cached for |key| to |result|, or decodes it. Runs on the
+  // UI thread.
+  void DecodeCached(ImageDescriptor descriptor, DecodedImageCache::Key key,
+                    fml::tracing::TraceFlow flow, const ImageResult& result);
+
+  using TracedDecodeFunction =
+      std::function<sk_sp<SkImage>(const fml::tracing::TraceFlow&)>;
+
+  void DecodeOnWorker(TracedDecodeFunction decode, bool reuses_pixels,
+                      fml::tracing::TraceFlow flow, const ImageResult& result);
+
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
-sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
-                                       std::optional<uint32_t> target_width,
-                                       std::optional<uint32_t> target_height,
-                                       const fml::tracing::TraceFlow& flow);
+// Large images that are resized down are decoded in bands of rows straight
+// into the resized image. If |task_runner| is set, the bands of JPEG images
+// are decoded in parallel on it.
+sk_sp<SkImage> ImageFromCompressedData(
+    sk_sp<SkData> data,
+    std::optional<uint32_t> target_width,
+    std::optional<uint32_t> target_height,
+    const fml::tracing::TraceFlow& flow,
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner = nullptr);
 
 }  // namespace uiwidgets
@@ -1,21 +1,61 @@
 #include "image_encoding.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "flutter/fml/build_config.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/trace_event.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkEncodedImageFormat.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
+#include "include/encode/SkJpegEncoder.h"
+#include "include/encode/SkWebpEncoder.h"
 #include "lib/ui/painting/image.h"
+#include "lib/ui/painting/image_decoder.h"
 #include "lib/ui/ui_mono_state.h"
+#include "third_party/zlib/zlib.h"
 
 namespace uiwidgets {
 namespace {
 
+// This must be kept in sync with the enum in painting.cs
+enum ImageByteFormat {
+  kRawRGBA,
+  kRawUnmodified,
+  kPNG,
+  kJPEG,
+  kWEBP,
+};
+
+// The size of the chunks encoded bytes are delivered in.
+constexpr size_t kEncodeChunkSize = 256 * 1024;
+
+// The most chunks posted to the UI thread and not yet delivered. The encoder
+// waits for the UI thread beyond that, so that a slow consumer does not make
+// the undelivered chunks add up to the whole encoded image.
+constexpr size_t kMaxChunksInFlight = 4;
+
+// PNG images are compressed in bands of at least this many bytes of filtered
+// rows. Each band starts without the history of the ones before, which costs
+// little at this size.
+constexpr size_t kMinPngBandBytes = 512 * 1024;
+constexpr int kMinPngBandRows = 16;
+
+constexpr int kPngCompressionLevel = 6;
+
 void InvokeDataCallback(std::unique_ptr<EncodeImageCallback> callback,
                         sk_sp<SkData> buffer) {
   std::shared_ptr<MonoState> mono_state = callback->mono_state.lock();
@@ -32,11 +72,144 @@ void InvokeDataCallback(std::unique_ptr<EncodeImageCallback> callback,
   }
 }
 
-// This must be kept in sync with the enum in painting.dart
-enum ImageByteFormat {
-  kRawRGBA,
-  kRawUnmodified,
-  kPNG,
+void InvokeChunkCallback(const EncodeImageChunkCallback& callback,
+                         sk_sp<SkData> chunk, bool is_last) {
+  std::shared_ptr<MonoState> mono_state = callback.mono_state.lock();
+  if (!mono_state) {
+    // Only the last chunk is delivered, so that the handle can be freed.
+    if (is_last) {
+      callback.callback(callback.callback_handle, nullptr, 0, true);
+    }
+    return;
+  }
+  MonoState::Scope scope(mono_state);
+  if (!chunk) {
+    callback.callback(callback.callback_handle, nullptr, 0, is_last);
+  } else {
+    callback.callback(callback.callback_handle, chunk->bytes(), chunk->size(),
+                      is_last);
+  }
+}
+
+// Posts the chunks of one encode to the UI thread, at most
+// kMaxChunksInFlight at a time.
+class ChunkDelivery {
+ public:
+  ChunkDelivery(std::shared_ptr<EncodeImageChunkCallback> callback,
+                fml::RefPtr<fml::TaskRunner> ui_task_runner)
+      : callback_(std::move(callback)),
+        ui_task_runner_(std::move(ui_task_runner)) {}
+
+  // Waits until fewer than kMaxChunksInFlight chunks are in flight and posts
+  // |chunk|. Returns false without posting if the mono state is gone, as the
+  // chunks in flight may then never be delivered.
+  bool Post(const std::shared_ptr<ChunkDelivery>& self, sk_sp<SkData> chunk) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (in_flight_ >= kMaxChunksInFlight) {
+        if (callback_->mono_state.expired()) {
+          return false;
+        }
+        delivered_condition_.wait_for(lock, std::chrono::milliseconds(100));
+      }
+      in_flight_++;
+    }
+    ui_task_runner_->PostTask([self, chunk = std::move(chunk)]() {
+      InvokeChunkCallback(*self->callback_, chunk, false);
+      {
+        std::scoped_lock lock(self->mutex_);
+        self->in_flight_--;
+      }
+      self->delivered_condition_.notify_all();
+    });
+    return true;
+  }
+
+  // Posts the last chunk, which is never held back so that the callback
+  // handle is always freed.
+  void PostLast(sk_sp<SkData> chunk) {
+    ui_task_runner_->PostTask(
+        [callback = callback_, chunk = std::move(chunk)]() {
+          InvokeChunkCallback(*callback, chunk, true);
+        });
+  }
+
+ private:
+  const std::shared_ptr<EncodeImageChunkCallback> callback_;
+  const fml::RefPtr<fml::TaskRunner> ui_task_runner_;
+  std::mutex mutex_;
+  std::condition_variable delivered_condition_;
+  size_t in_flight_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ChunkDelivery);
+};
+
+// Hands what is written to it to |sink| in chunks of kEncodeChunkSize bytes,
+// so that the encoded image is never collected in one buffer. The last chunk
+// is held back until Finish, which returns it. Writes fail once |sink| has
+// returned false.
+class ChunkedWStream : public SkWStream {
+ public:
+  explicit ChunkedWStream(std::function<bool(sk_sp<SkData>)> sink)
+      : sink_(std::move(sink)) {}
+
+  bool write(const void* buffer, size_t size) override {
+    if (failed_) {
+      return false;
+    }
+    auto* bytes = static_cast<const uint8_t*>(buffer);
+    bytes_written_ += size;
+    while (size > 0) {
+      if (!chunk_) {
+        chunk_ = SkData::MakeUninitialized(kEncodeChunkSize);
+        chunk_size_ = 0;
+      }
+      const size_t length = std::min(size, kEncodeChunkSize - chunk_size_);
+      ::memcpy(static_cast<uint8_t*>(chunk_->writable_data()) + chunk_size_,
+               bytes, length);
+      chunk_size_ += length;
+      bytes += length;
+      size -= length;
+
+      if (chunk_size_ == kEncodeChunkSize) {
+        if (full_chunk_ && !sink_(std::move(full_chunk_))) {
+          failed_ = true;
+          return false;
+        }
+        full_chunk_ = std::move(chunk_);
+      }
+    }
+    return true;
+  }
+
+  size_t bytesWritten() const override { return bytes_written_; }
+
+  // Returns the last chunk, or null if nothing was written or a write
+  // failed.
+  sk_sp<SkData> Finish() {
+    if (failed_) {
+      return nullptr;
+    }
+    if (!chunk_) {
+      return std::move(full_chunk_);
+    }
+    if (full_chunk_ && !sink_(std::move(full_chunk_))) {
+      failed_ = true;
+      return nullptr;
+    }
+    sk_sp<SkData> chunk = std::move(chunk_);
+    return SkData::MakeSubset(chunk.get(), 0, chunk_size_);
+  }
+
+ private:
+  std::function<bool(sk_sp<SkData>)> sink_;
+  bool failed_ = false;
+  sk_sp<SkData> chunk_;
+  size_t chunk_size_ = 0;
+  sk_sp<SkData> full_chunk_;
+  size_t bytes_written_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ChunkedWStream);
 };
 
 sk_sp<SkImage> ConvertToRasterUsingResourceContext(
@@ -162,90 +335,558 @@ sk_sp<SkData> CopyImageByteData(sk_sp<SkImage> raster_image,
   return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
 }
 
-sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
+// Writes the pixels of |pixmap| to |stream| as |color_type|, converting them
+// a strip of rows at a time.
+bool WriteImageBytes(const SkPixmap& pixmap, SkColorType color_type,
+                     SkWStream* stream) {
+  const SkImageInfo row_info = SkImageInfo::Make(
+      pixmap.width(), 1, color_type, kPremul_SkAlphaType, nullptr);
+  const size_t row_bytes = row_info.minRowBytes();
+
+  if (pixmap.colorType() == color_type) {
+    for (int y = 0; y < pixmap.height(); y++) {
+      if (!stream->write(pixmap.addr(0, y), row_bytes)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const int strip_rows =
+      static_cast<int>(std::max<size_t>(1, kEncodeChunkSize / row_bytes));
+  std::vector<uint8_t> strip(row_bytes * strip_rows);
+  for (int top = 0; top < pixmap.height(); top += strip_rows) {
+    const int rows = std::min(strip_rows, pixmap.height() - top);
+    if (!pixmap.readPixels(row_info.makeWH(pixmap.width(), rows),
+                           strip.data(), row_bytes, 0, top)) {
+      FML_LOG(ERROR) << "Could not convert the pixels of the raster image.";
+      return false;
+    }
+    if (!stream->write(strip.data(), row_bytes * rows)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int PaethPredictor(int a, int b, int c) {
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+  return pb <= pc ? b : c;
+}
+
+// Writes the filter type and the filtered |row| to |out|, picking the filter
+// that minimizes the sum of the absolute values of the filtered bytes like
+// libpng does. |prior| is the row above, or null for the first row.
+void FilterPngRow(const uint8_t* row, const uint8_t* prior, size_t length,
+                  size_t bytes_per_pixel, uint8_t* out, uint8_t* scratch) {
+  uint8_t* best = out;
+  uint8_t* candidate = scratch;
+  uint64_t best_sum = UINT64_MAX;
+  for (uint8_t filter = 0; filter < 5; filter++) {
+    candidate[0] = filter;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < length; i++) {
+      const int a = i >= bytes_per_pixel ? row[i - bytes_per_pixel] : 0;
+      const int b = prior ? prior[i] : 0;
+      const int c =
+          prior && i >= bytes_per_pixel ? prior[i - bytes_per_pixel] : 0;
+      int predictor = 0;
+      switch (filter) {
+        case 1:
+          predictor = a;
+          break;
+        case 2:
+          predictor = b;
+          break;
+        case 3:
+          predictor = (a + b) / 2;
+          break;
+        case 4:
+          predictor = PaethPredictor(a, b, c);
+          break;
+      }
+      const auto value = static_cast<uint8_t>(row[i] - predictor);
+      candidate[i + 1] = value;
+      sum += std::abs(static_cast<int8_t>(value));
+    }
+    if (sum < best_sum) {
+      best_sum = sum;
+      std::swap(best, candidate);
+    }
+  }
+  if (best != out) {
+    ::memcpy(out, best, length + 1);
+  }
+}
+
+void WritePngChunk(SkWStream* stream, const char* type, const uint8_t* data,
+                   size_t length) {
+  uint8_t header[8] = {
+      static_cast<uint8_t>(length >> 24), static_cast<uint8_t>(length >> 16),
+      static_cast<uint8_t>(length >> 8),  static_cast<uint8_t>(length),
+      static_cast<uint8_t>(type[0]),      static_cast<uint8_t>(type[1]),
+      static_cast<uint8_t>(type[2]),      static_cast<uint8_t>(type[3]),
+  };
+  uLong crc = crc32(0L, header + 4, 4);
+  crc = crc32(crc, data, static_cast<uInt>(length));
+  const uint8_t trailer[4] = {
+      static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16),
+      static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc)};
+
+  stream->write(header, sizeof(header));
+  stream->write(data, length);
+  stream->write(trailer, sizeof(trailer));
+}
+
+// Encodes a PNG image in bands of rows that are filtered and deflated on
+// several workers at once, the way pigz does. All bands but the last end with
+// a sync flush, so that their deflate streams can be concatenated, and the
+// checksums of the bands are combined in order.
+struct BandedPngEncode {
+  struct Band {
+    bool done = false;
+    bool failed = false;
+    std::vector<uint8_t> deflated;
+    uLong adler = 0;
+    size_t filtered_size = 0;
+  };
+
+  // Keeps the pixels alive for the helpers.
+  const sk_sp<SkImage> image;
+  const SkPixmap source;
+  const bool opaque;
+  const size_t bytes_per_pixel;
+  const size_t row_length;
+  const int band_rows;
+
+  std::atomic<size_t> next_band{0};
+  std::atomic<bool> cancelled{false};
+  std::mutex mutex;
+  std::condition_variable done_condition;
+  std::vector<Band> bands;
+
+  BandedPngEncode(sk_sp<SkImage> image, const SkPixmap& source)
+      : image(std::move(image)),
+        source(source),
+        opaque(source.isOpaque()),
+        bytes_per_pixel(opaque ? 3 : 4),
+        row_length(source.width() * bytes_per_pixel),
+        band_rows(std::max(kMinPngBandRows,
+                           static_cast<int>(kMinPngBandBytes /
+                                            (row_length + 1)))),
+        bands((source.height() + band_rows - 1) / band_rows) {}
+
+  // Encodes the next band nobody has claimed yet. Returns false once all
+  // bands are claimed.
+  bool EncodeNextBand() {
+    const size_t index = next_band++;
+    if (index >= bands.size() || cancelled) {
+      return false;
+    }
+
+    Band band;
+    band.failed = !EncodeBand(index, &band);
+    {
+      std::scoped_lock lock(mutex);
+      bands[index] = std::move(band);
+      bands[index].done = true;
+    }
+    done_condition.notify_all();
+    return true;
+  }
+
+  void Run() {
+    while (EncodeNextBand()) {
+    }
+  }
+
+ private:
+  bool EncodeBand(size_t index, Band* band) {
+    TRACE_EVENT0("uiwidgets", "BandedPngEncode::EncodeBand");
+    const int top = static_cast<int>(index) * band_rows;
+    const int bottom = std::min(top + band_rows, source.height());
+    // The row above the band is needed to filter its first row.
+    const int first = top > 0 ? top - 1 : top;
+
+    // PNG stores unpremultiplied pixels.
+    const SkImageInfo rgba_info = SkImageInfo::Make(
+        source.width(), bottom - first, kRGBA_8888_SkColorType,
+        kUnpremul_SkAlphaType, SkColorSpace::MakeSRGB());
+    const size_t rgba_row_bytes = rgba_info.minRowBytes();
+    std::vector<uint8_t> rows(rgba_info.computeMinByteSize());
+    if (!source.readPixels(rgba_info, rows.data(), rgba_row_bytes, 0, first)) {
+      FML_LOG(ERROR) << "Could not convert the pixels of the raster image.";
+      return false;
+    }
+    if (opaque) {
+      for (int y = 0; y < bottom - first; y++) {
+        uint8_t* row = rows.data() + y * rgba_row_bytes;
+        for (int x = 0; x < source.width(); x++) {
+          row[x * 3] = row[x * 4];
+          row[x * 3 + 1] = row[x * 4 + 1];
+          row[x * 3 + 2] = row[x * 4 + 2];
+        }
+      }
+    }
+
+    band->filtered_size = (bottom - top) * (row_length + 1);
+    std::vector<uint8_t> filtered(band->filtered_size);
+    std::vector<uint8_t> scratch(row_length + 1);
+    for (int y = top; y < bottom; y++) {
+      const uint8_t* row = rows.data() + (y - first) * rgba_row_bytes;
+      FilterPngRow(row, y > first ? row - rgba_row_bytes : nullptr,
+                   row_length, bytes_per_pixel,
+                   filtered.data() + (y - top) * (row_length + 1),
+                   scratch.data());
+    }
+    band->adler = adler32(adler32(0L, Z_NULL, 0), filtered.data(),
+                          static_cast<uInt>(filtered.size()));
+
+    z_stream stream = {};
+    if (deflateInit2(&stream, kPngCompressionLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      FML_LOG(ERROR) << "Could not initialize the PNG compressor.";
+      return false;
+    }
+
+    // The first band starts with the zlib header.
+    size_t offset = 0;
+    band->deflated.resize(
+        deflateBound(&stream, static_cast<uLong>(filtered.size())) + 16);
+    if (index == 0) {
+      band->deflated[offset++] = 0x78;
+      band->deflated[offset++] = 0x9c;
+    }
+
+    const bool is_last = index + 1 == bands.size();
+    stream.next_in = filtered.data();
+    stream.avail_in = static_cast<uInt>(filtered.size());
+    bool succeeded = false;
+    while (true) {
+      stream.next_out = band->deflated.data() + offset;
+      stream.avail_out = static_cast<uInt>(band->deflated.size() - offset);
+      const int result = deflate(&stream, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+      offset = band->deflated.size() - stream.avail_out;
+      if (result == Z_STREAM_ERROR) {
+        break;
+      }
+      if (is_last ? result == Z_STREAM_END : stream.avail_out != 0) {
+        succeeded = true;
+        break;
+      }
+      band->deflated.resize(band->deflated.size() * 2);
+    }
+    deflateEnd(&stream);
+    band->deflated.resize(offset);
+
+    if (!succeeded) {
+      FML_LOG(ERROR) << "Could not compress the PNG image.";
+    }
+    return succeeded;
+  }
+};
+
+bool EncodePngInBands(
+    sk_sp<SkImage> raster_image,
+    const SkPixmap& pixmap,
+    SkWStream* stream,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner) {
   TRACE_EVENT0("uiwidgets", __FUNCTION__);
 
-  if (!raster_image) {
-    return nullptr;
+  auto banded =
+      std::make_shared<BandedPngEncode>(std::move(raster_image), pixmap);
+  const size_t band_count = banded->bands.size();
+
+  if (task_runner) {
+    const size_t helper_count = std::min<size_t>(
+        band_count - 1, std::max(1u, std::thread::hardware_concurrency()) - 1);
+    for (size_t i = 0; i < helper_count; i++) {
+      task_runner->PostTask([banded]() { banded->Run(); });
+    }
+  }
+
+  static const uint8_t kSignature[] = {0x89, 'P',  'N',  'G',
+                                       '\r', '\n', 0x1a, '\n'};
+  stream->write(kSignature, sizeof(kSignature));
+
+  const auto width = static_cast<uint32_t>(pixmap.width());
+  const auto height = static_cast<uint32_t>(pixmap.height());
+  const uint8_t header[13] = {
+      static_cast<uint8_t>(width >> 24),
+      static_cast<uint8_t>(width >> 16),
+      static_cast<uint8_t>(width >> 8),
+      static_cast<uint8_t>(width),
+      static_cast<uint8_t>(height >> 24),
+      static_cast<uint8_t>(height >> 16),
+      static_cast<uint8_t>(height >> 8),
+      static_cast<uint8_t>(height),
+      8,                                           // Bit depth.
+      static_cast<uint8_t>(banded->opaque ? 2 : 6),  // RGB or RGBA.
+      0,                                           // Deflate.
+      0,                                           // Adaptive filtering.
+      0,                                           // Not interlaced.
+  };
+  WritePngChunk(stream, "IHDR", header, sizeof(header));
+
+  const uint8_t rendering_intent = 0;  // Perceptual.
+  WritePngChunk(stream, "sRGB", &rendering_intent, 1);
+
+  // The bands are written in order as they complete. Until the next one is
+  // done, this thread encodes bands as well.
+  uLong adler = adler32(0L, Z_NULL, 0);
+  for (size_t i = 0; i < band_count; i++) {
+    BandedPngEncode::Band band;
+    {
+      std::unique_lock<std::mutex> lock(banded->mutex);
+      while (!banded->bands[i].done) {
+        lock.unlock();
+        const bool encoded = banded->EncodeNextBand();
+        lock.lock();
+        if (!encoded) {
+          banded->done_condition.wait(
+              lock, [&banded, i]() { return banded->bands[i].done; });
+        }
+      }
+      band = std::move(banded->bands[i]);
+    }
+
+    if (band.failed) {
+      banded->cancelled = true;
+      return false;
+    }
+
+    adler = adler32_combine(adler, band.adler,
+                            static_cast<z_off_t>(band.filtered_size));
+    if (i + 1 == band_count) {
+      band.deflated.push_back(static_cast<uint8_t>(adler >> 24));
+      band.deflated.push_back(static_cast<uint8_t>(adler >> 16));
+      band.deflated.push_back(static_cast<uint8_t>(adler >> 8));
+      band.deflated.push_back(static_cast<uint8_t>(adler));
+    }
+    WritePngChunk(stream, "IDAT", band.deflated.data(), band.deflated.size());
+  }
+
+  WritePngChunk(stream, "IEND", nullptr, 0);
+  return true;
+}
+
+bool EncodeImageToStream(
+    sk_sp<SkImage> raster_image,
+    ImageByteFormat format,
+    int quality,
+    SkWStream* stream,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner) {
+  SkPixmap pixmap;
+  if (!raster_image->peekPixels(&pixmap)) {
+    FML_LOG(ERROR) << "Could not read the pixels of the raster image.";
+    return false;
   }
 
   switch (format) {
     case kPNG: {
-      auto png_image =
-          raster_image->encodeToData(SkEncodedImageFormat::kPNG, 0);
-
-      if (png_image == nullptr) {
-        FML_LOG(ERROR) << "Could not convert raster image to PNG.";
-        return nullptr;
+      return EncodePngInBands(std::move(raster_image), pixmap, stream,
+                              task_runner);
+    } break;
+    case kJPEG: {
+      SkJpegEncoder::Options options;
+      options.fQuality = quality;
+      if (!SkJpegEncoder::Encode(stream, pixmap, options)) {
+        FML_LOG(ERROR) << "Could not convert raster image to JPEG.";
+        return false;
+      }
+      return true;
+    } break;
+    case kWEBP: {
+      SkWebpEncoder::Options options;
+      options.fQuality = quality;
+      if (!SkWebpEncoder::Encode(stream, pixmap, options)) {
+        FML_LOG(ERROR) << "Could not convert raster image to WebP.";
+        return false;
       }
-      return png_image;
+      return true;
+    } break;
+    case kRawRGBA: {
+      return WriteImageBytes(pixmap, kRGBA_8888_SkColorType, stream);
+    } break;
+    case kRawUnmodified: {
+      return WriteImageBytes(pixmap, pixmap.colorType(), stream);
     } break;
+  }
+
+  FML_LOG(ERROR) << "Unknown error encoding image.";
+  return false;
+}
+
+sk_sp<SkData> EncodeImage(
+    sk_sp<SkImage> raster_image,
+    ImageByteFormat format,
+    int quality,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner) {
+  TRACE_EVENT0("uiwidgets", __FUNCTION__);
+
+  if (!raster_image) {
+    return nullptr;
+  }
+
+  switch (format) {
     case kRawRGBA: {
       return CopyImageByteData(raster_image, kRGBA_8888_SkColorType);
     } break;
     case kRawUnmodified: {
       return CopyImageByteData(raster_image, raster_image->colorType());
     } break;
+    default:
+      break;
   }
 
-  FML_LOG(ERROR) << "Unknown error encoding image.";
+  SkDynamicMemoryWStream stream;
+  if (!EncodeImageToStream(std::move(raster_image), format, quality, &stream,
+                           task_runner)) {
+    return nullptr;
+  }
+  return stream.detachAsData();
+}
+
+// Converts |image| to a raster image on the IO thread and runs |encode_task|
+// with it on a worker. Encoding a large image takes long enough to hold up
+// the decodes queued on the IO thread.
+void ScheduleEncode(
+    sk_sp<SkImage> image,
+    std::function<void(sk_sp<SkImage>)> encode_task,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner) {
+  auto* mono_state = UIMonoState::Current();
+  const auto& task_runners = mono_state->GetTaskRunners();
+
+  auto worker_task = [encode_task = std::move(encode_task),
+                      concurrent_task_runner =
+                          std::move(concurrent_task_runner)](
+                         sk_sp<SkImage> raster_image) {
+    if (!concurrent_task_runner) {
+      encode_task(std::move(raster_image));
+      return;
+    }
+    concurrent_task_runner->PostTask(
+        [encode_task, raster_image = std::move(raster_image)]() {
+          encode_task(raster_image);
+        });
+  };
+
+  task_runners.GetIOTaskRunner()->PostTask(
+      [image = std::move(image), worker_task = std::move(worker_task),
+       raster_task_runner = task_runners.GetRasterTaskRunner(),
+       io_task_runner = task_runners.GetIOTaskRunner(),
+       io_manager = mono_state->GetIOManager(),
+       snapshot_delegate = mono_state->GetSnapshotDelegate()]() {
+        ConvertImageToRaster(image, worker_task, raster_task_runner,
+                             io_task_runner,
+                             io_manager->GetResourceContext().get(),
+                             snapshot_delegate);
+      });
+}
+
+std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentTaskRunner() {
+  if (auto decoder = UIMonoState::Current()->GetImageDecoder()) {
+    return decoder->GetConcurrentTaskRunner();
+  }
+  return nullptr;
+}
+
+const char* ValidateEncodeArguments(CanvasImage* canvas_image, int format,
+                                    bool has_callback) {
+  if (!canvas_image) return "encode called with non-genuine Image.";
+
+  if (!has_callback) return "Callback must be a function.";
+
+  if (format < kRawRGBA || format > kWEBP) return "Unknown image byte format.";
+
   return nullptr;
 }
 
-void EncodeImageAndInvokeDataCallback(
-    sk_sp<SkImage> image, std::unique_ptr<EncodeImageCallback> callback,
-    ImageByteFormat format, fml::RefPtr<fml::TaskRunner> ui_task_runner,
-    fml::RefPtr<fml::TaskRunner> raster_task_runner,
-    fml::RefPtr<fml::TaskRunner> io_task_runner, GrContext* resource_context,
-    fml::WeakPtr<SnapshotDelegate> snapshot_delegate) {
+}  // namespace
+
+const char* EncodeImage(CanvasImage* canvas_image, int format, int quality,
+                        RawEncodeImageCallback raw_callback,
+                        Mono_Handle callback_handle) {
+  if (const char* error = ValidateEncodeArguments(
+          canvas_image, format, raw_callback && callback_handle)) {
+    return error;
+  }
+
+  ImageByteFormat image_format = static_cast<ImageByteFormat>(format);
+  quality = std::clamp(quality, 0, 100);
+
   auto callback_task = fml::MakeCopyable(
-      [callback = std::move(callback)](sk_sp<SkData> encoded) mutable {
+      [callback = std::make_unique<EncodeImageCallback>(EncodeImageCallback{
+           MonoState::Current()->GetWeakPtr(), raw_callback,
+           callback_handle})](sk_sp<SkData> encoded) mutable {
         InvokeDataCallback(std::move(callback), std::move(encoded));
       });
 
-  auto encode_task = [callback_task = std::move(callback_task), format,
-                      ui_task_runner](sk_sp<SkImage> raster_image) mutable {
-    sk_sp<SkData> encoded = EncodeImage(std::move(raster_image), format);
+  auto concurrent_task_runner = GetConcurrentTaskRunner();
+  auto encode_task = [callback_task = std::move(callback_task), image_format,
+                      quality, concurrent_task_runner,
+                      ui_task_runner = UIMonoState::Current()
+                                           ->GetTaskRunners()
+                                           .GetUITaskRunner()](
+                         sk_sp<SkImage> raster_image) mutable {
+    sk_sp<SkData> encoded = EncodeImage(std::move(raster_image), image_format,
+                                        quality, concurrent_task_runner);
     ui_task_runner->PostTask(
         [callback_task = std::move(callback_task),
          encoded = std::move(encoded)] { callback_task(encoded); });
   };
 
-  ConvertImageToRaster(std::move(image), encode_task, raster_task_runner,
-                       io_task_runner, resource_context, snapshot_delegate);
+  ScheduleEncode(canvas_image->image(), std::move(encode_task),
+                 std::move(concurrent_task_runner));
+  return nullptr;
 }
 
-}  // namespace
-
-const char* EncodeImage(CanvasImage* canvas_image, int format,
-                        RawEncodeImageCallback raw_callback,
-                        Mono_Handle callback_handle) {
-  if (!canvas_image) return "encode called with non-genuine Image.";
-
-  if (!raw_callback || !callback_handle) return "Callback must be a function.";
+const char* EncodeImageInChunks(CanvasImage* canvas_image, int format,
+                                int quality,
+                                RawEncodeImageChunkCallback raw_callback,
+                                Mono_Handle callback_handle) {
+  if (const char* error = ValidateEncodeArguments(
+          canvas_image, format, raw_callback && callback_handle)) {
+    return error;
+  }
 
   ImageByteFormat image_format = static_cast<ImageByteFormat>(format);
+  quality = std::clamp(quality, 0, 100);
+
+  auto callback = std::make_shared<EncodeImageChunkCallback>(
+      EncodeImageChunkCallback{MonoState::Current()->GetWeakPtr(),
+                               raw_callback, callback_handle});
+
+  auto concurrent_task_runner = GetConcurrentTaskRunner();
+  auto encode_task = [callback, image_format, quality, concurrent_task_runner,
+                      ui_task_runner = UIMonoState::Current()
+                                           ->GetTaskRunners()
+                                           .GetUITaskRunner()](
+                         sk_sp<SkImage> raster_image) {
+    TRACE_EVENT0("uiwidgets", "EncodeImageInChunks");
+
+    auto delivery = std::make_shared<ChunkDelivery>(callback, ui_task_runner);
+    ChunkedWStream stream([&delivery](sk_sp<SkData> chunk) {
+      return delivery->Post(delivery, std::move(chunk));
+    });
 
-  auto callback = std::make_unique<EncodeImageCallback>(EncodeImageCallback{
-      MonoState::Current()->GetWeakPtr(), raw_callback, callback_handle});
-
-  const auto& task_runners = UIMonoState::Current()->GetTaskRunners();
-
-  task_runners.GetIOTaskRunner()->PostTask(fml::MakeCopyable(
-      [callback = std::move(callback), image = canvas_image->image(),
-       image_format, ui_task_runner = task_runners.GetUITaskRunner(),
-       raster_task_runner = task_runners.GetRasterTaskRunner(),
-       io_task_runner = task_runners.GetIOTaskRunner(),
-       io_manager = UIMonoState::Current()->GetIOManager(),
-       snapshot_delegate =
-           UIMonoState::Current()->GetSnapshotDelegate()]() mutable {
-        EncodeImageAndInvokeDataCallback(
-            std::move(image), std::move(callback), image_format,
-            std::move(ui_task_runner), std::move(raster_task_runner),
-            std::move(io_task_runner), io_manager->GetResourceContext().get(),
-            std::move(snapshot_delegate));
-      }));
+    sk_sp<SkData> last_chunk;
+    if (raster_image &&
+        EncodeImageToStream(std::move(raster_image), image_format, quality,
+                            &stream, concurrent_task_runner)) {
+      last_chunk = stream.Finish();
+    }
+    delivery->PostLast(std::move(last_chunk));
+  };
 
+  ScheduleEncode(canvas_image->image(), std::move(encode_task),
+                 std::move(concurrent_task_runner));
   return nullptr;
 }
 
@@ -16,7 +16,29 @@ struct EncodeImageCallback {
   Mono_Handle callback_handle;
 };
 
-const char* EncodeImage(CanvasImage* canvas_image, int format,
-                        RawEncodeImageCallback callback, Mono_Handle callback_handle);
+typedef void (*RawEncodeImageChunkCallback)(Mono_Handle callback_handle,
+                                            const uint8_t* data, size_t length,
+                                            bool is_last);
+
+struct EncodeImageChunkCallback {
+  std::weak_ptr<MonoState> mono_state;
+  RawEncodeImageChunkCallback callback;
+  Mono_Handle callback_handle;
+};
+
+// Encodes the image off the UI thread and invokes |callback| with the encoded
+// bytes. |quality| ranges from 0 to 100 and is used by JPEG and WebP.
+const char* EncodeImage(CanvasImage* canvas_image, int format, int quality,
+                        RawEncodeImageCallback callback,
+                        Mono_Handle callback_handle);
+
+// Like EncodeImage, but invokes |callback| with the encoded bytes in chunks as
+// they are produced, so that the whole encoded image is never held at once.
+// The last chunk has |is_last| set. A failed encode ends with an empty last
+// chunk.
+const char* EncodeImageInChunks(CanvasImage* canvas_image, int format,
+                                int quality,
+                                RawEncodeImageChunkCallback callback,
+                                Mono_Handle callback_handle);
 
 }  // namespace uiwidgets
@@ -1,21 +1,52 @@
 #include "multi_frame_codec.h"
 
+#include <algorithm>
+
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
 #include "include/core/SkPixelRef.h"
 #include "lib/ui/ui_mono_state.h"
+#include "pixel_buffer_pool.h"
 
 namespace uiwidgets {
 
-MultiFrameCodec::MultiFrameCodec(std::unique_ptr<SkCodec> codec)
-    : state_(new State(std::move(codec))) {}
+namespace {
+
+// The most frames decoded ahead of playback.
+constexpr size_t kMaxLookAheadFrames = 3;
+
+// The most bytes of frames decoded ahead of playback. Animations with larger
+// frames decode one frame ahead.
+constexpr size_t kMaxLookAheadBytes = 16 * 1024 * 1024;
+
+SkImageInfo GetFrameInfo(const SkCodec& codec) {
+  SkImageInfo info = codec.getInfo().makeColorType(kN32_SkColorType);
+  if (info.alphaType() == kUnpremul_SkAlphaType) {
+    info = info.makeAlphaType(kPremul_SkAlphaType);
+  }
+  return info;
+}
+
+}  // namespace
+
+MultiFrameCodec::MultiFrameCodec(std::unique_ptr<SkCodec> codec,
+                                 size_t cache_all_frames_max_bytes)
+    : state_(new State(std::move(codec), cache_all_frames_max_bytes)) {}
 
 MultiFrameCodec::~MultiFrameCodec() = default;
 
-MultiFrameCodec::State::State(std::unique_ptr<SkCodec> codec)
+MultiFrameCodec::State::State(std::unique_ptr<SkCodec> codec,
+                              size_t cache_all_frames_max_bytes)
     : codec_(std::move(codec)),
       frameCount_(codec_->getFrameCount()),
       repetitionCount_(codec_->getRepetitionCount()),
-      nextFrameIndex_(0) {}
+      info_(GetFrameInfo(*codec_)),
+      lookAheadCapacity_(std::clamp<size_t>(
+          kMaxLookAheadBytes / std::max<size_t>(1, info_.computeMinByteSize()),
+          1, kMaxLookAheadFrames)),
+      nextFrameIndex_(0),
+      cacheAllFrames_(info_.computeMinByteSize() * frameCount_ <=
+                      cache_all_frames_max_bytes) {}
 
 static void InvokeNextFrameCallback(
     fml::RefPtr<FrameInfo> frameInfo,
@@ -36,83 +67,161 @@ static void InvokeNextFrameCallback(
   }
 }
 
-// Copied the source bitmap to the destination. If this cannot occur due to
-// running out of memory or the image info not being compatible, returns false.
-static bool CopyToBitmap(SkBitmap* dst, SkColorType dstColorType,
-                         const SkBitmap& src) {
-  SkPixmap srcPM;
-  if (!src.peekPixels(&srcPM)) {
-    return false;
-  }
-
-  SkBitmap tmpDst;
-  SkImageInfo dstInfo = srcPM.info().makeColorType(dstColorType);
-  if (!tmpDst.setInfo(dstInfo)) {
-    return false;
-  }
-
-  if (!tmpDst.tryAllocPixels()) {
-    return false;
-  }
+MultiFrameCodec::State::DecodedFrame
+MultiFrameCodec::State::DecodeNextFrameLocked() {
+  TRACE_EVENT0("uiwidgets", "MultiFrameCodec::State::DecodeNextFrameLocked");
 
-  SkPixmap dstPM;
-  if (!tmpDst.peekPixels(&dstPM)) {
-    return false;
-  }
+  DecodedFrame frame;
+  frame.index = nextDecodeIndex_;
+  nextDecodeIndex_ = (nextDecodeIndex_ + 1) % frameCount_;
 
-  if (!srcPM.readPixels(dstPM)) {
-    return false;
+  SkBitmap bitmap;
+  {
+    std::scoped_lock lock(ringMutex_);
+    if (!freeBitmaps_.empty()) {
+      bitmap = std::move(freeBitmaps_.back());
+      freeBitmaps_.pop_back();
+    }
   }
-
-  dst->swap(tmpDst);
-  return true;
-}
-
-sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
-    fml::WeakPtr<GrContext> resourceContext) {
-  SkBitmap bitmap = SkBitmap();
-  SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
-  if (info.alphaType() == kUnpremul_SkAlphaType) {
-    info = info.makeAlphaType(kPremul_SkAlphaType);
+  if (bitmap.isNull() &&
+      !PixelBufferPool::GetInstance().TryAllocPixels(&bitmap, info_)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for frame " << frame.index;
+    return frame;
   }
-  bitmap.allocPixels(info);
 
   SkCodec::Options options;
-  options.fFrameIndex = nextFrameIndex_;
+  options.fFrameIndex = frame.index;
   SkCodec::FrameInfo frameInfo;
-  codec_->getFrameInfo(nextFrameIndex_, &frameInfo);
+  codec_->getFrameInfo(frame.index, &frameInfo);
+  frame.durationMillis = frameInfo.fDuration;
   const int requiredFrameIndex = frameInfo.fRequiredFrame;
   if (requiredFrameIndex != SkCodec::kNoFrame) {
     if (lastRequiredFrame_ == nullptr) {
-      FML_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
+      FML_LOG(ERROR) << "Frame " << frame.index << " depends on frame "
                      << requiredFrameIndex
                      << " and no required frames are cached.";
-      return nullptr;
+      return frame;
     } else if (lastRequiredFrameIndex_ != requiredFrameIndex) {
       FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
                      << " is not cached. Using " << lastRequiredFrameIndex_
                      << " instead";
     }
 
+    // Both bitmaps have the same layout, so this copies the rows as they are.
     if (lastRequiredFrame_->getPixels() &&
-        CopyToBitmap(&bitmap, lastRequiredFrame_->colorType(),
-                     *lastRequiredFrame_)) {
+        lastRequiredFrame_->readPixels(bitmap.pixmap())) {
       options.fPriorFrame = requiredFrameIndex;
     }
   }
 
-  if (SkCodec::kSuccess != codec_->getPixels(info, bitmap.getPixels(),
+  if (SkCodec::kSuccess != codec_->getPixels(info_, bitmap.getPixels(),
                                              bitmap.rowBytes(), &options)) {
-    FML_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
-    return nullptr;
+    FML_LOG(ERROR) << "Could not getPixels for frame " << frame.index;
+    return frame;
   }
 
-  // Hold onto this if we need it to decode future frames.
+  // Hold onto this if we need it to decode future frames. It shares the
+  // pixels, which keeps them from being reused for other frames.
   if (frameInfo.fDisposalMethod == SkCodecAnimation::DisposalMethod::kKeep) {
     lastRequiredFrame_ = std::make_unique<SkBitmap>(bitmap);
-    lastRequiredFrameIndex_ = nextFrameIndex_;
+    lastRequiredFrameIndex_ = frame.index;
   }
 
+  frame.bitmap = std::move(bitmap);
+  return frame;
+}
+
+MultiFrameCodec::State::DecodedFrame MultiFrameCodec::State::TakeFrame(
+    int index) {
+  auto take_from_ring = [this, index](DecodedFrame* frame) {
+    std::scoped_lock lock(ringMutex_);
+    if (ring_.empty()) {
+      return false;
+    }
+    FML_DCHECK(ring_.front().index == index);
+    *frame = std::move(ring_.front());
+    ring_.pop_front();
+    return true;
+  };
+
+  DecodedFrame frame;
+  if (take_from_ring(&frame)) {
+    return frame;
+  }
+
+  // A worker may be decoding the frame right now.
+  std::scoped_lock lock(decodeMutex_);
+  if (take_from_ring(&frame)) {
+    return frame;
+  }
+  FML_DCHECK(nextDecodeIndex_ == index);
+  return DecodeNextFrameLocked();
+}
+
+void MultiFrameCodec::State::RecycleBitmap(SkBitmap bitmap) {
+  // Frames kept to decode later frames still use their pixels.
+  if (bitmap.isNull() || !bitmap.pixelRef()->unique()) {
+    return;
+  }
+  std::scoped_lock lock(ringMutex_);
+  if (freeBitmaps_.size() < lookAheadCapacity_) {
+    freeBitmaps_.push_back(std::move(bitmap));
+  }
+}
+
+void MultiFrameCodec::State::FillRing(std::weak_ptr<State> weak_state) {
+  TRACE_EVENT0("uiwidgets", "MultiFrameCodec::State::FillRing");
+  auto state = weak_state.lock();
+  if (!state) {
+    return;
+  }
+
+  while (true) {
+    std::scoped_lock decode_lock(state->decodeMutex_);
+    {
+      std::scoped_lock ring_lock(state->ringMutex_);
+      if (state->allFramesCached_ ||
+          state->ring_.size() >= state->lookAheadCapacity_) {
+        state->lookAheadScheduled_ = false;
+        return;
+      }
+    }
+    // The frame is added while still holding |decodeMutex_|, so the IO task
+    // runner sees either the frame or the index after it.
+    DecodedFrame frame = state->DecodeNextFrameLocked();
+    std::scoped_lock ring_lock(state->ringMutex_);
+    state->ring_.push_back(std::move(frame));
+  }
+}
+
+void MultiFrameCodec::State::ScheduleLookAhead(
+    const std::shared_ptr<State>& self,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner) {
+  if (!task_runner) {
+    return;
+  }
+  {
+    std::scoped_lock lock(ringMutex_);
+    if (lookAheadScheduled_ || allFramesCached_ ||
+        ring_.size() >= lookAheadCapacity_) {
+      return;
+    }
+    lookAheadScheduled_ = true;
+  }
+  task_runner->PostTask([weak_state = std::weak_ptr<State>(self)]() {
+    FillRing(std::move(weak_state));
+  });
+}
+
+sk_sp<SkImage> MultiFrameCodec::State::UploadFrame(
+    const DecodedFrame& frame,
+    fml::WeakPtr<GrContext> resourceContext) {
+  const SkBitmap& bitmap = frame.bitmap;
+  if (bitmap.isNull()) {
+    return nullptr;
+  }
+
+  // Both copy the pixels, so the bitmap can be reused afterwards.
   if (resourceContext) {
     SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
                     bitmap.pixelRef()->rowBytes());
@@ -127,21 +236,59 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
 }
 
 void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
+    std::shared_ptr<State> self,
     std::unique_ptr<PendingCallback> callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
     fml::WeakPtr<GrContext> resourceContext,
     fml::RefPtr<SkiaUnrefQueue> unref_queue, size_t trace_id) {
+  const int frameIndex = nextFrameIndex_;
+  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+
+  sk_sp<SkImage> skImage;
+  int durationMillis = 0;
+  const size_t frameCount = frameCount_;
+  if (cacheAllFrames_ && cachedFrames_.size() == frameCount) {
+    skImage = cachedFrames_[frameIndex].get();
+    durationMillis = cachedDurations_[frameIndex];
+  } else {
+    DecodedFrame frame = TakeFrame(frameIndex);
+    skImage = UploadFrame(frame, resourceContext);
+    durationMillis = frame.durationMillis;
+    RecycleBitmap(std::move(frame.bitmap));
+
+    if (cacheAllFrames_) {
+      if (skImage && cachedFrames_.size() == static_cast<size_t>(frameIndex)) {
+        cachedFrames_.emplace_back(skImage, unref_queue);
+        cachedDurations_.push_back(durationMillis);
+      } else {
+        // Only a complete first loop is kept.
+        cacheAllFrames_ = false;
+        cachedFrames_.clear();
+        cachedDurations_.clear();
+      }
+    }
+
+    if (cacheAllFrames_ && cachedFrames_.size() == frameCount) {
+      // Every frame is kept from now on, so nothing is decoded anymore.
+      std::scoped_lock lock(decodeMutex_);
+      lastRequiredFrame_.reset();
+      std::scoped_lock ring_lock(ringMutex_);
+      allFramesCached_ = true;
+      ring_.clear();
+      freeBitmaps_.clear();
+    } else {
+      ScheduleLookAhead(self, concurrent_task_runner);
+    }
+  }
+
   fml::RefPtr<FrameInfo> frameInfo = NULL;
-  sk_sp<SkImage> skImage = GetNextFrameImage(resourceContext);
   if (skImage) {
     fml::RefPtr<CanvasImage> image = CanvasImage::Create();
     image->set_image({skImage, std::move(unref_queue)});
-    SkCodec::FrameInfo skFrameInfo;
-    codec_->getFrameInfo(nextFrameIndex_, &skFrameInfo);
     frameInfo =
-        fml::MakeRefCounted<FrameInfo>(std::move(image), skFrameInfo.fDuration);
+        fml::MakeRefCounted<FrameInfo>(std::move(image), durationMillis);
   }
-  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
 
   ui_task_runner->PostTask(fml::MakeCopyable(
       [callback = std::move(callback), frameInfo, trace_id]() mutable {
@@ -162,11 +309,17 @@ const char* MultiFrameCodec::getNextFrame(GetNextFrameCallback callback,
 
   const auto& task_runners = mono_state->GetTaskRunners();
 
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner;
+  if (auto decoder = mono_state->GetImageDecoder()) {
+    concurrent_task_runner = decoder->GetConcurrentTaskRunner();
+  }
+
   task_runners.GetIOTaskRunner()->PostTask(fml::MakeCopyable(
       [callback = std::make_unique<PendingCallback>(PendingCallback{
            MonoState::Current()->GetWeakPtr(), callback, callback_handle}),
        weak_state = std::weak_ptr<MultiFrameCodec::State>(state_), trace_id,
        ui_task_runner = task_runners.GetUITaskRunner(),
+       concurrent_task_runner = std::move(concurrent_task_runner),
        io_manager = mono_state->GetIOManager()]() mutable {
         auto state = weak_state.lock();
         if (!state) {
@@ -177,7 +330,8 @@ const char* MultiFrameCodec::getNextFrame(GetNextFrameCallback callback,
           return;
         }
         state->GetNextFrameAndInvokeCallback(
-            std::move(callback), std::move(ui_task_runner),
+            state, std::move(callback), std::move(ui_task_runner),
+            std::move(concurrent_task_runner),
             io_manager->GetResourceContext(), io_manager->GetSkiaUnrefQueue(),
             trace_id);
       }));
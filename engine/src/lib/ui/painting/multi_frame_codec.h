@@ -1,6 +1,13 @@
 #pragma once
 
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "codec.h"
+#include "flow/skia_gpu_object.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "runtime/mono_state.h"
 
@@ -8,7 +15,13 @@ namespace uiwidgets {
 
 class MultiFrameCodec : public Codec {
  public:
-  MultiFrameCodec(std::unique_ptr<SkCodec> codec);
+  // Animations whose frames all fit in this many bytes keep every frame
+  // after the first loop instead of decoding it again.
+  static constexpr size_t kDefaultCacheAllFramesMaxBytes = 4 * 1024 * 1024;
+
+  MultiFrameCodec(
+      std::unique_ptr<SkCodec> codec,
+      size_t cache_all_frames_max_bytes = kDefaultCacheAllFramesMaxBytes);
 
   ~MultiFrameCodec() override;
 
@@ -33,28 +46,81 @@ class MultiFrameCodec : public Codec {
   // Instead, the MultiFrameCodec creates this object when it is constructed,
   // shares it with the IO task runner's decoding work, and sets the live_
   // member to false when it is destructed.
+  //
+  // Frames are decoded ahead of playback into a ring of up to
+  // |lookAheadCapacity_| frames on the concurrent workers, and uploaded on
+  // the IO task runner when they are requested. The IO task runner only
+  // decodes a frame itself if the workers have not got to it yet.
   struct State {
-    State(std::unique_ptr<SkCodec> codec);
+    State(std::unique_ptr<SkCodec> codec, size_t cache_all_frames_max_bytes);
 
     const std::unique_ptr<SkCodec> codec_;
     const int frameCount_;
     const int repetitionCount_;
-
-    // The non-const members and functions below here are only read or written
-    // to on the IO thread. They are not safe to access or write on the UI
-    // thread.
-    int nextFrameIndex_;
+    const SkImageInfo info_;
+    const size_t lookAheadCapacity_;
+
+    struct DecodedFrame {
+      int index = 0;
+      int durationMillis = 0;
+      // Empty if the frame could not be decoded.
+      SkBitmap bitmap;
+    };
+
+    // Guards the codec and the decoding state below. Taken before
+    // |ringMutex_| when both are needed.
+    std::mutex decodeMutex_;
+
+    // The index of the next frame to decode.
+    int nextDecodeIndex_ = 0;
     // The last decoded frame that's required to decode any subsequent frames.
     std::unique_ptr<SkBitmap> lastRequiredFrame_;
 
     // The index of the last decoded required frame.
     int lastRequiredFrameIndex_ = -1;
 
-    sk_sp<SkImage> GetNextFrameImage(fml::WeakPtr<GrContext> resourceContext);
+    // Guards the members below.
+    std::mutex ringMutex_;
+    // The frames decoded ahead, in playback order.
+    std::deque<DecodedFrame> ring_;
+    // Pixel buffers of uploaded frames, reused for the next frames.
+    std::vector<SkBitmap> freeBitmaps_;
+    bool lookAheadScheduled_ = false;
+    // Set once every frame is cached, after which nothing is decoded.
+    bool allFramesCached_ = false;
+
+    // The members below here are only read or written to on the IO thread.
+    // They are not safe to access or write on the UI thread.
+    int nextFrameIndex_;
+    bool cacheAllFrames_;
+    // The uploaded frames of the first loop if |cacheAllFrames_| is set.
+    std::vector<SkiaGPUObject<SkImage>> cachedFrames_;
+    std::vector<int> cachedDurations_;
+
+    // Decodes the frame at |nextDecodeIndex_|. Requires |decodeMutex_|.
+    DecodedFrame DecodeNextFrameLocked();
+
+    // Returns the decoded frame |index|, which must be the next frame to
+    // play, from the ring or by decoding it.
+    DecodedFrame TakeFrame(int index);
+
+    void RecycleBitmap(SkBitmap bitmap);
+
+    // Decodes frames on a worker until the ring is full.
+    static void FillRing(std::weak_ptr<State> weak_state);
+
+    void ScheduleLookAhead(
+        const std::shared_ptr<State>& self,
+        const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner);
+
+    sk_sp<SkImage> UploadFrame(const DecodedFrame& frame,
+                               fml::WeakPtr<GrContext> resourceContext);
 
     void GetNextFrameAndInvokeCallback(
+        std::shared_ptr<State> self,
         std::unique_ptr<PendingCallback> callback,
         fml::RefPtr<fml::TaskRunner> ui_task_runner,
+        std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
         fml::WeakPtr<GrContext> resourceContext,
         fml::RefPtr<SkiaUnrefQueue> unref_queue, size_t trace_id);
   };
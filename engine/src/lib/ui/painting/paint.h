@@ -1,20 +1,29 @@
 #pragma once
 
+#include <memory>
+
 #include "include/core/SkPaint.h"
 #include "runtime/mono_api.h"
 
 namespace uiwidgets {
 
+// Size of the paint_data blob and number of paint_objects passed in from
+// painting.cs.
+constexpr size_t kPaintDataByteCount = 56;
+constexpr int kPaintObjectCount = 3;
+
 class Paint {
  public:
   Paint() = default;
   Paint(void** paint_objects, uint8_t* paint_data);
 
-  const SkPaint* paint() const { return is_null_ ? nullptr : &paint_; }
+  const SkPaint* paint() const { return paint_.get(); }
+
+  const std::shared_ptr<const SkPaint>& shared_paint() const { return paint_; }
 
  private:
-  SkPaint paint_;
-  bool is_null_ = true;
+  // Shared with the PaintCache of the current UIMonoState, never mutated.
+  std::shared_ptr<const SkPaint> paint_;
 };
 
 }  // namespace uiwidgets
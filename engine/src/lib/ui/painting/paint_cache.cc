@@ -0,0 +1,281 @@
+#include "paint_cache.h"
+
+#include <cstring>
+
+#include "color_filter.h"
+#include "flutter/fml/logging.h"
+#include "image_filter.h"
+#include "lib/ui/ui_mono_state.h"
+#include "shader.h"
+
+namespace uiwidgets {
+
+namespace {
+
+// Indices for 32bit values.
+constexpr int kIsAntiAliasIndex = 0;
+constexpr int kColorIndex = 1;
+constexpr int kBlendModeIndex = 2;
+constexpr int kStyleIndex = 3;
+constexpr int kStrokeWidthIndex = 4;
+constexpr int kStrokeCapIndex = 5;
+constexpr int kStrokeJoinIndex = 6;
+constexpr int kStrokeMiterLimitIndex = 7;
+constexpr int kFilterQualityIndex = 8;
+constexpr int kMaskFilterIndex = 9;
+constexpr int kMaskFilterBlurStyleIndex = 10;
+constexpr int kMaskFilterSigmaIndex = 11;
+constexpr int kInvertColorIndex = 12;
+constexpr int kDitherIndex = 13;
+static_assert(kPaintDataByteCount == 4 * (kDitherIndex + 1),
+              "Paint data size does not match the last index.");
+
+// Indices for objects.
+constexpr int kShaderIndex = 0;
+constexpr int kColorFilterIndex = 1;
+constexpr int kImageFilterIndex = 2;
+static_assert(kPaintObjectCount == kImageFilterIndex + 1,
+              "Paint object count does not match the last index.");
+
+// Must be kept in sync with the default in painting.cs.
+constexpr uint32_t kColorDefault = 0xFF000000;
+
+// Must be kept in sync with the default in painting.cs.
+constexpr uint32_t kBlendModeDefault =
+    static_cast<uint32_t>(SkBlendMode::kSrcOver);
+
+// Must be kept in sync with the default in painting.cs, and also with the
+// default SkPaintDefaults_MiterLimit in Skia (which is not in a public header).
+constexpr double kStrokeMiterLimitDefault = 4.0;
+
+// A color matrix which inverts colors.
+// clang-format off
+constexpr float invert_colors[20] = {
+  -1.0,    0,    0, 1.0, 0,
+     0, -1.0,    0, 1.0, 0,
+     0,    0, -1.0, 1.0, 0,
+   1.0,  1.0,  1.0, 1.0, 0
+};
+// clang-format on
+
+// Must be kept in sync with the MaskFilter private constants in painting.cs.
+enum MaskFilterType { Null, Blur };
+
+inline uint64_t HashCombine(uint64_t hash, uint64_t value) {
+  hash = (hash ^ value) * 0x100000001b3ull;
+  return hash ^ (hash >> 29);
+}
+
+void ResolvePaintObjects(void** paint_objects, sk_sp<SkShader>* shader,
+                         sk_sp<SkColorFilter>* color_filter,
+                         sk_sp<SkImageFilter>* image_filter) {
+  if (paint_objects == nullptr) return;
+
+  if (auto* object = static_cast<Shader*>(paint_objects[kShaderIndex]))
+    *shader = object->shader();
+  if (auto* object =
+          static_cast<ColorFilter*>(paint_objects[kColorFilterIndex]))
+    *color_filter = object->filter();
+  if (auto* object =
+          static_cast<ImageFilter*>(paint_objects[kImageFilterIndex]))
+    *image_filter = object->filter();
+}
+
+}  // namespace
+
+bool PaintCache::Key::operator==(const Key& other) const {
+  return hash == other.hash &&
+         memcmp(objects, other.objects, sizeof(objects)) == 0 &&
+         memcmp(data, other.data, sizeof(data)) == 0;
+}
+
+size_t PaintCache::BlurKeyHash::operator()(const BlurKey& key) const {
+  uint32_t sigma_bits;
+  memcpy(&sigma_bits, &key.sigma, sizeof(sigma_bits));
+  return HashCombine(static_cast<uint64_t>(key.style), sigma_bits);
+}
+
+PaintCache::PaintCache(size_t max_entries) : max_entries_(max_entries) {}
+
+PaintCache::~PaintCache() = default;
+
+std::shared_ptr<const SkPaint> PaintCache::Get(void** paint_objects,
+                                               const uint8_t* paint_data) {
+  sk_sp<SkShader> shader;
+  sk_sp<SkColorFilter> color_filter;
+  sk_sp<SkImageFilter> image_filter;
+  ResolvePaintObjects(paint_objects, &shader, &color_filter, &image_filter);
+
+  Key key;
+  memcpy(key.data, paint_data, kPaintDataByteCount);
+  key.objects[kShaderIndex] = shader.get();
+  key.objects[kColorFilterIndex] = color_filter.get();
+  key.objects[kImageFilterIndex] = image_filter.get();
+
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < kPaintDataByteCount; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, key.data + i, sizeof(word));
+    hash = HashCombine(hash, word);
+  }
+  for (auto* object : key.objects) {
+    hash = HashCombine(hash, reinterpret_cast<uintptr_t>(object));
+  }
+  key.hash = static_cast<size_t>(hash);
+
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    hit_count_++;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->second;
+  }
+
+  miss_count_++;
+  auto paint = Decode(std::move(shader), std::move(color_filter),
+                      std::move(image_filter), paint_data, this);
+  entries_.emplace_front(key, paint);
+  index_.emplace(key, entries_.begin());
+
+  if (entries_.size() > max_entries_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  return paint;
+}
+
+std::shared_ptr<const SkPaint> PaintCache::Decode(void** paint_objects,
+                                                  const uint8_t* paint_data,
+                                                  PaintCache* cache) {
+  sk_sp<SkShader> shader;
+  sk_sp<SkColorFilter> color_filter;
+  sk_sp<SkImageFilter> image_filter;
+  ResolvePaintObjects(paint_objects, &shader, &color_filter, &image_filter);
+  return Decode(std::move(shader), std::move(color_filter),
+                std::move(image_filter), paint_data, cache);
+}
+
+std::shared_ptr<const SkPaint> PaintCache::Decode(
+    sk_sp<SkShader> shader, sk_sp<SkColorFilter> color_filter,
+    sk_sp<SkImageFilter> image_filter, const uint8_t* paint_data,
+    PaintCache* cache) {
+  auto paint = std::make_shared<SkPaint>();
+
+  paint->setShader(std::move(shader));
+  paint->setColorFilter(std::move(color_filter));
+  paint->setImageFilter(std::move(image_filter));
+
+  const uint32_t* uint_data = reinterpret_cast<const uint32_t*>(paint_data);
+  const float* float_data = reinterpret_cast<const float*>(paint_data);
+
+  paint->setAntiAlias(uint_data[kIsAntiAliasIndex] == 0);
+
+  uint32_t encoded_color = uint_data[kColorIndex];
+  if (encoded_color) {
+    SkColor color = encoded_color ^ kColorDefault;
+    paint->setColor(color);
+  }
+
+  uint32_t encoded_blend_mode = uint_data[kBlendModeIndex];
+  if (encoded_blend_mode) {
+    uint32_t blend_mode = encoded_blend_mode ^ kBlendModeDefault;
+    paint->setBlendMode(static_cast<SkBlendMode>(blend_mode));
+  }
+
+  uint32_t style = uint_data[kStyleIndex];
+  if (style) paint->setStyle(static_cast<SkPaint::Style>(style));
+
+  float stroke_width = float_data[kStrokeWidthIndex];
+  if (stroke_width != 0.0) paint->setStrokeWidth(stroke_width);
+
+  uint32_t stroke_cap = uint_data[kStrokeCapIndex];
+  if (stroke_cap) paint->setStrokeCap(static_cast<SkPaint::Cap>(stroke_cap));
+
+  uint32_t stroke_join = uint_data[kStrokeJoinIndex];
+  if (stroke_join)
+    paint->setStrokeJoin(static_cast<SkPaint::Join>(stroke_join));
+
+  float stroke_miter_limit = float_data[kStrokeMiterLimitIndex];
+  if (stroke_miter_limit != 0.0)
+    paint->setStrokeMiter(stroke_miter_limit + kStrokeMiterLimitDefault);
+
+  uint32_t filter_quality = uint_data[kFilterQualityIndex];
+  if (filter_quality)
+    paint->setFilterQuality(static_cast<SkFilterQuality>(filter_quality));
+
+  if (uint_data[kInvertColorIndex]) {
+    sk_sp<SkColorFilter> invert_filter =
+        cache ? cache->GetInvertColorFilter()
+              : ColorFilter::MakeColorMatrixFilter255(invert_colors);
+    sk_sp<SkColorFilter> current_filter = paint->refColorFilter();
+    if (current_filter) {
+      invert_filter = invert_filter->makeComposed(current_filter);
+    }
+    paint->setColorFilter(invert_filter);
+  }
+
+  if (uint_data[kDitherIndex]) {
+    paint->setDither(true);
+  }
+
+  switch (uint_data[kMaskFilterIndex]) {
+    case Null:
+      break;
+    case Blur:
+      SkBlurStyle blur_style =
+          static_cast<SkBlurStyle>(uint_data[kMaskFilterBlurStyleIndex]);
+      float sigma = float_data[kMaskFilterSigmaIndex];
+      paint->setMaskFilter(cache ? cache->GetBlurMaskFilter(blur_style, sigma)
+                                 : SkMaskFilter::MakeBlur(blur_style, sigma));
+      break;
+  }
+
+  return paint;
+}
+
+void PaintCache::Clear() {
+  index_.clear();
+  entries_.clear();
+  blur_filters_.clear();
+  invert_filter_.reset();
+}
+
+sk_sp<SkMaskFilter> PaintCache::GetBlurMaskFilter(SkBlurStyle style,
+                                                  float sigma) {
+  BlurKey key = {style, sigma};
+  auto found = blur_filters_.find(key);
+  if (found != blur_filters_.end()) {
+    return found->second;
+  }
+
+  // Animated blurs produce a new sigma every frame; start over rather than
+  // keeping every one of them alive.
+  if (blur_filters_.size() >= kMaxBlurMaskFilters) {
+    blur_filters_.clear();
+  }
+
+  auto filter = SkMaskFilter::MakeBlur(style, sigma);
+  blur_filters_.emplace(key, filter);
+  return filter;
+}
+
+sk_sp<SkColorFilter> PaintCache::GetInvertColorFilter() {
+  if (!invert_filter_) {
+    invert_filter_ = ColorFilter::MakeColorMatrixFilter255(invert_colors);
+  }
+  return invert_filter_;
+}
+
+UIWIDGETS_API(size_t) PaintCache_entryCount() {
+  return UIMonoState::Current()->GetPaintCache().GetEntryCount();
+}
+
+UIWIDGETS_API(size_t) PaintCache_hitCount() {
+  return UIMonoState::Current()->GetPaintCache().hit_count();
+}
+
+UIWIDGETS_API(size_t) PaintCache_missCount() {
+  return UIMonoState::Current()->GetPaintCache().miss_count();
+}
+
+}  // namespace uiwidgets
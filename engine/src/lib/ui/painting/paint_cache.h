@@ -0,0 +1,101 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "flutter/fml/macros.h"
+#include "include/core/SkBlurTypes.h"
+#include "include/core/SkColorFilter.h"
+#include "include/core/SkImageFilter.h"
+#include "include/core/SkMaskFilter.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkShader.h"
+#include "paint.h"
+
+namespace uiwidgets {
+
+// Interns decoded paints so that draw calls passing the same paint data and
+// paint objects share one immutable SkPaint instead of rebuilding it (and its
+// mask and color filters) every time. Owned by the UIMonoState and only used
+// on the UI thread.
+class PaintCache {
+ public:
+  static constexpr size_t kDefaultMaxEntries = 256;
+
+  explicit PaintCache(size_t max_entries = kDefaultMaxEntries);
+
+  ~PaintCache();
+
+  std::shared_ptr<const SkPaint> Get(void** paint_objects,
+                                     const uint8_t* paint_data);
+
+  // Builds a paint from the encoded data. Filters derived from the data are
+  // shared through |cache| if it is not null.
+  static std::shared_ptr<const SkPaint> Decode(void** paint_objects,
+                                               const uint8_t* paint_data,
+                                               PaintCache* cache);
+
+  void Clear();
+
+  size_t GetEntryCount() const { return entries_.size(); }
+
+  size_t hit_count() const { return hit_count_; }
+
+  size_t miss_count() const { return miss_count_; }
+
+ private:
+  struct Key {
+    uint8_t data[kPaintDataByteCount];
+    // The Skia objects referenced by the paint objects. The cached paint holds
+    // a reference to each of them, so their addresses cannot be reused while
+    // the entry is alive.
+    const void* objects[kPaintObjectCount];
+    size_t hash;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const { return key.hash; }
+  };
+
+  using Entry = std::pair<Key, std::shared_ptr<const SkPaint>>;
+  using EntryList = std::list<Entry>;
+
+  struct BlurKey {
+    SkBlurStyle style;
+    float sigma;
+
+    bool operator==(const BlurKey& other) const {
+      return style == other.style && sigma == other.sigma;
+    }
+  };
+
+  struct BlurKeyHash {
+    size_t operator()(const BlurKey& key) const;
+  };
+
+  static constexpr size_t kMaxBlurMaskFilters = 32;
+
+  const size_t max_entries_;
+  EntryList entries_;  // Most recently used first.
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+  std::unordered_map<BlurKey, sk_sp<SkMaskFilter>, BlurKeyHash> blur_filters_;
+  sk_sp<SkColorFilter> invert_filter_;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+
+  static std::shared_ptr<const SkPaint> Decode(
+      sk_sp<SkShader> shader, sk_sp<SkColorFilter> color_filter,
+      sk_sp<SkImageFilter> image_filter, const uint8_t* paint_data,
+      PaintCache* cache);
+
+  sk_sp<SkMaskFilter> GetBlurMaskFilter(SkBlurStyle style, float sigma);
+
+  sk_sp<SkColorFilter> GetInvertColorFilter();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PaintCache);
+};
+
+}  // namespace uiwidgets
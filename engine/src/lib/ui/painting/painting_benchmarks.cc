@@ -0,0 +1,214 @@
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include "benchmarking/benchmarking.h"
+#include "flutter/fml/trace_event.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkImageEncoder.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/utils/SkNoDrawCanvas.h"
+#include "lib/ui/painting/canvas.h"
+#include "lib/ui/painting/image_decoder.h"
+#include "lib/ui/painting/paint_cache.h"
+#include "lib/ui/painting/paint.h"
+#include "runtime/mono_api.h"
+#include "runtime/mono_isolate.h"
+
+namespace uiwidgets {
+
+namespace {
+
+// Encodes paint data the way painting.cs does: a stroked, colored paint,
+// blurred if |blur| is set.
+void EncodePaintData(uint8_t* data, bool blur) {
+  uint32_t uint_data[kPaintDataByteCount / 4] = {};
+  float* float_data = reinterpret_cast<float*>(uint_data);
+  uint_data[1] = 0xFF336699 ^ 0xFF000000;  // Color.
+  uint_data[3] = 1;                        // Stroke style.
+  float_data[4] = 2.0f;                    // Stroke width.
+  if (blur) {
+    uint_data[9] = 1;       // Blur mask filter.
+    uint_data[10] = 0;      // Normal blur style.
+    float_data[11] = 4.0f;  // Sigma.
+  }
+  memcpy(data, uint_data, kPaintDataByteCount);
+}
+
+}  // namespace
+
+static void BM_PaintDecode(benchmark::State& state) {
+  uint8_t data[kPaintDataByteCount];
+  EncodePaintData(data, state.range(0) != 0);
+  void* objects[kPaintObjectCount] = {};
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(PaintCache::Decode(objects, data, nullptr));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PaintDecode)->Arg(0)->Arg(1);
+
+static void BM_PaintCacheGet(benchmark::State& state) {
+  uint8_t data[kPaintDataByteCount];
+  EncodePaintData(data, state.range(0) != 0);
+  void* objects[kPaintObjectCount] = {};
+  PaintCache cache;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.Get(objects, data));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PaintCacheGet)->Arg(0)->Arg(1);
+
+namespace {
+
+// A photo-like image of |size| by |size| pixels, encoded as a JPEG.
+sk_sp<SkData> MakeEncodedImage(int size) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(size, size);
+  SkCanvas canvas(bitmap);
+  const SkPoint points[2] = {SkPoint::Make(0, 0),
+                             SkPoint::Make(size, size)};
+  const SkColor colors[3] = {SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE};
+  SkPaint paint;
+  paint.setShader(SkGradientShader::MakeLinear(
+      points, colors, nullptr, 3, SkTileMode::kMirror));
+  canvas.drawPaint(paint);
+  paint.setShader(nullptr);
+  paint.setAntiAlias(true);
+  for (int i = 0; i < 64; i++) {
+    paint.setColor(SkColorSetARGB(128, i * 4, 255 - i * 4, (i * 37) & 0xFF));
+    canvas.drawCircle((i * 97) % size, (i * 61) % size, size / 16.0f, paint);
+  }
+  return SkEncodeBitmap(bitmap, SkEncodedImageFormat::kJPEG, 90);
+}
+
+}  // namespace
+
+// Decodes a |range(0)| pixel square JPEG, resized to |range(1)| pixels if that
+// is not zero.
+static void BM_ImageDecode(benchmark::State& state) {
+  sk_sp<SkData> data = MakeEncodedImage(state.range(0));
+  if (!data) {
+    state.SkipWithError("Could not encode the image.");
+  }
+  std::optional<uint32_t> target_size;
+  if (state.range(1) > 0) {
+    target_size = state.range(1);
+  }
+  fml::tracing::TraceFlow flow("BM_ImageDecode");
+
+  for (auto _ : state) {
+    sk_sp<SkImage> image =
+        ImageFromCompressedData(data, target_size, target_size, flow);
+    if (!image) {
+      state.SkipWithError("Could not decode the image.");
+      break;
+    }
+  }
+  if (data) {
+    state.SetBytesProcessed(state.iterations() * data->size());
+  }
+}
+BENCHMARK(BM_ImageDecode)
+    ->Args({1024, 0})
+    ->Args({1024, 256})
+    ->Args({4096, 0})
+    ->Args({4096, 512});
+
+namespace {
+
+void AppendFloat(std::vector<uint32_t>* words, float value) {
+  uint32_t word;
+  memcpy(&word, &value, sizeof(word));
+  words->push_back(word);
+}
+
+// Paints are decoded through the UIMonoState of the current isolate if there
+// is one. Enters an isolate without a state, which is never shut down.
+void EnterIsolateWithoutState() {
+  if (!Mono_CurrentIsolate()) {
+    Mono_EnterIsolate(
+        Mono_CreateIsolate(new std::shared_ptr<MonoIsolate>()));
+  }
+}
+
+// |count| translated rects, each in a save and restore, as a list of tiles
+// draws them. Every other rect changes the paint, the others reuse it.
+std::vector<uint32_t> EncodeRectCommands(int count) {
+  uint32_t paint_data[kPaintDataByteCount / 4];
+  EncodePaintData(reinterpret_cast<uint8_t*>(paint_data), false);
+
+  std::vector<uint32_t> words;
+  for (int i = 0; i < count; i++) {
+    words.push_back(kSaveOp);
+    words.push_back(kTranslateOp);
+    AppendFloat(&words, i % 16 * 20);
+    AppendFloat(&words, i / 16 * 20);
+    words.push_back(kDrawRectOp);
+    for (float value : {0, 0, 16, 16}) {
+      AppendFloat(&words, value);
+    }
+    if (i % 2 == 0) {
+      words.push_back(kInlinePaint);
+      for (int j = 0; j < kPaintObjectCount; j++) {
+        words.push_back(static_cast<uint32_t>(-1));
+      }
+      paint_data[1] = 0xFF000000 | i;  // Color.
+      words.insert(words.end(), std::begin(paint_data), std::end(paint_data));
+    } else {
+      words.push_back(kPreviousPaint);
+    }
+    words.push_back(kRestoreOp);
+  }
+  return words;
+}
+
+}  // namespace
+
+// Replays |range(0)| rects from a command buffer, against a canvas that
+// draws nothing, so that decoding the buffer is measured.
+static void BM_CanvasSubmitCommands(benchmark::State& state) {
+  EnterIsolateWithoutState();
+  const std::vector<uint32_t> words = EncodeRectCommands(state.range(0));
+  SkNoDrawCanvas sk_canvas(1024, 1024);
+  auto canvas = fml::MakeRefCounted<Canvas>(&sk_canvas);
+
+  for (auto _ : state) {
+    canvas->submitCommands(reinterpret_cast<const uint8_t*>(words.data()),
+                           words.size() * 4, nullptr, 0);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * words.size() * 4);
+}
+BENCHMARK(BM_CanvasSubmitCommands)->Arg(16)->Arg(256)->Arg(4096);
+
+// The same rects drawn with one Canvas call each, as the Canvas_* entry
+// points do, for comparison with BM_CanvasSubmitCommands.
+static void BM_CanvasDirectCalls(benchmark::State& state) {
+  EnterIsolateWithoutState();
+  const int count = state.range(0);
+  uint8_t paint_data[kPaintDataByteCount];
+  EncodePaintData(paint_data, false);
+  void* paint_objects[kPaintObjectCount] = {};
+  SkNoDrawCanvas sk_canvas(1024, 1024);
+  auto canvas = fml::MakeRefCounted<Canvas>(&sk_canvas);
+
+  for (auto _ : state) {
+    for (int i = 0; i < count; i++) {
+      canvas->save();
+      canvas->translate(i % 16 * 20, i / 16 * 20);
+      const Paint paint(paint_objects, paint_data);
+      canvas->drawRect(0, 0, 16, 16, paint);
+      canvas->restore();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CanvasDirectCalls)->Arg(16)->Arg(256)->Arg(4096);
+
+}  // namespace uiwidgets
@@ -0,0 +1,203 @@
+#include "pixel_buffer_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "runtime/mono_api.h"
+
+#if OS_ANDROID
+#include <sys/mman.h>
+#endif
+
+namespace uiwidgets {
+
+PixelBufferPool& PixelBufferPool::GetInstance() {
+  // Never destroyed, images may be released during shutdown.
+  static PixelBufferPool* pool = new PixelBufferPool(kDefaultMaxFreeBytes);
+  return *pool;
+}
+
+PixelBufferPool::PixelBufferPool(size_t max_free_bytes)
+    : max_free_bytes_(max_free_bytes) {}
+
+PixelBufferPool::~PixelBufferPool() { Trim(); }
+
+bool PixelBufferPool::TryAllocPixels(SkBitmap* bitmap,
+                                     const SkImageInfo& info) {
+  const size_t row_bytes = info.minRowBytes();
+  const size_t size = info.computeByteSize(row_bytes);
+  if (size < kMinPooledBytes || SkImageInfo::ByteSizeOverflowed(size)) {
+    return bitmap->tryAllocPixels(info);
+  }
+
+  Buffer* buffer = Acquire(size);
+  if (buffer == nullptr) {
+    return false;
+  }
+  return bitmap->installPixels(
+      info, buffer->memory, row_bytes,
+      [](void* pixels, void* context) {
+        GetInstance().Release(static_cast<Buffer*>(context));
+      },
+      buffer);
+}
+
+sk_sp<SkData> PixelBufferPool::MakeDataWithCopy(const void* data,
+                                                size_t length) {
+  if (length < kMinPooledBytes) {
+    return SkData::MakeWithCopy(data, length);
+  }
+
+  Buffer* buffer = Acquire(length);
+  if (buffer == nullptr) {
+    return nullptr;
+  }
+  ::memcpy(buffer->memory, data, length);
+  return SkData::MakeWithProc(
+      buffer->memory, length,
+      [](const void* ptr, void* context) {
+        GetInstance().Release(static_cast<Buffer*>(context));
+      },
+      buffer);
+}
+
+PixelBufferPool::Buffer* PixelBufferPool::Acquire(size_t size) {
+  const size_t bucket_size = GetBucketSize(size);
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = free_buffers_.find(bucket_size);
+    if (found != free_buffers_.end() && !found->second.empty()) {
+      Buffer* buffer = found->second.back();
+      found->second.pop_back();
+      statistics_.free_bytes -= buffer->size;
+      statistics_.used_bytes += buffer->size;
+      statistics_.hit_count++;
+      return buffer;
+    }
+    statistics_.miss_count++;
+  }
+
+  Buffer* buffer = AllocateBuffer(bucket_size);
+  if (buffer == nullptr) {
+    FML_LOG(ERROR) << "Failed to allocate a pixel buffer of " << bucket_size
+                   << "B";
+    return nullptr;
+  }
+
+  std::scoped_lock lock(mutex_);
+  statistics_.used_bytes += buffer->size;
+  statistics_.high_water_bytes =
+      std::max(statistics_.high_water_bytes,
+               statistics_.used_bytes + statistics_.free_bytes);
+  return buffer;
+}
+
+void PixelBufferPool::Release(Buffer* buffer) {
+  {
+    std::scoped_lock lock(mutex_);
+    statistics_.used_bytes -= buffer->size;
+    if (statistics_.free_bytes + buffer->size <= max_free_bytes_) {
+      free_buffers_[buffer->size].push_back(buffer);
+      statistics_.free_bytes += buffer->size;
+      return;
+    }
+  }
+  FreeBuffer(buffer);
+}
+
+void PixelBufferPool::Trim() {
+  TRACE_EVENT0("uiwidgets", "PixelBufferPool::Trim");
+  std::map<size_t, std::vector<Buffer*>> free_buffers;
+  {
+    std::scoped_lock lock(mutex_);
+    free_buffers.swap(free_buffers_);
+    statistics_.free_bytes = 0;
+  }
+  for (auto& bucket : free_buffers) {
+    for (Buffer* buffer : bucket.second) {
+      FreeBuffer(buffer);
+    }
+  }
+}
+
+PixelBufferPool::Statistics PixelBufferPool::GetStatistics() const {
+  std::scoped_lock lock(mutex_);
+  return statistics_;
+}
+
+void PixelBufferPool::TraceStatsToTimeline() const {
+#if !UIWidgets_RELEASE
+
+  const Statistics statistics = GetStatistics();
+  FML_TRACE_COUNTER("uiwidgets", "PixelBufferPool",
+                    reinterpret_cast<int64_t>(this),                         //
+                    "UsedMBytes", statistics.used_bytes * 1e-6,              //
+                    "FreeMBytes", statistics.free_bytes * 1e-6,              //
+                    "HighWaterMBytes", statistics.high_water_bytes * 1e-6  //
+  );
+
+#endif  // !UIWidgets_RELEASE
+}
+
+size_t PixelBufferPool::GetBucketSize(size_t size) {
+  // Rounds up to a quarter of the power of two below, which wastes at most
+  // a fifth of the buffer.
+  size_t power = 1;
+  while (power * 2 < size) {
+    power *= 2;
+  }
+  const size_t step = std::max<size_t>(power / 4, 1);
+  return (size + step - 1) / step * step;
+}
+
+#if OS_ANDROID
+
+// Buffers may be released on a different thread than they were allocated on.
+// Android's implementation of malloc appears to keep growing the native heap
+// when that happens, so the buffers are anonymous mappings.
+PixelBufferPool::Buffer* PixelBufferPool::AllocateBuffer(size_t size) {
+  void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (memory == MAP_FAILED) {
+    return nullptr;
+  }
+  return new Buffer{memory, size};
+}
+
+void PixelBufferPool::FreeBuffer(Buffer* buffer) {
+  if (::munmap(buffer->memory, buffer->size) == -1) {
+    FML_LOG(ERROR) << "munmap of pixel buffer failed";
+  }
+  delete buffer;
+}
+
+#else
+
+PixelBufferPool::Buffer* PixelBufferPool::AllocateBuffer(size_t size) {
+  void* memory = ::malloc(size);
+  if (memory == nullptr) {
+    return nullptr;
+  }
+  return new Buffer{memory, size};
+}
+
+void PixelBufferPool::FreeBuffer(Buffer* buffer) {
+  ::free(buffer->memory);
+  delete buffer;
+}
+
+#endif  // OS_ANDROID
+
+UIWIDGETS_API(void) PixelBufferPool_getStatistics(int64_t* data) {
+  const auto statistics = PixelBufferPool::GetInstance().GetStatistics();
+  data[0] = statistics.used_bytes;
+  data[1] = statistics.free_bytes;
+  data[2] = statistics.high_water_bytes;
+  data[3] = statistics.hit_count;
+  data[4] = statistics.miss_count;
+}
+
+}  // namespace uiwidgets
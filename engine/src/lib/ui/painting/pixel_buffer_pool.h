@@ -0,0 +1,84 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImageInfo.h"
+
+namespace uiwidgets {
+
+// Large pixel and data buffers, reused across image decodes, resizes and
+// snapshots so that scrolling through many images does not keep allocating
+// and freeing large blocks. Buffers are grouped by size in steps of a quarter
+// of a power of two and return to the pool when the last bitmap, image or
+// data using them is released. Thread-safe, one per process.
+class PixelBufferPool {
+ public:
+  // Smaller buffers are left to the allocator.
+  static constexpr size_t kMinPooledBytes = 64 * 1024;
+
+  // The most bytes of free buffers the pool keeps.
+  static constexpr size_t kDefaultMaxFreeBytes = 32 * 1024 * 1024;
+
+  struct Statistics {
+    size_t used_bytes = 0;
+    size_t free_bytes = 0;
+    // The most bytes used and free at the same time.
+    size_t high_water_bytes = 0;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+  };
+
+  static PixelBufferPool& GetInstance();
+
+  // Allocates the pixels of |bitmap| for |info| with its minimum row bytes.
+  // Images made from the bitmap with SkImage::MakeFromBitmap keep the buffer
+  // until they are released as well.
+  bool TryAllocPixels(SkBitmap* bitmap, const SkImageInfo& info);
+
+  // Copies |length| bytes from |data| into a pooled buffer. Returns null if
+  // the buffer could not be allocated.
+  sk_sp<SkData> MakeDataWithCopy(const void* data, size_t length);
+
+  // Frees all free buffers, e.g. when memory runs low.
+  void Trim();
+
+  Statistics GetStatistics() const;
+
+  void TraceStatsToTimeline() const;
+
+ private:
+  struct Buffer {
+    void* memory;
+    size_t size;
+  };
+
+  mutable std::mutex mutex_;
+  // Free buffers by size.
+  std::map<size_t, std::vector<Buffer*>> free_buffers_;
+  const size_t max_free_bytes_;
+  Statistics statistics_;
+
+  explicit PixelBufferPool(size_t max_free_bytes);
+
+  ~PixelBufferPool();
+
+  // Returns a buffer of at least |size| bytes.
+  Buffer* Acquire(size_t size);
+
+  void Release(Buffer* buffer);
+
+  static size_t GetBucketSize(size_t size);
+
+  static Buffer* AllocateBuffer(size_t size);
+
+  static void FreeBuffer(Buffer* buffer);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PixelBufferPool);
+};
+
+}  // namespace uiwidgets
@@ -0,0 +1,457 @@
+#include "progressive_codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
+#include "flutter/fml/trace_event.h"
+#include "include/core/SkStream.h"
+#include "lib/ui/ui_mono_state.h"
+#include "pixel_buffer_pool.h"
+
+namespace uiwidgets {
+
+// The chunks of encoded data received so far. Appended to on the UI thread
+// and read by the decoder on a worker.
+class ProgressiveCodec::ChunkBuffer {
+ public:
+  void Append(sk_sp<SkData> chunk, bool is_last) {
+    std::scoped_lock lock(mutex_);
+    if (chunk->size() > 0) {
+      size_ += chunk->size();
+      chunk_ends_.push_back(size_);
+      chunks_.push_back(std::move(chunk));
+    }
+    complete_ = is_last;
+  }
+
+  // Copies up to |length| bytes starting at |offset| to |dst|, or skips them
+  // if |dst| is null. Returns the number of bytes available.
+  size_t Read(size_t offset, void* dst, size_t length) const {
+    std::scoped_lock lock(mutex_);
+    if (offset >= size_) {
+      return 0;
+    }
+    length = std::min(length, size_ - offset);
+    if (dst == nullptr) {
+      return length;
+    }
+
+    auto* out = static_cast<uint8_t*>(dst);
+    size_t index = std::upper_bound(chunk_ends_.begin(), chunk_ends_.end(),
+                                    offset) -
+                   chunk_ends_.begin();
+    size_t copied = 0;
+    while (copied < length) {
+      const auto& chunk = chunks_[index];
+      const size_t chunk_start = chunk_ends_[index] - chunk->size();
+      const size_t chunk_offset = offset + copied - chunk_start;
+      const size_t count =
+          std::min(length - copied, chunk->size() - chunk_offset);
+      ::memcpy(out + copied, chunk->bytes() + chunk_offset, count);
+      copied += count;
+      index++;
+    }
+    return length;
+  }
+
+  // Returns all the data received so far in one piece.
+  sk_sp<SkData> Snapshot() const {
+    std::scoped_lock lock(mutex_);
+    if (chunks_.size() == 1) {
+      return chunks_.front();
+    }
+    sk_sp<SkData> data = SkData::MakeUninitialized(size_);
+    auto* out = static_cast<uint8_t*>(data->writable_data());
+    for (const auto& chunk : chunks_) {
+      ::memcpy(out, chunk->data(), chunk->size());
+      out += chunk->size();
+    }
+    return data;
+  }
+
+  size_t size() const {
+    std::scoped_lock lock(mutex_);
+    return size_;
+  }
+
+  bool is_complete() const {
+    std::scoped_lock lock(mutex_);
+    return complete_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<sk_sp<SkData>> chunks_;
+  // The offset just past each chunk.
+  std::vector<size_t> chunk_ends_;
+  size_t size_ = 0;
+  bool complete_ = false;
+};
+
+namespace {
+
+// Reads the data of a ChunkBuffer. Reads past the data received so far come
+// up short, which lets incremental decoders stop and resume once more data
+// arrived.
+class ChunkStream final : public SkStream {
+ public:
+  explicit ChunkStream(
+      std::shared_ptr<const ProgressiveCodec::ChunkBuffer> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  size_t read(void* buffer, size_t size) override {
+    const size_t count = buffer_->Read(position_, buffer, size);
+    position_ += count;
+    return count;
+  }
+
+  size_t peek(void* buffer, size_t size) const override {
+    return buffer_->Read(position_, buffer, size);
+  }
+
+  bool isAtEnd() const override {
+    return buffer_->is_complete() && position_ >= buffer_->size();
+  }
+
+  bool rewind() override {
+    position_ = 0;
+    return true;
+  }
+
+  bool hasPosition() const override { return true; }
+
+  size_t getPosition() const override { return position_; }
+
+ private:
+  const std::shared_ptr<const ProgressiveCodec::ChunkBuffer> buffer_;
+  size_t position_ = 0;
+};
+
+// Enough to recognize the format of any of the supported codecs.
+constexpr size_t kMinSniffSize = 32;
+
+}  // namespace
+
+// The decoder of a ProgressiveCodec. Only used by one decode at a time, see
+// ProgressiveCodec::ScheduleDecode.
+class ProgressiveCodec::DecodeState {
+ public:
+  DecodeState(std::shared_ptr<const ChunkBuffer> buffer,
+              fml::TimeDelta min_publish_interval)
+      : buffer_(std::move(buffer)),
+        min_publish_interval_(min_publish_interval) {}
+
+  // Decodes the data received since the last call. Returns the image to
+  // publish, if any: the whole image once finished, or the rows decoded so
+  // far if the last one was published at least |min_publish_interval_| ago.
+  // Partial images share their pixels with |bitmap_|.
+  sk_sp<SkImage> Decode() {
+    TRACE_EVENT0("uiwidgets", "ProgressiveCodec::DecodeState::Decode");
+
+    const bool complete = buffer_->is_complete();
+    if (!started_ && !Start(complete)) {
+      return nullptr;
+    }
+
+    const fml::TimePoint now = fml::TimePoint::Now();
+    const bool publish_due = now - last_publish_ >= min_publish_interval_;
+
+    SkCodec::Result result;
+    if (incremental_) {
+      result = codec_->incrementalDecode();
+    } else if (complete || publish_due) {
+      // Formats without incremental decoding start over every time, which
+      // the publish interval keeps rare.
+      result = DecodeSnapshot();
+    } else {
+      return nullptr;
+    }
+
+    if (result == SkCodec::kSuccess || result == SkCodec::kErrorInInput ||
+        (complete && result == SkCodec::kIncompleteInput)) {
+      // A truncated or corrupt image keeps the rows that could be decoded.
+      Finish();
+      bitmap_.setImmutable();
+      return SkImage::MakeFromBitmap(bitmap_);
+    }
+
+    if (result != SkCodec::kIncompleteInput) {
+      FML_LOG(ERROR) << "Could not decode image: "
+                     << SkCodec::ResultToString(result);
+      failed_ = true;
+      Finish();
+      return nullptr;
+    }
+
+    if (!publish_due) {
+      return nullptr;
+    }
+    last_publish_ = now;
+    return SkImage::MakeFromRaster(bitmap_.pixmap(), nullptr, nullptr);
+  }
+
+  bool finished() const { return finished_; }
+
+  bool failed() const { return failed_; }
+
+  size_t allocation_size() const { return allocation_size_; }
+
+ private:
+  std::shared_ptr<const ChunkBuffer> buffer_;
+  const fml::TimeDelta min_publish_interval_;
+  std::unique_ptr<SkCodec> codec_;
+  SkBitmap bitmap_;
+  bool started_ = false;
+  bool incremental_ = false;
+  bool finished_ = false;
+  bool failed_ = false;
+  fml::TimePoint last_publish_;
+  std::atomic<size_t> allocation_size_{0};
+
+  bool Start(bool complete) {
+    if (!complete && buffer_->size() < kMinSniffSize) {
+      return false;
+    }
+
+    codec_ = SkCodec::MakeFromStream(std::make_unique<ChunkStream>(buffer_));
+    if (!codec_) {
+      // The header may continue in the chunks still to come.
+      if (complete) {
+        FML_LOG(ERROR) << "Could not instantiate image codec.";
+        failed_ = true;
+        Finish();
+      }
+      return false;
+    }
+
+    SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
+    if (!PixelBufferPool::GetInstance().TryAllocPixels(&bitmap_, info)) {
+      FML_LOG(ERROR) << "Failed to allocate memory for progressive decode.";
+      failed_ = true;
+      Finish();
+      return false;
+    }
+    // Rows that were not decoded yet show as transparent.
+    bitmap_.eraseColor(SK_ColorTRANSPARENT);
+    allocation_size_ = bitmap_.computeByteSize();
+
+    incremental_ = codec_->startIncrementalDecode(
+                       bitmap_.info(), bitmap_.getPixels(),
+                       bitmap_.rowBytes()) == SkCodec::kSuccess;
+    if (!incremental_) {
+      codec_.reset();
+    }
+    started_ = true;
+    return true;
+  }
+
+  SkCodec::Result DecodeSnapshot() {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(buffer_->Snapshot());
+    if (!codec) {
+      return SkCodec::kInvalidInput;
+    }
+    return codec->getPixels(bitmap_.pixmap());
+  }
+
+  void Finish() {
+    finished_ = !failed_;
+    codec_.reset();
+    buffer_.reset();
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodeState);
+};
+
+ProgressiveCodec::ProgressiveCodec(GetNextFrameCallback progress_callback,
+                                   Mono_Handle progress_callback_handle,
+                                   fml::TimeDelta min_publish_interval)
+    : status_(Status::kNew),
+      buffer_(std::make_shared<ChunkBuffer>()),
+      decode_state_(
+          std::make_shared<DecodeState>(buffer_, min_publish_interval)),
+      progress_callback_{UIMonoState::Current()->GetWeakPtr(),
+                         progress_callback, progress_callback_handle} {}
+
+ProgressiveCodec::~ProgressiveCodec() = default;
+
+int ProgressiveCodec::frameCount() const { return 1; }
+
+int ProgressiveCodec::repetitionCount() const { return 0; }
+
+const char* ProgressiveCodec::getNextFrame(GetNextFrameCallback callback,
+                                           Mono_Handle callback_handle) {
+  if (!callback || !callback_handle) {
+    return "Callback must be a function";
+  }
+
+  if (status_ == Status::kComplete) {
+    if (cached_frame_) {
+      cached_frame_->AddRef();
+    }
+    callback(callback_handle, cached_frame_.get());
+    return nullptr;
+  }
+
+  // Invoked once the last chunk has been decoded.
+  pending_callbacks_.emplace_back(PendingCallback{
+      UIMonoState::Current()->GetWeakPtr(), callback, callback_handle});
+  return nullptr;
+}
+
+size_t ProgressiveCodec::GetAllocationSize() {
+  const auto data_byte_size = buffer_ ? buffer_->size() : 0;
+  auto frame_byte_size = decode_state_ ? decode_state_->allocation_size() : 0;
+  if (cached_frame_ && cached_frame_->image()) {
+    frame_byte_size = cached_frame_->image()->GetAllocationSize();
+  }
+  return data_byte_size + frame_byte_size + sizeof(this);
+}
+
+const char* ProgressiveCodec::addChunk(const uint8_t* data, size_t length,
+                                       bool is_last) {
+  if (status_ == Status::kComplete || buffer_->is_complete()) {
+    return "The last chunk was already added.";
+  }
+
+  sk_sp<SkData> chunk = MakeSkDataWithCopy(data, length);
+  if (!chunk) {
+    return "Could not allocate memory for the chunk.";
+  }
+  buffer_->Append(std::move(chunk), is_last);
+  status_ = Status::kInProgress;
+  ScheduleDecode();
+  return nullptr;
+}
+
+void ProgressiveCodec::clearProgressCallback() {
+  std::scoped_lock lock(progress_mutex_);
+  progress_callback_.callback = nullptr;
+  progress_callback_.callback_handle = nullptr;
+}
+
+void ProgressiveCodec::ScheduleDecode() {
+  if (decode_in_flight_) {
+    return;
+  }
+
+  auto decoder = UIMonoState::Current()->GetImageDecoder();
+  if (!decoder) {
+    return;
+  }
+
+  decode_in_flight_ = true;
+  scheduled_size_ = buffer_->size();
+  scheduled_complete_ = buffer_->is_complete();
+
+  // Keep the codec alive until the decoder callback is invoked on the UI
+  // thread, like SingleFrameCodec does.
+  fml::RefPtr<ProgressiveCodec>* raw_codec_ref =
+      new fml::RefPtr<ProgressiveCodec>(this);
+
+  // The worker decodes into the same bitmap the published image is read
+  // from, so the next decode is only scheduled once the image was uploaded.
+  decoder->DecodeWith(
+      [decode_state = decode_state_]() { return decode_state->Decode(); },
+      true, [raw_codec_ref](auto image) {
+        std::unique_ptr<fml::RefPtr<ProgressiveCodec>> codec_ref(
+            raw_codec_ref);
+        fml::RefPtr<ProgressiveCodec> codec(std::move(*codec_ref));
+        codec->OnDecoded(std::move(image));
+      });
+}
+
+void ProgressiveCodec::OnDecoded(SkiaGPUObject<SkImage> image) {
+  decode_in_flight_ = false;
+
+  auto state = progress_callback_.mono_state.lock();
+  if (!state) {
+    // This is probably because the isolate has been terminated before the
+    // image could be decoded.
+    status_ = Status::kComplete;
+    for (const auto& entry : pending_callbacks_) {
+      entry.callback(entry.callback_handle, nullptr);
+    }
+    pending_callbacks_.clear();
+    return;
+  }
+
+  MonoState::Scope scope(state.get());
+
+  if (decode_state_->finished() || decode_state_->failed()) {
+    if (image.get()) {
+      auto canvas_image = fml::MakeRefCounted<CanvasImage>();
+      canvas_image->set_image(std::move(image));
+
+      cached_frame_ = fml::MakeRefCounted<FrameInfo>(std::move(canvas_image),
+                                                     0 /* duration */);
+    }
+
+    // The encoded data and the decoder are no longer needed now that the
+    // image has been decoded.
+    buffer_.reset();
+    decode_state_.reset();
+    status_ = Status::kComplete;
+    CompletePendingCallbacks();
+    return;
+  }
+
+  if (image.get()) {
+    // The managed codec may be finalized on another thread meanwhile.
+    std::scoped_lock lock(progress_mutex_);
+    if (progress_callback_.callback) {
+      auto canvas_image = fml::MakeRefCounted<CanvasImage>();
+      canvas_image->set_image(std::move(image));
+
+      auto frame = fml::MakeRefCounted<FrameInfo>(std::move(canvas_image),
+                                                  0 /* duration */);
+      frame->AddRef();
+      progress_callback_.callback(progress_callback_.callback_handle,
+                                  frame.get());
+    }
+  }
+
+  if (buffer_->size() != scheduled_size_ ||
+      buffer_->is_complete() != scheduled_complete_) {
+    ScheduleDecode();
+  }
+}
+
+void ProgressiveCodec::CompletePendingCallbacks() {
+  for (const auto& entry : pending_callbacks_) {
+    if (cached_frame_) {
+      cached_frame_->AddRef();
+    }
+    entry.callback(entry.callback_handle, cached_frame_.get());
+  }
+  pending_callbacks_.clear();
+}
+
+UIWIDGETS_API(ProgressiveCodec*)
+ProgressiveCodec_constructor(Codec::GetNextFrameCallback progress_callback,
+                             Mono_Handle progress_callback_handle,
+                             int min_publish_interval_ms) {
+  const auto codec = fml::MakeRefCounted<ProgressiveCodec>(
+      progress_callback, progress_callback_handle,
+      fml::TimeDelta::FromMilliseconds(std::max(0, min_publish_interval_ms)));
+  codec->AddRef();
+  return codec.get();
+}
+
+UIWIDGETS_API(void) ProgressiveCodec_dispose(ProgressiveCodec* ptr) {
+  // A decode in flight may outlive the managed codec. Once this returns, the
+  // progress callback handle is not used any more.
+  ptr->clearProgressCallback();
+  ptr->Release();
+}
+
+UIWIDGETS_API(const char*)
+ProgressiveCodec_addChunk(ProgressiveCodec* ptr, uint8_t* data,
+                          int data_length, bool is_last) {
+  return ptr->addChunk(data, std::max(0, data_length), is_last);
+}
+
+}  // namespace uiwidgets
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "codec.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_delta.h"
+#include "frame_info.h"
+#include "image_decoder.h"
+
+namespace uiwidgets {
+
+// A single frame codec for an image whose encoded data arrives in chunks,
+// e.g. while it is downloaded. Each chunk is decoded on a worker as it
+// arrives, continuing from where the previous one stopped if the format
+// supports incremental decoding (PNG, GIF), and the rows decoded so far are
+// published to the progress callback at most once per
+// |min_publish_interval|. getNextFrame completes with the whole image once
+// the last chunk has been decoded.
+//
+// The image is decoded into a single bitmap. Partial frames are uploaded from
+// it, and the final frame takes it over.
+class ProgressiveCodec : public Codec {
+ public:
+  ProgressiveCodec(GetNextFrameCallback progress_callback,
+                   Mono_Handle progress_callback_handle,
+                   fml::TimeDelta min_publish_interval);
+
+  ~ProgressiveCodec() override;
+
+  // |Codec|
+  int frameCount() const override;
+
+  // |Codec|
+  int repetitionCount() const override;
+
+  // |Codec|
+  const char* getNextFrame(GetNextFrameCallback callback,
+                           Mono_Handle callback_handle) override;
+
+  size_t GetAllocationSize() override;
+
+  // Appends the next |length| bytes of the encoded image. |is_last| marks the
+  // end of the data, after which no more chunks may be added.
+  const char* addChunk(const uint8_t* data, size_t length, bool is_last);
+
+  // Stops invoking the progress callback. Callable from any thread. Returns
+  // once a progress callback running on the UI thread has returned, so that
+  // its handle can be freed right after.
+  void clearProgressCallback();
+
+  class ChunkBuffer;
+  class DecodeState;
+
+ private:
+  enum class Status { kNew, kInProgress, kComplete };
+  Status status_;
+  std::shared_ptr<ChunkBuffer> buffer_;
+  std::shared_ptr<DecodeState> decode_state_;
+  fml::RefPtr<FrameInfo> cached_frame_;
+
+  // Held while the progress callback runs. Recursive, as the callback may
+  // dispose of the codec.
+  std::recursive_mutex progress_mutex_;
+  PendingCallback progress_callback_;
+
+  bool decode_in_flight_ = false;
+  // The size of the buffer when the decode in flight was scheduled.
+  size_t scheduled_size_ = 0;
+  bool scheduled_complete_ = false;
+
+  std::vector<PendingCallback> pending_callbacks_;
+
+  // Decodes what has arrived since the last decode, unless a decode is in
+  // flight already. The chunks arriving meanwhile are decoded when it
+  // completes.
+  void ScheduleDecode();
+
+  void OnDecoded(SkiaGPUObject<SkImage> image);
+
+  void CompletePendingCallbacks();
+
+  FML_FRIEND_MAKE_REF_COUNTED(ProgressiveCodec);
+  FML_FRIEND_REF_COUNTED_THREAD_SAFE(ProgressiveCodec);
+};
+
+}  // namespace uiwidgets
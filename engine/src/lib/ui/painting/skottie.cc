@@ -1,11 +1,15 @@
 #include "skottie.h"
 
+#include <cmath>
+#include <utility>
+
+#include "lib/ui/painting/image_decoder.h"
 #include "lib/ui/ui_mono_state.h"
 #if __ANDROID__
 #include "shell/platform/unity/android_unpack_streaming_asset.h"
 #endif
 namespace uiwidgets {
-fml::RefPtr<Skottie> Skottie::Create(char* path) {
+fml::RefPtr<Skottie> Skottie::Create(char* path, bool cache_frames) {
 #if __ANDROID__
   std::string pthstr = std::string(path);
   int id = pthstr.find("assets/") + 7;
@@ -17,24 +21,80 @@ fml::RefPtr<Skottie> Skottie::Create(char* path) {
   if(animation_ == nullptr){
     return nullptr;
   }
-  return fml::MakeRefCounted<Skottie>(animation_);
+  return fml::MakeRefCounted<Skottie>(animation_, path, cache_frames);
 }
 
-Skottie::Skottie(sk_sp<skottie::Animation> animation) {
+Skottie::Skottie(sk_sp<skottie::Animation> animation, std::string path,
+                 bool cache_frames)
+    : path_(std::move(path)), cache_frames_(cache_frames) {
   animation_ = animation;
 }
 
+Skottie::~Skottie() {
+  if (frames_) {
+    // Kept cached for the next animation of the same file.
+    SkottieFrameCache::GetInstance().Release(frames_, false);
+  }
+}
+
 void Skottie::paint(Canvas* canvas, float x, float y, float width, float height,
-                    float frame) {
-  animation_->seekFrameTime(frame);
+                    float frame, float device_pixel_ratio) {
   SkRect rect = SkRect::MakeXYWH(x, y, width, height);
+  if (cache_frames_) {
+    if (sk_sp<SkImage> image =
+            GetCachedFrame(canvas->canvas()->getTotalMatrix(),
+                           device_pixel_ratio, width, height, frame)) {
+      SkPaint paint;
+      paint.setFilterQuality(kLow_SkFilterQuality);
+      canvas->canvas()->drawImageRect(image, rect, &paint);
+      return;
+    }
+  }
+
+  animation_->seekFrameTime(frame);
   animation_->render(canvas->canvas(), &rect);
 }
 
+sk_sp<SkImage> Skottie::GetCachedFrame(const SkMatrix& matrix,
+                                       float device_pixel_ratio, float width,
+                                       float height, float frame) {
+  // Frames are rasterized at the size they cover on the device. The matrix
+  // of the recording canvas lacks the device pixel ratio, which the root
+  // layer applies. Rotated and skewed animations are rendered as before.
+  if (!matrix.isScaleTranslate() || !std::isfinite(device_pixel_ratio) ||
+      device_pixel_ratio <= 0) {
+    return nullptr;
+  }
+  const SkISize size = SkISize::Make(
+      static_cast<int>(std::ceil(width * std::abs(matrix.getScaleX()) *
+                                 device_pixel_ratio)),
+      static_cast<int>(std::ceil(height * std::abs(matrix.getScaleY()) *
+                                 device_pixel_ratio)));
+
+  auto& cache = SkottieFrameCache::GetInstance();
+  if (frames_ && frames_->size() != size) {
+    cache.Release(frames_, true);
+    frames_.reset();
+  }
+
+  if (!frames_) {
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner;
+    if (auto decoder = UIMonoState::Current()->GetImageDecoder()) {
+      task_runner = decoder->GetConcurrentTaskRunner();
+    }
+    frames_ = cache.Acquire(path_, *animation_, size, task_runner);
+    if (!frames_) {
+      return nullptr;
+    }
+  }
+
+  return frames_->GetFrame(frame);
+}
+
 float Skottie::duration() { return animation_->duration(); }
 UIWIDGETS_API(Skottie*)
-Skottie_Construct(char* path) {
-  fml::RefPtr<Skottie> skottie = Skottie::Create(path);
+Skottie_Construct(char* path, bool cache_frames) {
+  fml::RefPtr<Skottie> skottie = Skottie::Create(path, cache_frames);
   if(skottie.get() == nullptr){
     return nullptr;
   }
@@ -52,11 +112,11 @@ Skottie_Dispose(Skottie* ptr) {
 
 UIWIDGETS_API(void)
 Skottie_Paint(Skottie* ptr, Canvas* canvas, float x, float y, float width,
-              float height, float frame) {
+              float height, float frame, float device_pixel_ratio) {
   if(ptr == nullptr){
       return;
   }
-  ptr->paint(canvas, x, y, width, height, frame);
+  ptr->paint(canvas, x, y, width, height, frame, device_pixel_ratio);
 }
 
 UIWIDGETS_API(float)
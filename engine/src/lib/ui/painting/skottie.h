@@ -1,7 +1,11 @@
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "flutter/fml/memory/ref_counted.h"
 #include "lib/ui/painting/canvas.h"
+#include "lib/ui/painting/skottie_frame_cache.h"
 #include "modules/skottie/include/Skottie.h"
 
 namespace uiwidgets {
@@ -10,17 +14,37 @@ class Skottie : public fml::RefCountedThreadSafe<Skottie> {
   FML_FRIEND_MAKE_REF_COUNTED(Skottie);
 
  public:
-  static fml::RefPtr<Skottie> Create(char* path);
+  // If |cache_frames| is set, the frames are rasterized at the size they are
+  // painted at, ahead of time on a worker, and shared with the other
+  // animations of the same file through the SkottieFrameCache. Painting a
+  // cached frame draws its image instead of rendering the animation.
+  static fml::RefPtr<Skottie> Create(char* path, bool cache_frames = false);
+
+  ~Skottie();
 
+  // |device_pixel_ratio| is the scale the root layer applies on top of the
+  // canvas, for the size cached frames are rasterized at.
   void paint(Canvas* canvas, float x, float y, float width, float height,
-             float frame);
+             float frame, float device_pixel_ratio = 1.0f);
 
   float duration();
 
  private:
-  explicit Skottie(sk_sp<skottie::Animation> animation);
+  Skottie(sk_sp<skottie::Animation> animation, std::string path,
+          bool cache_frames);
 
   sk_sp<skottie::Animation> animation_;
   bool is_null;
+
+  const std::string path_;
+  const bool cache_frames_;
+  std::shared_ptr<SkottieFrameCache::Frames> frames_;
+
+  // Returns the cached frame for |frame| painted at |width| x |height| with
+  // |matrix| and |device_pixel_ratio|, or null if it has not been rendered
+  // yet.
+  sk_sp<SkImage> GetCachedFrame(const SkMatrix& matrix,
+                                float device_pixel_ratio, float width,
+                                float height, float frame);
 };
 }  // namespace uiwidgets
@@ -0,0 +1,188 @@
+#include "skottie_frame_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "lib/ui/painting/pixel_buffer_pool.h"
+
+namespace uiwidgets {
+
+SkottieFrameCache::Frames::Frames(std::string path, const SkISize& size,
+                                  size_t frame_count, double fps)
+    : path_(std::move(path)),
+      size_(size),
+      fps_(fps),
+      byte_size_(frame_count * size.width() * size.height() * 4),
+      frames_(frame_count) {}
+
+sk_sp<SkImage> SkottieFrameCache::Frames::GetFrame(float frame_time) {
+  if (!std::isfinite(frame_time)) {
+    return nullptr;
+  }
+  const double frame = std::floor(frame_time * fps_);
+  const auto index = static_cast<size_t>(
+      std::clamp<double>(frame, 0, frames_.size() - 1));
+
+  std::scoped_lock lock(mutex_);
+  if (!frames_[index]) {
+    // Renders the frames from the one shown now, so that it is not long
+    // until they are cached.
+    next_frame_ = index;
+  }
+  return frames_[index];
+}
+
+void SkottieFrameCache::Frames::Render(std::weak_ptr<Frames> weak_frames) {
+  sk_sp<skottie::Animation> animation;
+  while (auto frames = weak_frames.lock()) {
+    size_t index;
+    {
+      std::scoped_lock lock(frames->mutex_);
+      if (frames->rendered_count_ == frames->frames_.size() ||
+          frames->users_ == 0) {
+        frames->rendering_ = false;
+        return;
+      }
+      index = frames->next_frame_;
+      while (frames->frames_[index]) {
+        index = (index + 1) % frames->frames_.size();
+      }
+      frames->next_frame_ = (index + 1) % frames->frames_.size();
+    }
+
+    TRACE_EVENT0("uiwidgets", "SkottieFrameCache::Frames::Render");
+
+    // Seeking an animation is not thread-safe, so the worker renders with an
+    // animation of its own.
+    if (!animation) {
+      animation = skottie::Animation::MakeFromFile(frames->path_.c_str());
+    }
+
+    SkBitmap bitmap;
+    if (!animation ||
+        !PixelBufferPool::GetInstance().TryAllocPixels(
+            &bitmap, SkImageInfo::MakeN32Premul(frames->size_))) {
+      FML_LOG(ERROR) << "Could not render the frames of " << frames->path_;
+      std::scoped_lock lock(frames->mutex_);
+      frames->rendering_ = false;
+      return;
+    }
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    {
+      SkCanvas canvas(bitmap);
+      const SkRect rect = SkRect::Make(frames->size_);
+      animation->seekFrame(index);
+      animation->render(&canvas, &rect);
+    }
+
+    // Marking this as immutable makes the MakeFromBitmap call share the
+    // pixels instead of copying.
+    bitmap.setImmutable();
+    sk_sp<SkImage> image = SkImage::MakeFromBitmap(bitmap);
+
+    std::scoped_lock lock(frames->mutex_);
+    frames->frames_[index] = std::move(image);
+    frames->rendered_count_++;
+  }
+}
+
+SkottieFrameCache& SkottieFrameCache::GetInstance() {
+  // Never destroyed, the workers may still be rendering during shutdown.
+  static SkottieFrameCache* cache = new SkottieFrameCache(kDefaultMaxBytes);
+  return *cache;
+}
+
+SkottieFrameCache::SkottieFrameCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+SkottieFrameCache::~SkottieFrameCache() = default;
+
+std::shared_ptr<SkottieFrameCache::Frames> SkottieFrameCache::Acquire(
+    const std::string& path,
+    const skottie::Animation& animation,
+    const SkISize& size,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner) {
+  if (!task_runner || size.isEmpty() || animation.fps() <= 0) {
+    return nullptr;
+  }
+
+  std::shared_ptr<Frames> frames;
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = std::find_if(entries_.begin(), entries_.end(),
+                              [&path, &size](const auto& entry) {
+                                return entry->path_ == path &&
+                                       entry->size_ == size;
+                              });
+    if (found != entries_.end()) {
+      frames = *found;
+      entries_.splice(entries_.begin(), entries_, found);
+    } else {
+      const size_t frame_count = std::max<size_t>(
+          1, std::ceil(animation.duration() * animation.fps()));
+      if (frame_count * size.width() * size.height() * 4 > kMaxFramesBytes) {
+        return nullptr;
+      }
+      frames = std::make_shared<Frames>(path, size, frame_count,
+                                        animation.fps());
+      entries_.push_front(frames);
+      byte_size_ += frames->byte_size();
+    }
+    frames->users_++;
+    EvictLocked();
+  }
+
+  std::scoped_lock lock(frames->mutex_);
+  if (!frames->rendering_ &&
+      frames->rendered_count_ < frames->frames_.size()) {
+    frames->rendering_ = true;
+    task_runner->PostTask([weak_frames = std::weak_ptr<Frames>(frames)]() {
+      Frames::Render(weak_frames);
+    });
+  }
+  return frames;
+}
+
+void SkottieFrameCache::Release(const std::shared_ptr<Frames>& frames,
+                                bool drop) {
+  std::scoped_lock lock(mutex_);
+  if (--frames->users_ > 0 || !drop) {
+    return;
+  }
+  auto found = std::find(entries_.begin(), entries_.end(), frames);
+  if (found != entries_.end()) {
+    byte_size_ -= frames->byte_size();
+    entries_.erase(found);
+  }
+}
+
+void SkottieFrameCache::Purge() {
+  TRACE_EVENT0("uiwidgets", "SkottieFrameCache::Purge");
+  std::scoped_lock lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if ((*it)->users_ == 0) {
+      byte_size_ -= (*it)->byte_size();
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SkottieFrameCache::EvictLocked() {
+  auto it = entries_.end();
+  while (byte_size_ > max_bytes_ && it != entries_.begin()) {
+    --it;
+    if ((*it)->users_ == 0) {
+      byte_size_ -= (*it)->byte_size();
+      it = entries_.erase(it);
+    }
+  }
+}
+
+}  // namespace uiwidgets
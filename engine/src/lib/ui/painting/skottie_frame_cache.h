@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkSize.h"
+#include "modules/skottie/include/Skottie.h"
+
+namespace uiwidgets {
+
+// Frames of Skottie animations rasterized at the size they are displayed at,
+// shared by all animations loaded from the same file. The frames of a file
+// and size are rendered on a worker, one after the other, starting with the
+// first frame asked for. The frames nobody uses are dropped, least recently
+// used first, once the cache grows beyond its budget. Thread-safe, one per
+// process.
+class SkottieFrameCache {
+ public:
+  // Animations whose frames take more bytes are not cached.
+  static constexpr size_t kMaxFramesBytes = 16 * 1024 * 1024;
+
+  static constexpr size_t kDefaultMaxBytes = 48 * 1024 * 1024;
+
+  // The frames of one file at one size.
+  class Frames {
+   public:
+    Frames(std::string path, const SkISize& size, size_t frame_count,
+           double fps);
+
+    const SkISize& size() const { return size_; }
+
+    // Returns the frame shown at |frame_time| seconds, or null if it has not
+    // been rendered yet or |frame_time| is not finite.
+    sk_sp<SkImage> GetFrame(float frame_time);
+
+    size_t byte_size() const { return byte_size_; }
+
+   private:
+    friend class SkottieFrameCache;
+
+    const std::string path_;
+    const SkISize size_;
+    const double fps_;
+    const size_t byte_size_;
+
+    std::mutex mutex_;
+    std::vector<sk_sp<SkImage>> frames_;
+    size_t rendered_count_ = 0;
+    // The frame the worker should render next if it is not rendered yet.
+    size_t next_frame_ = 0;
+    bool rendering_ = false;
+
+    // The number of animations using these frames.
+    std::atomic<size_t> users_{0};
+
+    // Renders the missing frames on the calling thread until all are
+    // rendered or nobody uses them any more.
+    static void Render(std::weak_ptr<Frames> weak_frames);
+
+    FML_DISALLOW_COPY_AND_ASSIGN(Frames);
+  };
+
+  static SkottieFrameCache& GetInstance();
+
+  // Returns the frames of |animation|, loaded from |path|, at |size| and
+  // starts rendering them on |task_runner| if needed. Returns null if they
+  // would not fit into the cache. Every call must be balanced by a call to
+  // Release.
+  std::shared_ptr<Frames> Acquire(
+      const std::string& path,
+      const skottie::Animation& animation,
+      const SkISize& size,
+      const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner);
+
+  // Balances Acquire. If |drop| is set, the frames are dropped right away
+  // once nobody uses them, e.g. because the size they are displayed at has
+  // changed.
+  void Release(const std::shared_ptr<Frames>& frames, bool drop);
+
+  // Drops all frames nobody uses.
+  void Purge();
+
+ private:
+  mutable std::mutex mutex_;
+  const size_t max_bytes_;
+  // Most recently used first.
+  std::list<std::shared_ptr<Frames>> entries_;
+  size_t byte_size_ = 0;
+
+  explicit SkottieFrameCache(size_t max_bytes);
+
+  ~SkottieFrameCache();
+
+  // Drops the least recently used frames nobody uses until the cache fits
+  // into its budget.
+  void EvictLocked();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(SkottieFrameCache);
+};
+
+}  // namespace uiwidgets
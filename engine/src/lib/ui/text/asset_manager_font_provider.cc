@@ -1,6 +1,9 @@
 #include "asset_manager_font_provider.h"
 
+#include <algorithm>
+
 #include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
 #include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
@@ -14,6 +17,68 @@ void MappingReleaseProc(const void* ptr, void* context) {
   delete reinterpret_cast<fml::Mapping*>(context);
 }
 
+uint16_t ReadU16(const uint8_t* data) { return (data[0] << 8) | data[1]; }
+
+uint32_t ReadU32(const uint8_t* data) {
+  return (static_cast<uint32_t>(ReadU16(data)) << 16) | ReadU16(data + 2);
+}
+
+// Reads the style of a single font file from its OS/2 table. Only the few
+// pages holding the table directory and the table itself are touched.
+bool ReadFontStyle(const fml::Mapping& mapping, SkFontStyle* style) {
+  const uint8_t* data = mapping.GetMapping();
+  const size_t size = mapping.GetSize();
+  const size_t kTableDirectorySize = 12;
+  const size_t kTableRecordSize = 16;
+  if (data == nullptr || size < kTableDirectorySize) {
+    return false;
+  }
+
+  // Collections and other containers are left to Skia.
+  const uint32_t version = ReadU32(data);
+  if (version != 0x00010000 && version != 0x4F54544F /* OTTO */ &&
+      version != 0x74727565 /* true */) {
+    return false;
+  }
+
+  const size_t table_count = ReadU16(data + 4);
+  if (size < kTableDirectorySize + table_count * kTableRecordSize) {
+    return false;
+  }
+
+  for (size_t i = 0; i < table_count; i++) {
+    const uint8_t* record =
+        data + kTableDirectorySize + i * kTableRecordSize;
+    if (ReadU32(record) != 0x4F532F32 /* OS/2 */) {
+      continue;
+    }
+    const size_t kMinTableSize = 64;
+    const size_t offset = ReadU32(record + 8);
+    const size_t length = ReadU32(record + 12);
+    if (length < kMinTableSize || offset > size ||
+        size - offset < kMinTableSize) {
+      return false;
+    }
+
+    const uint8_t* table = data + offset;
+    const int weight = ReadU16(table + 4);
+    const int width = ReadU16(table + 6);
+    const uint16_t selection = ReadU16(table + 62);
+    if (weight == 0 || width == 0) {
+      return false;
+    }
+    SkFontStyle::Slant slant = SkFontStyle::kUpright_Slant;
+    if (selection & (1 << 0)) {
+      slant = SkFontStyle::kItalic_Slant;
+    } else if (selection & (1 << 9)) {
+      slant = SkFontStyle::kOblique_Slant;
+    }
+    *style = SkFontStyle(weight, std::min(width, 9), slant);
+    return true;
+  }
+  return false;
+}
+
 }  // anonymous namespace
 
 AssetManagerFontProvider::AssetManagerFontProvider(
@@ -44,6 +109,12 @@ SkFontStyleSet* AssetManagerFontProvider::MatchFamily(
   return font_style_set.release();
 }
 
+void AssetManagerFontProvider::PurgeUnusedTypefaces() {
+  for (auto& family : registered_families_) {
+    family.second->purgeUnusedTypefaces();
+  }
+}
+
 void AssetManagerFontProvider::RegisterAsset(std::string family_name,
                                              std::string asset) {
   std::string canonical_name = CanonicalFamilyName(family_name);
@@ -67,18 +138,39 @@ AssetManagerFontStyleSet::AssetManagerFontStyleSet(
 AssetManagerFontStyleSet::~AssetManagerFontStyleSet() = default;
 
 void AssetManagerFontStyleSet::registerAsset(std::string asset) {
+  std::scoped_lock lock(mutex_);
   assets_.emplace_back(asset);
 }
 
-int AssetManagerFontStyleSet::count() { return assets_.size(); }
+int AssetManagerFontStyleSet::count() {
+  std::scoped_lock lock(mutex_);
+  return assets_.size();
+}
 
 void AssetManagerFontStyleSet::getStyle(int index, SkFontStyle* style,
                                         SkString* name) {
+  std::scoped_lock lock(mutex_);
   FML_DCHECK(index < static_cast<int>(assets_.size()));
   if (style) {
-    sk_sp<SkTypeface> typeface(createTypeface(index));
-    if (typeface) {
-      *style = typeface->fontStyle();
+    // Matching a style asks for the style of every face in the family, so
+    // it is read from the asset rather than by creating each typeface.
+    TypefaceAsset& asset = assets_[index];
+    if (!asset.has_style && !asset.typeface) {
+      std::unique_ptr<fml::Mapping> asset_mapping =
+          asset_manager_->GetAsMapping(asset.asset);
+      if (asset_mapping != nullptr) {
+        asset.has_style = ReadFontStyle(*asset_mapping, &asset.style);
+      }
+    }
+    if (!asset.has_style) {
+      sk_sp<SkTypeface> typeface = CreateTypefaceLocked(index);
+      if (typeface) {
+        asset.style = typeface->fontStyle();
+        asset.has_style = true;
+      }
+    }
+    if (asset.has_style) {
+      *style = asset.style;
     }
   }
   if (name) {
@@ -87,11 +179,17 @@ void AssetManagerFontStyleSet::getStyle(int index, SkFontStyle* style,
 }
 
 SkTypeface* AssetManagerFontStyleSet::createTypeface(int i) {
-  size_t index = i;
+  std::scoped_lock lock(mutex_);
+  return CreateTypefaceLocked(i).release();
+}
+
+sk_sp<SkTypeface> AssetManagerFontStyleSet::CreateTypefaceLocked(
+    size_t index) {
   if (index >= assets_.size()) return nullptr;
 
   TypefaceAsset& asset = assets_[index];
   if (!asset.typeface) {
+    TRACE_EVENT0("uiwidgets", "AssetManagerFontStyleSet::createTypeface");
     std::unique_ptr<fml::Mapping> asset_mapping =
         asset_manager_->GetAsMapping(asset.asset);
     if (asset_mapping == nullptr) {
@@ -109,13 +207,22 @@ SkTypeface* AssetManagerFontStyleSet::createTypeface(int i) {
     if (!asset.typeface) return nullptr;
   }
 
-  return SkRef(asset.typeface.get());
+  return asset.typeface;
 }
 
 SkTypeface* AssetManagerFontStyleSet::matchStyle(const SkFontStyle& pattern) {
   return matchStyleCSS3(pattern);
 }
 
+void AssetManagerFontStyleSet::purgeUnusedTypefaces() {
+  std::scoped_lock lock(mutex_);
+  for (TypefaceAsset& asset : assets_) {
+    if (asset.typeface && asset.typeface->unique()) {
+      asset.typeface.reset();
+    }
+  }
+}
+
 AssetManagerFontStyleSet::TypefaceAsset::TypefaceAsset(std::string a)
     : asset(std::move(a)) {}
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -13,6 +14,8 @@
 
 namespace uiwidgets {
 
+// Creates the typefaces of a family lazily from its assets. Thread-safe, as
+// paragraphs may be laid out on workers.
 class AssetManagerFontStyleSet : public SkFontStyleSet {
  public:
   AssetManagerFontStyleSet(std::shared_ptr<AssetManager> asset_manager,
@@ -34,6 +37,10 @@ class AssetManagerFontStyleSet : public SkFontStyleSet {
   // |SkFontStyleSet|
   SkTypeface* matchStyle(const SkFontStyle& pattern) override;
 
+  // Drops the typefaces that nothing else holds on to. They are created
+  // again from their assets when they are next matched.
+  void purgeUnusedTypefaces();
+
  private:
   std::shared_ptr<AssetManager> asset_manager_;
   std::string family_name_;
@@ -47,9 +54,14 @@ class AssetManagerFontStyleSet : public SkFontStyleSet {
 
     std::string asset;
     sk_sp<SkTypeface> typeface;
+    bool has_style = false;
+    SkFontStyle style;
   };
+  std::mutex mutex_;
   std::vector<TypefaceAsset> assets_;
 
+  sk_sp<SkTypeface> CreateTypefaceLocked(size_t index);
+
   FML_DISALLOW_COPY_AND_ASSIGN(AssetManagerFontStyleSet);
 };
 
@@ -70,6 +82,8 @@ class AssetManagerFontProvider : public txt::FontAssetProvider {
   // |FontAssetProvider|
   SkFontStyleSet* MatchFamily(const std::string& family_name) override;
 
+  void PurgeUnusedTypefaces();
+
  private:
   std::shared_ptr<AssetManager> asset_manager_;
   std::unordered_map<std::string, sk_sp<AssetManagerFontStyleSet>>
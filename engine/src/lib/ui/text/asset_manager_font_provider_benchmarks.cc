@@ -0,0 +1,147 @@
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "assets/asset_manager.h"
+#include "assets/directory_asset_bundle.h"
+#include "benchmarking/benchmarking.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/time/time_point.h"
+#include "include/core/SkData.h"
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkTypeface.h"
+#include "lib/ui/text/asset_manager_font_provider.h"
+
+namespace uiwidgets {
+
+namespace {
+
+constexpr char kFamilyName[] = "Benchmark";
+
+enum class LoadMode {
+  // Reads the styles from the mapped assets and creates the matched typeface
+  // only, as AssetManagerFontProvider does.
+  kLazy = 0,
+  // Creates a typeface for every face of the family before matching, as
+  // getStyle used to.
+  kEager = 1,
+  // Copies every font file into memory and creates its typeface, as fonts
+  // loaded from a list are.
+  kCopy = 2,
+};
+
+bool IsFontFile(const std::string& name) {
+  for (const char* extension : {".ttf", ".otf", ".ttc"}) {
+    const size_t length = strlen(extension);
+    if (name.size() > length &&
+        name.compare(name.size() - length, length, extension) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Everything the first match of a family keeps alive.
+struct LoadedFonts {
+  std::unique_ptr<AssetManagerFontProvider> provider;
+  std::vector<sk_sp<SkTypeface>> typefaces;
+};
+
+LoadedFonts LoadFonts(const std::shared_ptr<AssetManager>& asset_manager,
+                      const std::vector<std::string>& assets, LoadMode mode) {
+  LoadedFonts fonts;
+  if (mode == LoadMode::kCopy) {
+    for (const auto& asset : assets) {
+      std::unique_ptr<fml::Mapping> mapping =
+          asset_manager->GetAsMapping(asset);
+      if (mapping) {
+        fonts.typefaces.push_back(SkTypeface::MakeFromData(
+            SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize())));
+      }
+    }
+    return fonts;
+  }
+
+  fonts.provider = std::make_unique<AssetManagerFontProvider>(asset_manager);
+  for (const auto& asset : assets) {
+    fonts.provider->RegisterAsset(kFamilyName, asset);
+  }
+  sk_sp<SkFontStyleSet> style_set(fonts.provider->MatchFamily(kFamilyName));
+  if (mode == LoadMode::kEager) {
+    for (int i = 0; i < style_set->count(); i++) {
+      fonts.typefaces.push_back(
+          sk_sp<SkTypeface>(style_set->createTypeface(i)));
+    }
+  }
+  fonts.typefaces.push_back(
+      sk_sp<SkTypeface>(style_set->matchStyle(SkFontStyle::Normal())));
+  return fonts;
+}
+
+}  // namespace
+
+// Registers every font file in --font_dir as the faces of one family and
+// matches its normal style, which is what the first frame with text waits
+// for. |range(0)| is a LoadMode, so that the lazy loading can be compared
+// with creating or copying every face. rss_bytes is how much the resident
+// set grew for the first load, font_bytes the size of the font files.
+// Families with many large faces, such as CJK fonts, show the difference.
+static void BM_FontFamilyFirstMatch(benchmark::State& state) {
+  const std::string font_dir = benchmark::GetFlag("font_dir");
+  if (font_dir.empty()) {
+    state.SkipWithError("No --font_dir was given.");
+    return;
+  }
+  fml::UniqueFD directory =
+      fml::OpenDirectory(font_dir.c_str(), false, fml::FilePermission::kRead);
+  if (!directory.is_valid()) {
+    state.SkipWithError("Could not open --font_dir.");
+    return;
+  }
+
+  std::vector<std::string> assets;
+  fml::VisitFiles(directory, [&assets](const fml::UniqueFD&,
+                                       const std::string& filename) {
+    if (IsFontFile(filename)) {
+      assets.push_back(filename);
+    }
+    return true;
+  });
+  if (assets.empty()) {
+    state.SkipWithError("--font_dir has no font files.");
+    return;
+  }
+
+  auto asset_manager = std::make_shared<AssetManager>();
+  asset_manager->PushBack(
+      std::make_unique<DirectoryAssetBundle>(std::move(directory)));
+  size_t font_bytes = 0;
+  for (const auto& asset : assets) {
+    std::unique_ptr<fml::Mapping> mapping = asset_manager->GetAsMapping(asset);
+    font_bytes += mapping ? mapping->GetSize() : 0;
+  }
+
+  const auto mode = static_cast<LoadMode>(state.range(0));
+  {
+    const size_t resident_bytes = benchmark::ResidentBytes();
+    const fml::TimePoint start = fml::TimePoint::Now();
+    LoadedFonts fonts = LoadFonts(asset_manager, assets, mode);
+    const fml::TimeDelta first_match = fml::TimePoint::Now() - start;
+    state.counters["first_match_us"] = first_match.ToMicrosecondsF();
+    state.counters["rss_bytes"] =
+        static_cast<double>(benchmark::ResidentBytes()) - resident_bytes;
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LoadFonts(asset_manager, assets, mode));
+  }
+  state.SetItemsProcessed(state.iterations() * assets.size());
+  state.counters["font_bytes"] = font_bytes;
+}
+BENCHMARK(BM_FontFamilyFirstMatch)
+    ->Arg(static_cast<int64_t>(LoadMode::kLazy))
+    ->Arg(static_cast<int64_t>(LoadMode::kEager))
+    ->Arg(static_cast<int64_t>(LoadMode::kCopy));
+
+}  // namespace uiwidgets
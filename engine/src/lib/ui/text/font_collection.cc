@@ -1,7 +1,9 @@
 #include "font_collection.h"
 
+#include <algorithm>
 #include <mutex>
 
+#include "flutter/fml/trace_event.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkStream.h"
@@ -9,7 +11,9 @@
 #include "asset_manager_font_provider.h"
 #include "lib/ui/ui_mono_state.h"
 #include "lib/ui/window/window.h"
+#include "minikin/Layout.h"
 #include "txt/asset_font_manager.h"
+#include "txt/platform.h"
 #include "txt/test_font_manager.h"
 
 namespace uiwidgets {
@@ -28,13 +32,74 @@ Font_LoadFontFromList(uint8_t* font_data, int size,
 
 }  // namespace
 
+WorkerFontCollections::WorkerFontCollections() = default;
+
+WorkerFontCollections::~WorkerFontCollections() = default;
+
+std::shared_ptr<txt::FontCollection> WorkerFontCollections::Acquire() {
+  std::scoped_lock lock(mutex_);
+  if (!idle_collections_.empty()) {
+    auto collection = std::move(idle_collections_.back());
+    idle_collections_.pop_back();
+    return collection;
+  }
+
+  auto collection = std::make_shared<txt::FontCollection>();
+  if (default_font_manager_) {
+    collection->SetDefaultFontManager(default_font_manager_);
+  }
+  if (asset_font_manager_) {
+    collection->SetAssetFontManager(asset_font_manager_);
+  }
+  if (dynamic_font_manager_) {
+    collection->SetDynamicFontManager(dynamic_font_manager_);
+  }
+  current_collections_.push_back(collection.get());
+  return collection;
+}
+
+void WorkerFontCollections::Release(
+    std::shared_ptr<txt::FontCollection> collection) {
+  std::scoped_lock lock(mutex_);
+  if (std::find(current_collections_.begin(), current_collections_.end(),
+                collection.get()) != current_collections_.end()) {
+    idle_collections_.push_back(std::move(collection));
+  }
+}
+
+void WorkerFontCollections::SetFontManagers(
+    sk_sp<SkFontMgr> default_font_manager,
+    sk_sp<SkFontMgr> asset_font_manager,
+    sk_sp<SkFontMgr> dynamic_font_manager) {
+  std::scoped_lock lock(mutex_);
+  default_font_manager_ = std::move(default_font_manager);
+  asset_font_manager_ = std::move(asset_font_manager);
+  dynamic_font_manager_ = std::move(dynamic_font_manager);
+  idle_collections_.clear();
+  current_collections_.clear();
+}
+
+void WorkerFontCollections::Clear() {
+  std::scoped_lock lock(mutex_);
+  for (const auto& collection : idle_collections_) {
+    current_collections_.erase(std::find(current_collections_.begin(),
+                                         current_collections_.end(),
+                                         collection.get()));
+  }
+  idle_collections_.clear();
+}
+
 FontCollection::FontCollection()
-    : collection_(std::make_shared<txt::FontCollection>()) {
+    : collection_(std::make_shared<txt::FontCollection>()),
+      worker_collections_(std::make_shared<WorkerFontCollections>()) {
   dynamic_font_manager_ = sk_make_sp<txt::DynamicFontManager>();
   collection_->SetDynamicFontManager(dynamic_font_manager_);
 }
 
 FontCollection::~FontCollection() {
+  if (fallback_index_) {
+    fallback_index_->Save();
+  }
   collection_.reset();
   SkGraphics::PurgeFontCache();
 }
@@ -44,7 +109,15 @@ std::shared_ptr<txt::FontCollection> FontCollection::GetFontCollection() const {
 }
 
 void FontCollection::SetupDefaultFontManager() {
-  collection_->SetupDefaultFontManager();
+  // The platform fonts do not change while running, so the index is kept
+  // when the font manager is set up again.
+  if (!fallback_index_) {
+    fallback_index_ =
+        sk_make_sp<FontFallbackIndex>(txt::GetDefaultFontManager());
+    fallback_index_->Load();
+  }
+  collection_->SetDefaultFontManager(fallback_index_);
+  OnFontsChanged();
 }
 
 void FontCollection::RegisterFonts(
@@ -75,6 +148,7 @@ void FontCollection::RegisterFonts(
 void FontCollection::RegisterFonts(
     std::shared_ptr<AssetManager> asset_manager, rapidjson::Value::Array fonts) {
   
+  TRACE_EVENT0("uiwidgets", "FontCollection::RegisterFonts");
   auto font_provider =
       std::make_unique<AssetManagerFontProvider>(asset_manager);
 
@@ -106,8 +180,11 @@ void FontCollection::RegisterFonts(
     }
   }
 
-  collection_->SetAssetFontManager(
-      sk_make_sp<txt::AssetFontManager>(std::move(font_provider)));
+  asset_font_provider_ = font_provider.get();
+  asset_font_manager_ =
+      sk_make_sp<txt::AssetFontManager>(std::move(font_provider));
+  collection_->SetAssetFontManager(asset_font_manager_);
+  OnFontsChanged();
 }
 
 void FontCollection::LoadFontFromList(const uint8_t* font_data, int length,
@@ -124,6 +201,31 @@ void FontCollection::LoadFontFromList(const uint8_t* font_data, int length,
     font_provider.RegisterTypeface(typeface, family_name);
   }
   collection_->ClearFontFamilyCache();
+  OnFontsChanged();
+}
+
+void FontCollection::PurgeUnusedTypefaces() {
+  TRACE_EVENT0("uiwidgets", "FontCollection::PurgeUnusedTypefaces");
+  // The font collections hold on to every typeface they resolved, and so do
+  // the paragraphs laid out with them. Moving to the next generation makes
+  // the layout cache drop its paragraphs as well.
+  collection_->ClearFontFamilyCache();
+  worker_collections_->Clear();
+  OnFontsChanged();
+  if (asset_font_provider_) {
+    asset_font_provider_->PurgeUnusedTypefaces();
+  }
+  SkGraphics::PurgeFontCache();
+}
+
+void FontCollection::OnFontsChanged() {
+  generation_++;
+  // Minikin caches shaped words per font collection. The collections that
+  // were just replaced are never looked up again, so their words would only
+  // take up room in the cache until they are evicted.
+  minikin::Layout::purgeCaches();
+  worker_collections_->SetFontManagers(fallback_index_, asset_font_manager_,
+                                       dynamic_font_manager_);
 }
 
 }  // namespace uiwidgets
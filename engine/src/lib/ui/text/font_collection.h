@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "assets/asset_manager.h"
@@ -9,9 +10,52 @@
 #include "txt/font_collection.h"
 #include "rapidjson/document.h"
 #include "rapidjson/rapidjson.h"
+#include "font_fallback_index.h"
+#include "text_style_table.h"
 
 namespace uiwidgets {
 
+class AssetManagerFontProvider;
+
+// Font collections for laying out paragraphs on workers. txt::FontCollection
+// caches the families it resolves without locking, so every worker takes a
+// collection of its own. They share the font managers of the main
+// collection. Thread-safe, and shared with the workers, which may run after
+// the FontCollection is gone.
+class WorkerFontCollections {
+ public:
+  WorkerFontCollections();
+
+  ~WorkerFontCollections();
+
+  // Returns an idle collection, or a new one if there is none. Every call
+  // must be balanced by a call to Release.
+  std::shared_ptr<txt::FontCollection> Acquire();
+
+  void Release(std::shared_ptr<txt::FontCollection> collection);
+
+  // Drops the idle collections and makes the ones in use be dropped once
+  // they are released. Collections made afterwards use these font managers.
+  void SetFontManagers(sk_sp<SkFontMgr> default_font_manager,
+                       sk_sp<SkFontMgr> asset_font_manager,
+                       sk_sp<SkFontMgr> dynamic_font_manager);
+
+  // Drops the idle collections, so that the typefaces only they hold on to
+  // can be purged.
+  void Clear();
+
+ private:
+  std::mutex mutex_;
+  sk_sp<SkFontMgr> default_font_manager_;
+  sk_sp<SkFontMgr> asset_font_manager_;
+  sk_sp<SkFontMgr> dynamic_font_manager_;
+  std::vector<std::shared_ptr<txt::FontCollection>> idle_collections_;
+  // The collections made with the current font managers.
+  std::vector<txt::FontCollection*> current_collections_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(WorkerFontCollections);
+};
+
 class FontCollection {
  public:
   FontCollection();
@@ -28,9 +72,37 @@ class FontCollection {
   void LoadFontFromList(const uint8_t* font_data, int length,
                         std::string family_name);
 
+  // Changes whenever fonts are added, so that layouts made with the previous
+  // fonts can be told apart.
+  size_t generation() const { return generation_; }
+
+  TextStyleTable& text_style_table() { return text_style_table_; }
+
+  const std::shared_ptr<WorkerFontCollections>& worker_collections() const {
+    return worker_collections_;
+  }
+
+  // Releases the asset typefaces and glyph caches that are not in use. Clears
+  // the font family caches first, so typefaces only held by them are
+  // released too, and moves to the next generation.
+  void PurgeUnusedTypefaces();
+
  private:
   std::shared_ptr<txt::FontCollection> collection_;
   sk_sp<txt::DynamicFontManager> dynamic_font_manager_;
+  // Wraps the platform font manager once it is set up.
+  sk_sp<FontFallbackIndex> fallback_index_;
+  sk_sp<SkFontMgr> asset_font_manager_;
+  // Owned by |asset_font_manager_|.
+  AssetManagerFontProvider* asset_font_provider_ = nullptr;
+  std::shared_ptr<WorkerFontCollections> worker_collections_;
+  size_t generation_ = 0;
+  TextStyleTable text_style_table_;
+
+  // Moves to the next generation, drops the shaped words that minikin cached
+  // for the font collections the new fonts replace and hands the font
+  // managers to the worker collections.
+  void OnFontsChanged();
 
   FML_DISALLOW_COPY_AND_ASSIGN(FontCollection);
 };
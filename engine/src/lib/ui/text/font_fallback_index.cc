@@ -0,0 +1,545 @@
+#include "font_fallback_index.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "shell/common/persistent_cache.h"
+
+namespace uiwidgets {
+
+namespace {
+
+const char kIndexFileName[] = "font_fallback_index";
+const uint32_t kIndexMagic = 0x55574649;  // UWFI
+const uint32_t kIndexVersion = 1;
+
+const SkFontTableTag kCmapTag = SkSetFourByteTag('c', 'm', 'a', 'p');
+
+uint16_t ReadU16(const uint8_t* data) { return (data[0] << 8) | data[1]; }
+
+uint32_t ReadU32(const uint8_t* data) {
+  return (static_cast<uint32_t>(ReadU16(data)) << 16) | ReadU16(data + 2);
+}
+
+// The index file is only ever read on the machine that wrote it, so values
+// are stored in native byte order.
+class IndexWriter {
+ public:
+  void WriteU32(uint32_t value) { stream_.write32(value); }
+
+  void WriteString(const std::string& value) {
+    WriteU32(value.size());
+    stream_.write(value.data(), value.size());
+  }
+
+  sk_sp<SkData> Finish() { return stream_.detachAsData(); }
+
+ private:
+  SkDynamicMemoryWStream stream_;
+};
+
+class IndexReader {
+ public:
+  explicit IndexReader(const SkData& data)
+      : data_(data.bytes()), size_(data.size()) {}
+
+  bool ReadU32(uint32_t* value) {
+    if (size_ - position_ < sizeof(uint32_t)) {
+      return false;
+    }
+    memcpy(value, data_ + position_, sizeof(uint32_t));
+    position_ += sizeof(uint32_t);
+    return true;
+  }
+
+  bool ReadString(std::string* value) {
+    uint32_t length;
+    if (!ReadU32(&length) || size_ - position_ < length) {
+      return false;
+    }
+    value->assign(reinterpret_cast<const char*>(data_ + position_), length);
+    position_ += length;
+    return true;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t position_ = 0;
+};
+
+}  // namespace
+
+CoverageBitmap::CoverageBitmap() = default;
+
+CoverageBitmap::~CoverageBitmap() = default;
+
+CoverageBitmap::CoverageBitmap(CoverageBitmap&& other) = default;
+
+CoverageBitmap& CoverageBitmap::operator=(CoverageBitmap&& other) = default;
+
+void CoverageBitmap::AddRange(uint32_t first, uint32_t last) {
+  last = std::min(last, kMaxCodePoint);
+  if (first > last) {
+    return;
+  }
+  if (page_index_.empty()) {
+    page_index_.resize(kPageCount, 0);
+    pages_.emplace_back();
+    pages_.back().fill(0);
+  }
+  for (uint32_t code_point = first; code_point <= last; code_point++) {
+    uint16_t& page = page_index_[code_point >> kPageShift];
+    if (page == 0) {
+      page = pages_.size();
+      pages_.emplace_back();
+      pages_.back().fill(0);
+    }
+    const uint32_t bit = code_point & (kPageSize - 1);
+    pages_[page][bit >> 6] |= uint64_t{1} << (bit & 63);
+  }
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> CoverageBitmap::GetRanges() const {
+  std::vector<std::pair<uint32_t, uint32_t>> ranges;
+  if (page_index_.empty()) {
+    return ranges;
+  }
+  for (uint32_t page = 0; page < kPageCount; page++) {
+    if (page_index_[page] == 0) {
+      continue;
+    }
+    const uint32_t page_start = page << kPageShift;
+    for (uint32_t code_point = page_start;
+         code_point < page_start + kPageSize; code_point++) {
+      if (!Contains(code_point)) {
+        continue;
+      }
+      if (!ranges.empty() && ranges.back().second + 1 == code_point) {
+        ranges.back().second = code_point;
+      } else {
+        ranges.emplace_back(code_point, code_point);
+      }
+    }
+  }
+  return ranges;
+}
+
+bool CoverageBitmap::ReadCmap(const uint8_t* cmap, size_t size) {
+  const size_t kHeaderSize = 4;
+  const size_t kRecordSize = 8;
+  if (size < kHeaderSize) {
+    return false;
+  }
+  const size_t record_count = ReadU16(cmap + 2);
+  if (size < kHeaderSize + record_count * kRecordSize) {
+    return false;
+  }
+
+  // Prefer the full repertoire of a format 12 subtable over the BMP only
+  // format 4.
+  const uint8_t* format_4 = nullptr;
+  const uint8_t* format_12 = nullptr;
+  size_t format_4_size = 0;
+  size_t format_12_size = 0;
+  for (size_t i = 0; i < record_count; i++) {
+    const uint8_t* record = cmap + kHeaderSize + i * kRecordSize;
+    const uint16_t platform = ReadU16(record);
+    const uint16_t encoding = ReadU16(record + 2);
+    const size_t offset = ReadU32(record + 4);
+    if (offset + 2 > size) {
+      continue;
+    }
+    const bool is_unicode =
+        platform == 0 ||
+        (platform == 3 && (encoding == 1 || encoding == 10));
+    if (!is_unicode) {
+      continue;
+    }
+    const uint16_t format = ReadU16(cmap + offset);
+    if (format == 12 && format_12 == nullptr) {
+      format_12 = cmap + offset;
+      format_12_size = size - offset;
+    } else if (format == 4 && format_4 == nullptr) {
+      format_4 = cmap + offset;
+      format_4_size = size - offset;
+    }
+  }
+
+  if (format_12 != nullptr && format_12_size >= 16) {
+    const size_t group_count = ReadU32(format_12 + 12);
+    if (format_12_size - 16 >= group_count * 12) {
+      for (size_t i = 0; i < group_count; i++) {
+        const uint8_t* group = format_12 + 16 + i * 12;
+        uint32_t first = ReadU32(group);
+        const uint32_t last = ReadU32(group + 4);
+        // Glyph 0 is .notdef, which does not count as a glyph.
+        if (ReadU32(group + 8) == 0) {
+          first++;
+        }
+        AddRange(first, last);
+      }
+      return true;
+    }
+  }
+
+  if (format_4 != nullptr && format_4_size >= 14) {
+    const size_t segment_count = ReadU16(format_4 + 6) / 2;
+    const size_t end_codes = 14;
+    const size_t start_codes = end_codes + segment_count * 2 + 2;
+    const size_t deltas = start_codes + segment_count * 2;
+    const size_t range_offsets = deltas + segment_count * 2;
+    if (format_4_size < range_offsets + segment_count * 2) {
+      return false;
+    }
+    for (size_t i = 0; i < segment_count; i++) {
+      const uint32_t last = ReadU16(format_4 + end_codes + i * 2);
+      const uint32_t first = ReadU16(format_4 + start_codes + i * 2);
+      const uint16_t delta = ReadU16(format_4 + deltas + i * 2);
+      const size_t range_offset_position = range_offsets + i * 2;
+      const uint16_t range_offset = ReadU16(format_4 + range_offset_position);
+      for (uint32_t code_point = first; code_point <= last; code_point++) {
+        // The final segment only maps 0xFFFF to .notdef.
+        if (code_point == 0xFFFF) {
+          break;
+        }
+        uint16_t glyph;
+        if (range_offset == 0) {
+          glyph = static_cast<uint16_t>(code_point + delta);
+        } else {
+          const size_t glyph_position = range_offset_position + range_offset +
+                                        (code_point - first) * 2;
+          if (glyph_position + 2 > format_4_size) {
+            continue;
+          }
+          glyph = ReadU16(format_4 + glyph_position);
+          if (glyph != 0) {
+            glyph = static_cast<uint16_t>(glyph + delta);
+          }
+        }
+        if (glyph != 0) {
+          Add(code_point);
+        }
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
+FontFallbackIndex::FontFallbackIndex(sk_sp<SkFontMgr> font_manager)
+    : font_manager_(std::move(font_manager)) {}
+
+FontFallbackIndex::~FontFallbackIndex() = default;
+
+bool FontFallbackIndex::Load() {
+  TRACE_EVENT0("uiwidgets", "FontFallbackIndex::Load");
+  sk_sp<SkData> data =
+      PersistentCache::GetCacheForProcess()->LoadData(kIndexFileName);
+  if (!data) {
+    return false;
+  }
+
+  IndexReader reader(*data);
+  uint32_t magic, version, face_count;
+  if (!reader.ReadU32(&magic) || magic != kIndexMagic ||
+      !reader.ReadU32(&version) || version != kIndexVersion ||
+      !reader.ReadU32(&face_count)) {
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Face>> faces;
+  for (uint32_t i = 0; i < face_count; i++) {
+    auto face = std::make_unique<Face>();
+    uint32_t weight, width, slant, cmap_size, range_count;
+    if (!reader.ReadString(&face->family_name) || !reader.ReadU32(&weight) ||
+        !reader.ReadU32(&width) || !reader.ReadU32(&slant) ||
+        !reader.ReadU32(&cmap_size) || !reader.ReadU32(&range_count)) {
+      return false;
+    }
+    face->style = SkFontStyle(weight, width,
+                              static_cast<SkFontStyle::Slant>(slant));
+    face->cmap_size = cmap_size;
+    for (uint32_t j = 0; j < range_count; j++) {
+      uint32_t first, last;
+      if (!reader.ReadU32(&first) || !reader.ReadU32(&last)) {
+        return false;
+      }
+      face->coverage.AddRange(first, last);
+    }
+    faces.push_back(std::move(face));
+  }
+
+  std::unordered_map<std::string, Fallbacks> fallbacks;
+  uint32_t key_count;
+  if (!reader.ReadU32(&key_count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < key_count; i++) {
+    std::string key;
+    uint32_t count;
+    if (!reader.ReadString(&key) || !reader.ReadU32(&count)) {
+      return false;
+    }
+    Fallbacks& entry = fallbacks[key];
+    for (uint32_t j = 0; j < count; j++) {
+      uint32_t face_index;
+      if (!reader.ReadU32(&face_index) || face_index >= faces.size()) {
+        return false;
+      }
+      entry.faces.push_back(faces[face_index].get());
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  faces_ = std::move(faces);
+  fallbacks_ = std::move(fallbacks);
+  dirty_ = false;
+  return true;
+}
+
+void FontFallbackIndex::Save() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_) {
+    return;
+  }
+  TRACE_EVENT0("uiwidgets", "FontFallbackIndex::Save");
+
+  IndexWriter writer;
+  writer.WriteU32(kIndexMagic);
+  writer.WriteU32(kIndexVersion);
+
+  std::unordered_map<const Face*, uint32_t> face_indices;
+  std::vector<const Face*> valid_faces;
+  for (const auto& face : faces_) {
+    if (face->is_valid) {
+      face_indices[face.get()] = valid_faces.size();
+      valid_faces.push_back(face.get());
+    }
+  }
+
+  writer.WriteU32(valid_faces.size());
+  for (const Face* face : valid_faces) {
+    writer.WriteString(face->family_name);
+    writer.WriteU32(face->style.weight());
+    writer.WriteU32(face->style.width());
+    writer.WriteU32(face->style.slant());
+    writer.WriteU32(face->cmap_size);
+    auto ranges = face->coverage.GetRanges();
+    writer.WriteU32(ranges.size());
+    for (const auto& range : ranges) {
+      writer.WriteU32(range.first);
+      writer.WriteU32(range.second);
+    }
+  }
+
+  // The misses are not kept, as fonts may be installed before the next
+  // launch.
+  writer.WriteU32(fallbacks_.size());
+  for (const auto& entry : fallbacks_) {
+    writer.WriteString(entry.first);
+    std::vector<uint32_t> indices;
+    for (const Face* face : entry.second.faces) {
+      auto found = face_indices.find(face);
+      if (found != face_indices.end()) {
+        indices.push_back(found->second);
+      }
+    }
+    writer.WriteU32(indices.size());
+    for (uint32_t index : indices) {
+      writer.WriteU32(index);
+    }
+  }
+
+  sk_sp<SkData> data = writer.Finish();
+  PersistentCache::GetCacheForProcess()->StoreData(kIndexFileName, *data);
+  dirty_ = false;
+}
+
+size_t FontFallbackIndex::GetTypefaceCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return faces_.size();
+}
+
+std::string FontFallbackIndex::MakeFallbacksKey(const char family_name[],
+                                                const SkFontStyle& style,
+                                                const char* bcp47[],
+                                                int bcp47_count) {
+  std::string key = family_name ? family_name : "";
+  key += '|';
+  key += std::to_string(style.weight()) + ',' +
+         std::to_string(style.width()) + ',' + std::to_string(style.slant());
+  for (int i = 0; i < bcp47_count; i++) {
+    key += '|';
+    key += bcp47[i];
+  }
+  return key;
+}
+
+sk_sp<SkTypeface> FontFallbackIndex::GetTypeface(Face& face) const {
+  if (!face.is_valid) {
+    return nullptr;
+  }
+  if (!face.typeface) {
+    face.typeface.reset(font_manager_->matchFamilyStyle(
+        face.family_name.c_str(), face.style));
+    // A different font may have been installed under the same name since
+    // the face was indexed.
+    if (!face.typeface || !(face.typeface->fontStyle() == face.style) ||
+        face.typeface->getTableSize(kCmapTag) != face.cmap_size) {
+      face.typeface = nullptr;
+      face.is_valid = false;
+      dirty_ = true;
+      return nullptr;
+    }
+  }
+  return face.typeface;
+}
+
+FontFallbackIndex::Face* FontFallbackIndex::FindOrAddFace(
+    sk_sp<SkTypeface> typeface) const {
+  SkString family_name;
+  typeface->getFamilyName(&family_name);
+  const SkFontStyle style = typeface->fontStyle();
+  for (const auto& face : faces_) {
+    if (face->is_valid && face->style == style &&
+        face->family_name == family_name.c_str()) {
+      if (!face->typeface) {
+        face->typeface = typeface;
+      }
+      return face.get();
+    }
+  }
+
+  auto face = std::make_unique<Face>();
+  face->family_name = family_name.c_str();
+  face->style = style;
+  face->typeface = typeface;
+  face->cmap_size = typeface->getTableSize(kCmapTag);
+  if (face->cmap_size > 0) {
+    std::vector<uint8_t> cmap(face->cmap_size);
+    typeface->getTableData(kCmapTag, 0, cmap.size(), cmap.data());
+    face->coverage.ReadCmap(cmap.data(), cmap.size());
+  }
+  faces_.push_back(std::move(face));
+  dirty_ = true;
+  return faces_.back().get();
+}
+
+// |SkFontMgr|
+int FontFallbackIndex::onCountFamilies() const {
+  return font_manager_->countFamilies();
+}
+
+// |SkFontMgr|
+void FontFallbackIndex::onGetFamilyName(int index,
+                                        SkString* family_name) const {
+  font_manager_->getFamilyName(index, family_name);
+}
+
+// |SkFontMgr|
+SkFontStyleSet* FontFallbackIndex::onCreateStyleSet(int index) const {
+  return font_manager_->createStyleSet(index);
+}
+
+// |SkFontMgr|
+SkFontStyleSet* FontFallbackIndex::onMatchFamily(
+    const char family_name[]) const {
+  return font_manager_->matchFamily(family_name);
+}
+
+// |SkFontMgr|
+SkTypeface* FontFallbackIndex::onMatchFamilyStyle(
+    const char family_name[],
+    const SkFontStyle& style) const {
+  return font_manager_->matchFamilyStyle(family_name, style);
+}
+
+// |SkFontMgr|
+SkTypeface* FontFallbackIndex::onMatchFamilyStyleCharacter(
+    const char family_name[],
+    const SkFontStyle& style,
+    const char* bcp47[],
+    int bcp47_count,
+    SkUnichar character) const {
+  const std::string key =
+      MakeFallbacksKey(family_name, style, bcp47, bcp47_count);
+  std::lock_guard<std::mutex> lock(mutex_);
+  Fallbacks& fallbacks = fallbacks_[key];
+
+  if (fallbacks.misses.Contains(character)) {
+    return nullptr;
+  }
+  for (Face* face : fallbacks.faces) {
+    if (face->coverage.Contains(character)) {
+      if (sk_sp<SkTypeface> typeface = GetTypeface(*face)) {
+        return typeface.release();
+      }
+    }
+  }
+
+  TRACE_EVENT0("uiwidgets", "FontFallbackIndex::MatchPlatformFallback");
+  sk_sp<SkTypeface> typeface(font_manager_->matchFamilyStyleCharacter(
+      family_name, style, bcp47, bcp47_count, character));
+  if (!typeface) {
+    fallbacks.misses.Add(character);
+    return nullptr;
+  }
+
+  Face* face = FindOrAddFace(typeface);
+  if (std::find(fallbacks.faces.begin(), fallbacks.faces.end(), face) ==
+      fallbacks.faces.end()) {
+    fallbacks.faces.push_back(face);
+    dirty_ = true;
+  }
+  // Fonts whose cmap could not be read are still used, just not indexed.
+  return typeface.release();
+}
+
+// |SkFontMgr|
+SkTypeface* FontFallbackIndex::onMatchFaceStyle(
+    const SkTypeface* typeface,
+    const SkFontStyle& style) const {
+  return font_manager_->matchFaceStyle(typeface, style);
+}
+
+// |SkFontMgr|
+sk_sp<SkTypeface> FontFallbackIndex::onMakeFromData(sk_sp<SkData> data,
+                                                    int ttc_index) const {
+  return font_manager_->makeFromData(std::move(data), ttc_index);
+}
+
+// |SkFontMgr|
+sk_sp<SkTypeface> FontFallbackIndex::onMakeFromStreamIndex(
+    std::unique_ptr<SkStreamAsset> stream,
+    int ttc_index) const {
+  return font_manager_->makeFromStream(std::move(stream), ttc_index);
+}
+
+// |SkFontMgr|
+sk_sp<SkTypeface> FontFallbackIndex::onMakeFromStreamArgs(
+    std::unique_ptr<SkStreamAsset> stream,
+    const SkFontArguments& args) const {
+  return font_manager_->makeFromStream(std::move(stream), args);
+}
+
+// |SkFontMgr|
+sk_sp<SkTypeface> FontFallbackIndex::onMakeFromFile(const char path[],
+                                                    int ttc_index) const {
+  return font_manager_->makeFromFile(path, ttc_index);
+}
+
+// |SkFontMgr|
+sk_sp<SkTypeface> FontFallbackIndex::onLegacyMakeTypeface(
+    const char family_name[],
+    SkFontStyle style) const {
+  return font_manager_->legacyMakeTypeface(family_name, style);
+}
+
+}  // namespace uiwidgets
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "include/core/SkData.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkTypeface.h"
+
+namespace uiwidgets {
+
+// The set of code points a typeface has glyphs for, split into pages of 256
+// code points so that fonts covering a few scripts stay small.
+class CoverageBitmap {
+ public:
+  CoverageBitmap();
+
+  ~CoverageBitmap();
+
+  CoverageBitmap(CoverageBitmap&& other);
+
+  CoverageBitmap& operator=(CoverageBitmap&& other);
+
+  // Adds the code points from |first| to |last|, both included.
+  void AddRange(uint32_t first, uint32_t last);
+
+  void Add(uint32_t code_point) { AddRange(code_point, code_point); }
+
+  bool Contains(uint32_t code_point) const {
+    if (code_point > kMaxCodePoint || page_index_.empty()) {
+      return false;
+    }
+    const uint16_t page = page_index_[code_point >> kPageShift];
+    if (page == 0) {
+      return false;
+    }
+    const uint32_t bit = code_point & (kPageSize - 1);
+    return (pages_[page][bit >> 6] >> (bit & 63)) & 1;
+  }
+
+  // The covered code points as sorted, disjoint, inclusive ranges.
+  std::vector<std::pair<uint32_t, uint32_t>> GetRanges() const;
+
+  // Reads the coverage from the format 4 and format 12 subtables of a cmap
+  // table. Returns false if it has neither.
+  bool ReadCmap(const uint8_t* cmap, size_t size);
+
+ private:
+  static constexpr uint32_t kMaxCodePoint = 0x10FFFF;
+  static constexpr uint32_t kPageShift = 8;
+  static constexpr uint32_t kPageSize = 1 << kPageShift;
+  static constexpr uint32_t kPageCount = (kMaxCodePoint >> kPageShift) + 1;
+
+  using Page = std::array<uint64_t, kPageSize / 64>;
+
+  // Indexes into |pages_| by page number. Page 0 is always empty.
+  std::vector<uint16_t> page_index_;
+  std::vector<Page> pages_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(CoverageBitmap);
+};
+
+// Wraps the platform font manager and remembers which of its typefaces cover
+// which code points. txt asks the platform font manager for a fallback
+// typeface whenever none of the fonts of a paragraph has a glyph. With the
+// index, code points covered by a fallback that was found before, and code
+// points that no typeface covers, are answered without querying the
+// platform. The typefaces found and their coverage are kept in the
+// PersistentCache directory, so they are known on the next launch as well.
+//
+// Only wraps the platform fonts, which do not change at runtime, so the index
+// stays valid when fonts are registered or loaded.
+class FontFallbackIndex : public SkFontMgr {
+ public:
+  explicit FontFallbackIndex(sk_sp<SkFontMgr> font_manager);
+
+  ~FontFallbackIndex() override;
+
+  // Reads the typefaces found on earlier launches. Returns false if there
+  // were none or they could not be read.
+  bool Load();
+
+  // Writes the typefaces found so far if any were added since the last
+  // Load or Save.
+  void Save();
+
+  size_t GetTypefaceCount() const;
+
+ protected:
+  // |SkFontMgr|
+  int onCountFamilies() const override;
+
+  // |SkFontMgr|
+  void onGetFamilyName(int index, SkString* family_name) const override;
+
+  // |SkFontMgr|
+  SkFontStyleSet* onCreateStyleSet(int index) const override;
+
+  // |SkFontMgr|
+  SkFontStyleSet* onMatchFamily(const char family_name[]) const override;
+
+  // |SkFontMgr|
+  SkTypeface* onMatchFamilyStyle(const char family_name[],
+                                 const SkFontStyle& style) const override;
+
+  // |SkFontMgr|
+  SkTypeface* onMatchFamilyStyleCharacter(const char family_name[],
+                                          const SkFontStyle& style,
+                                          const char* bcp47[],
+                                          int bcp47_count,
+                                          SkUnichar character) const override;
+
+  // |SkFontMgr|
+  SkTypeface* onMatchFaceStyle(const SkTypeface* typeface,
+                               const SkFontStyle& style) const override;
+
+  // |SkFontMgr|
+  sk_sp<SkTypeface> onMakeFromData(sk_sp<SkData> data,
+                                   int ttc_index) const override;
+
+  // |SkFontMgr|
+  sk_sp<SkTypeface> onMakeFromStreamIndex(std::unique_ptr<SkStreamAsset> stream,
+                                          int ttc_index) const override;
+
+  // |SkFontMgr|
+  sk_sp<SkTypeface> onMakeFromStreamArgs(
+      std::unique_ptr<SkStreamAsset> stream,
+      const SkFontArguments& args) const override;
+
+  // |SkFontMgr|
+  sk_sp<SkTypeface> onMakeFromFile(const char path[],
+                                   int ttc_index) const override;
+
+  // |SkFontMgr|
+  sk_sp<SkTypeface> onLegacyMakeTypeface(const char family_name[],
+                                         SkFontStyle style) const override;
+
+ private:
+  struct Face {
+    std::string family_name;
+    SkFontStyle style;
+    // Identifies the font file across launches together with the name and
+    // style.
+    size_t cmap_size = 0;
+    CoverageBitmap coverage;
+    // Matched from the platform on first use when the face was loaded.
+    sk_sp<SkTypeface> typeface;
+    bool is_valid = true;
+  };
+
+  // The fallbacks found for one combination of family, style and locales.
+  struct Fallbacks {
+    std::vector<Face*> faces;
+    // Code points for which the platform had no fallback.
+    CoverageBitmap misses;
+  };
+
+  const sk_sp<SkFontMgr> font_manager_;
+  mutable std::mutex mutex_;
+  mutable std::vector<std::unique_ptr<Face>> faces_;
+  mutable std::unordered_map<std::string, Fallbacks> fallbacks_;
+  mutable bool dirty_ = false;
+
+  static std::string MakeFallbacksKey(const char family_name[],
+                                      const SkFontStyle& style,
+                                      const char* bcp47[],
+                                      int bcp47_count);
+
+  // Returns the typeface of |face|, or null if the platform no longer has
+  // the same font.
+  sk_sp<SkTypeface> GetTypeface(Face& face) const;
+
+  Face* FindOrAddFace(sk_sp<SkTypeface> typeface) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FontFallbackIndex);
+};
+
+}  // namespace uiwidgets
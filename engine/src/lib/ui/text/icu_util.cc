@@ -8,6 +8,7 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/native_library.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/trace_event.h"
 #include "unicode/udata.h"
 namespace uiwidgets {
 namespace icu {
@@ -77,6 +78,8 @@ class ICUContext {
 
   size_t GetSize() const { return mapping_ ? mapping_->GetSize() : 0; }
 
+  const fml::Mapping* mapping() const { return mapping_.get(); }
+
   bool IsValid() const { return valid_; }
 
  private:
@@ -86,28 +89,49 @@ class ICUContext {
   FML_DISALLOW_COPY_AND_ASSIGN(ICUContext);
 };
 
+// The one context of the process, set up by the first initialization.
+ICUContext* g_icu_context = nullptr;
+std::string g_icu_data_path;
+std::once_flag g_icu_init_flag;
+
 void InitializeICUOnce(const std::string& icu_data_path) {
-  static ICUContext* context = new ICUContext(icu_data_path);
-  FML_CHECK(context->IsValid())
+  TRACE_EVENT0("uiwidgets", "InitializeICU");
+  g_icu_context = new ICUContext(icu_data_path);
+  g_icu_data_path = icu_data_path;
+  FML_CHECK(g_icu_context->IsValid())
       << "Must be able to initialize the ICU context. Tried: " << icu_data_path;
 }
 
-std::once_flag g_icu_init_flag;
 void InitializeICU(const std::string& icu_data_path) {
   std::call_once(g_icu_init_flag,
                  [&icu_data_path]() { InitializeICUOnce(icu_data_path); });
+  // Later Shells share the data of the first one instead of mapping another
+  // copy, so they must ask for the same data.
+  FML_CHECK(g_icu_data_path == icu_data_path)
+      << "ICU is already initialized from '" << g_icu_data_path
+      << "', cannot use '" << icu_data_path << "'.";
 }
 
 void InitializeICUFromMappingOnce(std::unique_ptr<fml::Mapping> mapping) {
-  static ICUContext* context = new ICUContext(std::move(mapping));
-  FML_CHECK(context->IsValid())
+  TRACE_EVENT0("uiwidgets", "InitializeICUFromMapping");
+  g_icu_context = new ICUContext(std::move(mapping));
+  FML_CHECK(g_icu_context->IsValid())
       << "Unable to initialize the ICU context from a mapping.";
 }
 
 void InitializeICUFromMapping(std::unique_ptr<fml::Mapping> mapping) {
+  const uint8_t* data = mapping ? mapping->GetMapping() : nullptr;
   std::call_once(g_icu_init_flag, [mapping = std::move(mapping)]() mutable {
     InitializeICUFromMappingOnce(std::move(mapping));
   });
+  // A later mapping must be of the same bytes, e.g. the data linked into the
+  // library, and not a copy that would be dropped here.
+  FML_CHECK(g_icu_data_path.empty() && data == g_icu_context->GetMapping())
+      << "ICU is already initialized from other data.";
+}
+
+const fml::Mapping* GetICUMapping() {
+  return g_icu_context ? g_icu_context->mapping() : nullptr;
 }
 
 }  // namespace icu
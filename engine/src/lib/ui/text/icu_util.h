@@ -7,9 +7,17 @@
 namespace uiwidgets {
 namespace icu {
 
+// ICU is set up once per process, by whichever of these is called first, and
+// every later Shell uses the same data. The data is mapped read only, either
+// from the file at |icu_data_path| or from the data linked into the library,
+// so its pages are shared with the page cache and never copied. Later calls
+// must pass the same path or a mapping of the same bytes, or they abort.
 void InitializeICU(const std::string& icu_data_path = "");
 
 void InitializeICUFromMapping(std::unique_ptr<fml::Mapping> mapping);
 
+// The mapping of the data ICU uses, or null before it is initialized.
+const fml::Mapping* GetICUMapping();
+
 }  // namespace icu
 }  // namespace uiwidgets
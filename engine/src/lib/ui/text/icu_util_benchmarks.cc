@@ -0,0 +1,73 @@
+#include "benchmarking/benchmarking.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/time/time_point.h"
+#include "lib/ui/text/icu_util.h"
+#include "unicode/ubrk.h"
+
+namespace uiwidgets {
+
+namespace {
+
+UBreakIterator* OpenBreakIterator(UBreakIteratorType type) {
+  UErrorCode status = U_ZERO_ERROR;
+  UBreakIterator* iterator = ubrk_open(type, "en", nullptr, 0, &status);
+  if (U_FAILURE(status)) {
+    return nullptr;
+  }
+  return iterator;
+}
+
+}  // namespace
+
+// Opens the break iterator that paragraph layout needs first. The first open
+// loads its rules and dictionaries from the ICU data, which is what the first
+// frame with text waits for, and is reported as first_open_us. It is only cold
+// if nothing opened an iterator of the type before, so filter for this
+// benchmark alone to measure it, e.g. with --benchmark_filter=ICU.
+static void BM_ICUBreakIteratorOpen(benchmark::State& state) {
+  const auto type = static_cast<UBreakIteratorType>(state.range(0));
+  const fml::TimePoint start = fml::TimePoint::Now();
+  UBreakIterator* first = OpenBreakIterator(type);
+  const fml::TimeDelta first_open = fml::TimePoint::Now() - start;
+  if (!first) {
+    state.SkipWithError("Could not open the break iterator.");
+    return;
+  }
+  ubrk_close(first);
+  state.counters["first_open_us"] = first_open.ToMicrosecondsF();
+
+  for (auto _ : state) {
+    UBreakIterator* iterator = OpenBreakIterator(type);
+    benchmark::DoNotOptimize(iterator);
+    ubrk_close(iterator);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ICUBreakIteratorOpen)->Arg(UBRK_LINE)->Arg(UBRK_WORD);
+
+// Reads a byte of every page of the ICU data. The data is mapped once per
+// process and shared with the page cache, so this is the cost of its pages
+// once they are resident; data_bytes is its size after slimming.
+static void BM_ICUDataRead(benchmark::State& state) {
+  const fml::Mapping* mapping = icu::GetICUMapping();
+  if (!mapping || !mapping->GetMapping()) {
+    state.SkipWithError("ICU is not initialized.");
+    return;
+  }
+  const uint8_t* data = mapping->GetMapping();
+  const size_t size = mapping->GetSize();
+  constexpr size_t kPageSize = 4096;
+
+  for (auto _ : state) {
+    uint32_t sum = 0;
+    for (size_t offset = 0; offset < size; offset += kPageSize) {
+      sum += data[offset];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+  state.counters["data_bytes"] = size;
+}
+BENCHMARK(BM_ICUDataRead);
+
+}  // namespace uiwidgets
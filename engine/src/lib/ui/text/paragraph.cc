@@ -1,8 +1,20 @@
 #include "paragraph.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "flutter/fml/trace_event.h"
+#include "font_collection.h"
+
 namespace uiwidgets {
-Paragraph::Paragraph(std::unique_ptr<txt::Paragraph> paragraph)
-    : m_paragraph(std::move(paragraph)) {}
+Paragraph::Paragraph(std::unique_ptr<txt::Paragraph> paragraph,
+                     std::shared_ptr<const ParagraphContent> content)
+    : m_paragraph(std::move(paragraph)), m_content(std::move(content)) {}
 
 Paragraph::~Paragraph() = default;
 
@@ -37,7 +49,185 @@ float Paragraph::ideographicBaseline() {
 
 bool Paragraph::didExceedMaxLines() { return m_paragraph->DidExceedMaxLines(); }
 
-void Paragraph::layout(float width) { m_paragraph->Layout(width); }
+void Paragraph::getMetrics(float* metrics) {
+  metrics[0] = m_paragraph->GetMaxWidth();
+  metrics[1] = m_paragraph->GetHeight();
+  metrics[2] = m_paragraph->GetLongestLine();
+  metrics[3] = m_paragraph->GetMinIntrinsicWidth();
+  metrics[4] = m_paragraph->GetMaxIntrinsicWidth();
+  metrics[5] = m_paragraph->GetAlphabeticBaseline();
+  metrics[6] = m_paragraph->GetIdeographicBaseline();
+  metrics[7] = m_paragraph->DidExceedMaxLines() ? 1.0f : 0.0f;
+}
+
+void Paragraph::layout(float width) {
+  if (!m_content) {
+    m_paragraph->Layout(width);
+    return;
+  }
+
+  FontCollection& font_collection =
+      UIMonoState::Current()->window()->client()->GetFontCollection();
+  ParagraphLayoutCache& cache =
+      UIMonoState::Current()->GetParagraphLayoutCache();
+  cache.SetFontGeneration(font_collection.generation());
+
+  if (takeCachedLayout(width, cache)) {
+    return;
+  }
+  if (m_paragraphIsCached) {
+    m_paragraph = m_content->Build(font_collection.GetFontCollection());
+    m_paragraphIsCached = false;
+  }
+  m_paragraph->Layout(width);
+  finishLayout(width, cache);
+}
+
+bool Paragraph::takeCachedLayout(float width, ParagraphLayoutCache& cache) {
+  if (auto cached = cache.Get(m_content, width)) {
+    m_paragraph = std::move(cached);
+    m_paragraphIsCached = true;
+    return true;
+  }
+  return false;
+}
+
+void Paragraph::finishLayout(float width, ParagraphLayoutCache& cache) {
+  m_paragraphIsCached = cache.Put(m_content, width, m_paragraph);
+}
+
+namespace {
+
+// The paragraphs of a batch that still have to be laid out. Shared with the
+// workers, which may only start after the batch is done.
+struct PendingLayouts {
+  std::vector<std::shared_ptr<const ParagraphContent>> contents;
+  std::vector<float> widths;
+  // The paragraphs built from |contents| and laid out.
+  std::vector<std::unique_ptr<txt::Paragraph>> results;
+  std::atomic<size_t> next_index{0};
+  std::mutex mutex;
+  std::condition_variable done_condition;
+  size_t done_count = 0;
+
+  bool HasUnclaimed() const { return next_index < contents.size(); }
+
+  // Builds and lays out paragraphs with |font_collection| until none are
+  // left to claim. No two threads may use the same collection at once.
+  void Run(const std::shared_ptr<txt::FontCollection>& font_collection) {
+    size_t done = 0;
+    for (size_t index = next_index++; index < contents.size();
+         index = next_index++) {
+      results[index] = contents[index]->Build(font_collection);
+      results[index]->Layout(widths[index]);
+      done++;
+    }
+    if (done > 0) {
+      std::lock_guard<std::mutex> lock(mutex);
+      done_count += done;
+      if (done_count == contents.size()) {
+        done_condition.notify_all();
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::vector<std::unique_ptr<txt::Paragraph>> LayoutParagraphContents(
+    std::vector<std::shared_ptr<const ParagraphContent>> contents,
+    std::vector<float> widths,
+    const std::shared_ptr<txt::FontCollection>& font_collection,
+    const std::shared_ptr<WorkerFontCollections>& worker_collections,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner,
+    size_t max_workers) {
+  FML_DCHECK(contents.size() == widths.size());
+  const size_t count = contents.size();
+  auto pending = std::make_shared<PendingLayouts>();
+  pending->contents = std::move(contents);
+  pending->widths = std::move(widths);
+  pending->results.resize(count);
+
+  if (task_runner && count > 1) {
+    const size_t helper_count = std::min(count - 1, max_workers);
+    for (size_t i = 0; i < helper_count; i++) {
+      task_runner->PostTask([pending, worker_collections]() {
+        if (!pending->HasUnclaimed()) {
+          return;
+        }
+        auto collection = worker_collections->Acquire();
+        pending->Run(collection);
+        worker_collections->Release(std::move(collection));
+      });
+    }
+  }
+
+  // Only the paragraphs claimed by a worker are waited for, so a worker that
+  // is busy with something else does not hold up the batch.
+  pending->Run(font_collection);
+  {
+    std::unique_lock<std::mutex> lock(pending->mutex);
+    pending->done_condition.wait(lock, [&pending, count]() {
+      return pending->done_count == count;
+    });
+  }
+  return std::move(pending->results);
+}
+
+void Paragraph::layoutBatch(Paragraph** paragraphs, const float* widths,
+                            size_t count) {
+  TRACE_EVENT0("uiwidgets", "Paragraph::layoutBatch");
+  auto* state = UIMonoState::Current();
+  FontCollection& font_collection =
+      state->window()->client()->GetFontCollection();
+  ParagraphLayoutCache& cache = state->GetParagraphLayoutCache();
+  cache.SetFontGeneration(font_collection.generation());
+
+  std::vector<std::shared_ptr<const ParagraphContent>> pending_contents;
+  std::vector<float> pending_widths;
+  std::vector<Paragraph*> pending_paragraphs;
+  std::unordered_set<Paragraph*> seen;
+  // A paragraph that is listed more than once ends up laid out at its last
+  // width, as if the batch was laid out one by one.
+  for (size_t i = count; i-- > 0;) {
+    Paragraph* paragraph = paragraphs[i];
+    if (paragraph == nullptr || !seen.insert(paragraph).second) {
+      continue;
+    }
+    if (!paragraph->m_content) {
+      // Without its content the paragraph cannot be built again for a
+      // worker, so it is laid out here.
+      paragraph->m_paragraph->Layout(widths[i]);
+      continue;
+    }
+    if (paragraph->takeCachedLayout(widths[i], cache)) {
+      continue;
+    }
+    pending_contents.push_back(paragraph->m_content);
+    pending_widths.push_back(widths[i]);
+    pending_paragraphs.push_back(paragraph);
+  }
+
+  if (pending_paragraphs.empty()) {
+    return;
+  }
+
+  std::shared_ptr<fml::ConcurrentTaskRunner> task_runner;
+  if (auto image_decoder = state->GetImageDecoder()) {
+    task_runner = image_decoder->GetConcurrentTaskRunner();
+  }
+  auto results = LayoutParagraphContents(
+      std::move(pending_contents), pending_widths,
+      font_collection.GetFontCollection(),
+      font_collection.worker_collections(), task_runner,
+      std::max(1u, std::thread::hardware_concurrency()));
+
+  for (size_t i = 0; i < pending_paragraphs.size(); i++) {
+    Paragraph* paragraph = pending_paragraphs[i];
+    paragraph->m_paragraph = std::move(results[i]);
+    paragraph->finishLayout(pending_widths[i], cache);
+  }
+}
 
 void Paragraph::paint(Canvas* canvas, float x, float y) {
   SkCanvas* sk_canvas = canvas->canvas();
@@ -92,6 +282,19 @@ Float32List Paragraph::getRectsForRange(unsigned start, unsigned end,
   return EncodeTextBoxes(boxes);
 }
 
+int Paragraph::getRectsForRange(unsigned start, unsigned end,
+                                unsigned boxHeightStyle, unsigned boxWidthStyle,
+                                float* data, int capacity) {
+  std::vector<txt::Paragraph::TextBox> boxes = m_paragraph->GetRectsForRange(
+      start, end, static_cast<txt::Paragraph::RectHeightStyle>(boxHeightStyle),
+      static_cast<txt::Paragraph::RectWidthStyle>(boxWidthStyle));
+  int size = boxes.size() * 5;
+  if (size <= capacity) {
+    EncodeTextBoxes(boxes, data);
+  }
+  return size;
+}
+
 Float32List Paragraph::getRectsForPlaceholders() {
   std::vector<txt::Paragraph::TextBox> boxes =
       m_paragraph->GetRectsForPlaceholders();
@@ -126,33 +329,46 @@ void Paragraph::getLineBoundary(unsigned offset, int* boundaryPtr) {
   boundaryPtr[1] = line_end;
 }
 
-Float32List Paragraph::computeLineMetrics() {
-  std::vector<txt::LineMetrics> metrics = m_paragraph->GetLineMetrics();
-
+static void EncodeLineMetrics(const std::vector<txt::LineMetrics>& metrics,
+                              float* result) {
   // Layout:
-  // boxes.size() groups of 9 which are the line metrics
+  // metrics.size() groups of 9 which are the line metrics
   // properties
-  int size = metrics.size() * 9;
-  Float32List result = {(float*)malloc(sizeof(float) * size), size};
   unsigned long position = 0;
   for (unsigned long i = 0; i < metrics.size(); i++) {
     const txt::LineMetrics& line = metrics[i];
-    result.data[position++] = static_cast<float>(line.hard_break);
-    result.data[position++] = line.ascent;
-    result.data[position++] = line.descent;
-    result.data[position++] = line.unscaled_ascent;
+    result[position++] = static_cast<float>(line.hard_break);
+    result[position++] = line.ascent;
+    result[position++] = line.descent;
+    result[position++] = line.unscaled_ascent;
     // We add then round to get the height. The
     // definition of height here is different
     // than the one in LibTxt.
-    result.data[position++] = round(line.ascent + line.descent);
-    result.data[position++] = line.width;
-    result.data[position++] = line.left;
-    result.data[position++] = line.baseline;
-    result.data[position++] = static_cast<float>(line.line_number);
+    result[position++] = round(line.ascent + line.descent);
+    result[position++] = line.width;
+    result[position++] = line.left;
+    result[position++] = line.baseline;
+    result[position++] = static_cast<float>(line.line_number);
   }
+}
+
+Float32List Paragraph::computeLineMetrics() {
+  std::vector<txt::LineMetrics> metrics = m_paragraph->GetLineMetrics();
+  int size = metrics.size() * 9;
+  Float32List result = {(float*)malloc(sizeof(float) * size), size};
+  EncodeLineMetrics(metrics, result.data);
   return result;
 }
 
+int Paragraph::computeLineMetrics(float* data, int capacity) {
+  std::vector<txt::LineMetrics> metrics = m_paragraph->GetLineMetrics();
+  int size = metrics.size() * 9;
+  if (size <= capacity) {
+    EncodeLineMetrics(metrics, data);
+  }
+  return size;
+}
+
 UIWIDGETS_API(float) Paragraph_width(Paragraph* ptr) { return ptr->width(); }
 
 UIWIDGETS_API(float) Paragraph_height(Paragraph* ptr) { return ptr->height(); }
@@ -181,16 +397,34 @@ UIWIDGETS_API(bool) Paragraph_didExceedMaxLines(Paragraph* ptr) {
   return ptr->didExceedMaxLines();
 }
 
+UIWIDGETS_API(void) Paragraph_getMetrics(Paragraph* ptr, float* out) {
+  ptr->getMetrics(out);
+}
+
 UIWIDGETS_API(void) Paragraph_layout(Paragraph* ptr, float width) {
   ptr->layout(width);
 }
 
+UIWIDGETS_API(void)
+Paragraph_layoutBatch(Paragraph** items, float* widths, int n) {
+  if (items == nullptr || widths == nullptr || n <= 0) return;
+  Paragraph::layoutBatch(items, widths, static_cast<size_t>(n));
+}
+
 UIWIDGETS_API(Float32List)
 Paragraph_getRectsForRange(Paragraph* ptr, int start, int end,
                            int boxHeightStyle, int boxWidthStyle) {
   return ptr->getRectsForRange(start, end, boxHeightStyle, boxWidthStyle);
 }
 
+UIWIDGETS_API(int)
+Paragraph_getRectsForRangeInto(Paragraph* ptr, int start, int end,
+                               int boxHeightStyle, int boxWidthStyle,
+                               float* data, int capacity) {
+  return ptr->getRectsForRange(start, end, boxHeightStyle, boxWidthStyle, data,
+                               capacity);
+}
+
 UIWIDGETS_API(Float32List)
 Paragraph_getRectsForPlaceholders(Paragraph* ptr) {
   return ptr->getRectsForPlaceholders();
@@ -222,5 +456,10 @@ Paragraph_computeLineMetrics(Paragraph* ptr, float* data) {
   return ptr->computeLineMetrics();
 }
 
+UIWIDGETS_API(int)
+Paragraph_computeLineMetricsInto(Paragraph* ptr, float* data, int capacity) {
+  return ptr->computeLineMetrics(data, capacity);
+}
+
 UIWIDGETS_API(void) Paragraph_dispose(Paragraph* ptr) { ptr->Release(); }
 }  // namespace uiwidgets
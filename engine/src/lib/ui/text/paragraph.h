@@ -1,6 +1,11 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/memory/ref_counted.h"
+#include "paragraph_layout_cache.h"
 #include "txt/paragraph.h"
 #include "shell/common/lists.h"
 #include "lib/ui/painting/canvas.h"
@@ -8,15 +13,34 @@
 
 namespace uiwidgets {
 
+class FontCollection;
+class WorkerFontCollections;
+
+// Builds a paragraph from each of |contents| and lays it out at the matching
+// width. The calling thread builds with |font_collection|. If |task_runner|
+// is set, up to |max_workers| of its workers help, each with a collection
+// taken from |worker_collections|. Returns once all are laid out.
+std::vector<std::unique_ptr<txt::Paragraph>> LayoutParagraphContents(
+    std::vector<std::shared_ptr<const ParagraphContent>> contents,
+    std::vector<float> widths,
+    const std::shared_ptr<txt::FontCollection>& font_collection,
+    const std::shared_ptr<WorkerFontCollections>& worker_collections,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner,
+    size_t max_workers);
+
 class Paragraph : public fml::RefCountedThreadSafe<Paragraph> {
   FML_FRIEND_MAKE_REF_COUNTED(Paragraph);
 
  public:
   static fml::RefPtr<Paragraph> Create();
 
+  // Paragraphs with a |content| share their layouts through the
+  // ParagraphLayoutCache of the current UIMonoState.
   static fml::RefPtr<Paragraph> Create(
-      std::unique_ptr<txt::Paragraph> txt_paragraph) {
-    return fml::MakeRefCounted<Paragraph>(std::move(txt_paragraph));
+      std::unique_ptr<txt::Paragraph> txt_paragraph,
+      std::shared_ptr<const ParagraphContent> content = nullptr) {
+    return fml::MakeRefCounted<Paragraph>(std::move(txt_paragraph),
+                                          std::move(content));
   }
 
   ~Paragraph();
@@ -30,21 +54,52 @@ class Paragraph : public fml::RefCountedThreadSafe<Paragraph> {
   float ideographicBaseline();
   bool didExceedMaxLines();
 
+  // The number of values written by getMetrics: width, height, longest line,
+  // min and max intrinsic width, alphabetic and ideographic baseline, and 1
+  // or 0 for whether the paragraph exceeded its max lines.
+  static constexpr int kMetricsLength = 8;
+  void getMetrics(float* metrics);
+
   void layout(float width);
+
+  // Lays out |count| independent paragraphs, each at its own width. The
+  // paragraphs that miss the layout cache are built again and laid out in
+  // parallel on the engine's concurrent workers, each with font collections
+  // of its own; this returns once all of them are done.
+  static void layoutBatch(Paragraph** paragraphs, const float* widths,
+                          size_t count);
   void paint(Canvas* canvas, float x, float y);
   Float32List getRectsForRange(unsigned start, unsigned end,
                         unsigned boxHeightStyle, unsigned boxWidthStyle);
+  // Writes the boxes into |data| if they fit in |capacity| floats, and
+  // returns the number of floats they take either way.
+  int getRectsForRange(unsigned start, unsigned end, unsigned boxHeightStyle,
+                       unsigned boxWidthStyle, float* data, int capacity);
   Float32List getRectsForPlaceholders();
   void getPositionForOffset(float dx, float dy, int* offset);
   void getWordBoundary(unsigned offset, int* boundaryPtr);
   void getLineBoundary(unsigned offset, int* boundaryPtr);
   Float32List computeLineMetrics();
+  // Same contract as the buffer variant of getRectsForRange.
+  int computeLineMetrics(float* data, int capacity);
 
   size_t GetAllocationSize();
-  std::unique_ptr<txt::Paragraph> m_paragraph;
+  std::shared_ptr<txt::Paragraph> m_paragraph;
 
  private:
-  explicit Paragraph(std::unique_ptr<txt::Paragraph> paragraph);
+  Paragraph(std::unique_ptr<txt::Paragraph> paragraph,
+            std::shared_ptr<const ParagraphContent> content);
+
+  // Takes the cached layout for |width| if there is one.
+  bool takeCachedLayout(float width, ParagraphLayoutCache& cache);
+
+  // Offers the paragraph laid out at |width| to the layout cache.
+  void finishLayout(float width, ParagraphLayoutCache& cache);
+
+  std::shared_ptr<const ParagraphContent> m_content;
+  // Whether m_paragraph is owned by the layout cache, which means it must not
+  // be laid out again.
+  bool m_paragraphIsCached = false;
 };
 
 }  // namespace uiwidgets
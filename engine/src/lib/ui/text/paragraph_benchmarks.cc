@@ -0,0 +1,238 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "lib/ui/text/font_collection.h"
+#include "lib/ui/text/paragraph.h"
+#include "lib/ui/text/paragraph_builder.h"
+#include "lib/ui/text/paragraph_layout_cache.h"
+#include "txt/font_collection.h"
+#include "txt/paragraph.h"
+#include "txt/paragraph_builder.h"
+#include "txt/paragraph_style.h"
+#include "txt/platform.h"
+#include "txt/text_style.h"
+#include "unicode/ustring.h"
+
+namespace uiwidgets {
+
+namespace {
+
+std::shared_ptr<txt::FontCollection> GetFontCollection() {
+  static std::shared_ptr<txt::FontCollection>* collection = [] {
+    auto* collection = new std::shared_ptr<txt::FontCollection>(
+        std::make_shared<txt::FontCollection>());
+    (*collection)->SetDefaultFontManager(txt::GetDefaultFontManager());
+    return collection;
+  }();
+  return *collection;
+}
+
+// |word_count| words of Latin filler text.
+std::u16string MakeText(int word_count) {
+  static const char16_t* kWords[] = {
+      u"lorem", u"ipsum", u"dolor", u"sit", u"amet", u"consectetur",
+      u"adipiscing", u"elit", u"sed", u"do", u"eiusmod", u"tempor"};
+  constexpr int kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+  std::u16string text;
+  for (int i = 0; i < word_count; i++) {
+    if (i > 0) {
+      text += u' ';
+    }
+    text += kWords[(i * 7) % kWordCount];
+  }
+  return text;
+}
+
+// A paragraph with a style change every ten words, as rich text has.
+std::unique_ptr<txt::Paragraph> BuildParagraph(const std::u16string& text) {
+  txt::ParagraphStyle paragraph_style;
+  auto builder = txt::ParagraphBuilder::CreateTxtBuilder(paragraph_style,
+                                                         GetFontCollection());
+  txt::TextStyle style;
+  style.font_size = 14;
+  txt::TextStyle bold = style;
+  bold.font_weight = txt::FontWeight::w700;
+
+  size_t start = 0;
+  int words = 0;
+  for (size_t i = 0; i <= text.size(); i++) {
+    if (i < text.size() && text[i] != u' ') {
+      continue;
+    }
+    if (++words % 10 == 0 || i == text.size()) {
+      builder->PushStyle((words / 10) % 2 ? bold : style);
+      builder->AddText(text.substr(start, i - start));
+      builder->Pop();
+      start = i;
+    }
+  }
+  return builder->Build();
+}
+
+// A large document as a list of chunks of |chunk_words| words each, e.g. the
+// lines of a chat log or of a code view. Every 16th chunk has an emoji, which
+// takes a surrogate pair.
+std::vector<std::u16string> MakeDocument(int chunk_count, int chunk_words) {
+  std::vector<std::u16string> chunks;
+  for (int i = 0; i < chunk_count; i++) {
+    std::u16string chunk = MakeText(chunk_words);
+    if (i % 16 == 0) {
+      chunk += u" \U0001F600";
+    }
+    chunk += u'\n';
+    chunks.push_back(std::move(chunk));
+  }
+  return chunks;
+}
+
+size_t GetDocumentBytes(const std::vector<std::u16string>& chunks) {
+  size_t bytes = 0;
+  for (const auto& chunk : chunks) {
+    bytes += chunk.size() * sizeof(char16_t);
+  }
+  return bytes;
+}
+
+}  // namespace
+
+// Adds a large document of |range(0)| chunks of |range(1)| words through
+// ParagraphBuilder::addText, as ParagraphBuilder_addTextWithLength does.
+static void BM_ParagraphAddTextLargeDocument(benchmark::State& state) {
+  const auto chunks = MakeDocument(state.range(0), state.range(1));
+  // The default paragraph style.
+  int encoded[] = {0};
+
+  for (auto _ : state) {
+    auto builder = ParagraphBuilder::create(encoded, nullptr, 0, "", {}, 0, 0,
+                                            u"", "", GetFontCollection());
+    for (const auto& chunk : chunks) {
+      if (const char* error = builder->addText(chunk.data(), chunk.size())) {
+        state.SkipWithError(error);
+        return;
+      }
+    }
+    benchmark::DoNotOptimize(builder->build());
+  }
+  state.SetItemsProcessed(state.iterations() * chunks.size());
+  state.SetBytesProcessed(state.iterations() * GetDocumentBytes(chunks));
+}
+// A chat log of short lines and a code view of longer ones.
+BENCHMARK(BM_ParagraphAddTextLargeDocument)
+    ->Args({10000, 8})
+    ->Args({2000, 40});
+
+// Validates the same documents, with |range(2)| choosing between the in place
+// check of addText (0) and the u_strToUTF8 dry run that it replaced (1).
+static void BM_ParagraphAddTextValidate(benchmark::State& state) {
+  const auto chunks = MakeDocument(state.range(0), state.range(1));
+  const bool dry_run = state.range(2) != 0;
+
+  for (auto _ : state) {
+    for (const auto& chunk : chunks) {
+      bool valid;
+      if (dry_run) {
+        UErrorCode error_code = U_ZERO_ERROR;
+        u_strToUTF8(nullptr, 0, nullptr,
+                    reinterpret_cast<const UChar*>(chunk.data()),
+                    chunk.size(), &error_code);
+        valid = error_code == U_BUFFER_OVERFLOW_ERROR;
+      } else {
+        valid = IsWellFormedUTF16(chunk.data(), chunk.size());
+      }
+      benchmark::DoNotOptimize(valid);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * GetDocumentBytes(chunks));
+}
+BENCHMARK(BM_ParagraphAddTextValidate)
+    ->Args({10000, 8, 0})
+    ->Args({10000, 8, 1})
+    ->Args({2000, 40, 0})
+    ->Args({2000, 40, 1});
+
+static void BM_ParagraphBuild(benchmark::State& state) {
+  const std::u16string text = MakeText(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BuildParagraph(text));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParagraphBuild)->Arg(10)->Arg(100)->Arg(1000);
+
+// Lays out the same paragraph at alternating widths, so that every layout
+// shapes and breaks the lines again.
+static void BM_ParagraphLayout(benchmark::State& state) {
+  const std::u16string text = MakeText(state.range(0));
+  auto paragraph = BuildParagraph(text);
+  int width = 300;
+
+  for (auto _ : state) {
+    paragraph->Layout(width);
+    width = width == 300 ? 301 : 300;
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParagraphLayout)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_ParagraphBuildAndLayout(benchmark::State& state) {
+  const std::u16string text = MakeText(state.range(0));
+
+  for (auto _ : state) {
+    auto paragraph = BuildParagraph(text);
+    paragraph->Layout(300);
+    benchmark::DoNotOptimize(paragraph->GetHeight());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParagraphBuildAndLayout)->Arg(10)->Arg(100)->Arg(1000);
+
+// Lays out a batch of 64 different paragraphs with LayoutParagraphContents
+// and |range(0)| helper workers, to show how Paragraph::layoutBatch scales
+// with the number of cores.
+static void BM_ParagraphLayoutBatch(benchmark::State& state) {
+  const size_t worker_count = state.range(0);
+  const int kParagraphCount = 64;
+  std::vector<std::shared_ptr<const ParagraphContent>> contents;
+  for (int i = 0; i < kParagraphCount; i++) {
+    auto content =
+        std::make_shared<ParagraphContent>(txt::ParagraphStyle());
+    txt::TextStyle style;
+    style.font_size = 14;
+    content->PushStyle(style);
+    // Differs in the first word, so that no two paragraphs are equal.
+    content->AddText(MakeText(i % 12 + 1) + u" " + MakeText(100));
+    content->Pop();
+    contents.push_back(std::move(content));
+  }
+  const std::vector<float> widths(kParagraphCount, 300);
+
+  auto worker_collections = std::make_shared<WorkerFontCollections>();
+  worker_collections->SetFontManagers(txt::GetDefaultFontManager(), nullptr,
+                                      nullptr);
+  std::shared_ptr<fml::ConcurrentMessageLoop> loop;
+  std::shared_ptr<fml::ConcurrentTaskRunner> task_runner;
+  if (worker_count > 0) {
+    loop = fml::ConcurrentMessageLoop::Create(worker_count);
+    task_runner = loop->GetTaskRunner();
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LayoutParagraphContents(
+        contents, widths, GetFontCollection(), worker_collections,
+        task_runner, worker_count));
+  }
+  state.SetItemsProcessed(state.iterations() * kParagraphCount);
+}
+BENCHMARK(BM_ParagraphLayoutBatch)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
+}  // namespace uiwidgets
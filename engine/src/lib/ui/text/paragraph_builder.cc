@@ -1,7 +1,8 @@
 #include "paragraph_builder.h"
 
+#include <cstring>
+
 #include "lib/ui/ui_mono_state.h"
-#include "unicode/ustring.h"
 
 namespace uiwidgets {
 namespace {
@@ -102,16 +103,70 @@ const int sHeightMask = 1 << sHeightIndex;
 const int sLeadingMask = 1 << sLeadingIndex;
 const int sForceStrutHeightMask = 1 << sForceStrutHeightIndex;
 
+// UTF-16 validation
+
+constexpr uint64_t kSurrogateMask = 0xF800F800F800F800ull;
+constexpr uint64_t kSurrogateBits = 0xD800D800D800D800ull;
+constexpr uint64_t kLaneLowBits = 0x0001000100010001ull;
+constexpr uint64_t kLaneHighBits = 0x8000800080008000ull;
+
 }  // namespace
 
+// Text without surrogates, which is nearly all of it, is checked four code
+// units at a time.
+bool IsWellFormedUTF16(const char16_t* text, size_t length) {
+  size_t i = 0;
+  while (i < length) {
+    if (i + 4 <= length) {
+      uint64_t units;
+      memcpy(&units, text + i, sizeof(units));
+      // A lane is zero exactly when that code unit is a surrogate.
+      uint64_t lanes = (units & kSurrogateMask) ^ kSurrogateBits;
+      if (((lanes - kLaneLowBits) & ~lanes & kLaneHighBits) == 0) {
+        i += 4;
+        continue;
+      }
+    }
+
+    char16_t unit = text[i];
+    if (unit < 0xD800 || unit > 0xDFFF) {
+      i++;
+      continue;
+    }
+    // A low surrogate must follow a high one.
+    if (unit >= 0xDC00 || i + 1 >= length) {
+      return false;
+    }
+    char16_t next = text[i + 1];
+    if (next < 0xDC00 || next > 0xDFFF) {
+      return false;
+    }
+    i += 2;
+  }
+  return true;
+}
+
 fml::RefPtr<ParagraphBuilder> ParagraphBuilder::create(
     int* encoded, uint8_t* strutData, int strutDataSize,
     const std::string& fontFamily,
     const std::vector<std::string>& strutFontFamilies, float fontSize,
     float height, const std::u16string& ellipsis, const std::string& locale) {
+  FontCollection& font_collection =
+      UIMonoState::Current()->window()->client()->GetFontCollection();
+  return create(encoded, strutData, strutDataSize, fontFamily,
+                strutFontFamilies, fontSize, height, ellipsis, locale,
+                font_collection.GetFontCollection());
+}
+
+fml::RefPtr<ParagraphBuilder> ParagraphBuilder::create(
+    int* encoded, uint8_t* strutData, int strutDataSize,
+    const std::string& fontFamily,
+    const std::vector<std::string>& strutFontFamilies, float fontSize,
+    float height, const std::u16string& ellipsis, const std::string& locale,
+    std::shared_ptr<txt::FontCollection> font_collection) {
   return fml::MakeRefCounted<ParagraphBuilder>(
       encoded, strutData, strutDataSize, fontFamily, strutFontFamilies,
-      fontSize, height, ellipsis, locale);
+      fontSize, height, ellipsis, locale, std::move(font_collection));
 }
 
 void decodeTextShadows(uint8_t* shadows_data, int shadow_data_size,
@@ -198,7 +253,8 @@ ParagraphBuilder::ParagraphBuilder(
     int* encoded, uint8_t* strutData, int strutData_size,
     const std::string& fontFamily,
     const std::vector<std::string>& strutFontFamilies, float fontSize,
-    float height, const std::u16string& ellipsis, const std::string& locale) {
+    float height, const std::u16string& ellipsis, const std::string& locale,
+    std::shared_ptr<txt::FontCollection> font_collection) {
   int32_t mask = encoded[0];
   txt::ParagraphStyle style;
 
@@ -252,19 +308,48 @@ ParagraphBuilder::ParagraphBuilder(
     style.locale = locale;
   }
 
-  FontCollection& font_collection =
-      UIMonoState::Current()->window()->client()->GetFontCollection();
+  m_paragraphBuilder =
+      txt::ParagraphBuilder::CreateTxtBuilder(style, font_collection);
 
-  m_paragraphBuilder = txt::ParagraphBuilder::CreateTxtBuilder(
-      style, font_collection.GetFontCollection());
+  m_content = std::make_shared<ParagraphContent>(style);
+  m_content->AppendInt(mask);
+  for (int i = psTextAlignIndex; i <= psTextHeightBehaviorIndex; i++) {
+    if (mask & (1 << i)) {
+      m_content->AppendInt(encoded[i]);
+    }
+  }
+  if (mask & psFontFamilyMask) {
+    m_content->AppendString(fontFamily);
+  }
+  if (mask & psFontSizeMask) {
+    m_content->AppendFloat(fontSize);
+  }
+  if (mask & psHeightMask) {
+    m_content->AppendFloat(height);
+  }
+  if (mask & psStrutStyleMask) {
+    m_content->AppendInt(strutData ? strutData_size : 0);
+    if (strutData) {
+      m_content->AppendBytes(strutData, strutData_size);
+    }
+    for (const auto& family : strutFontFamilies) {
+      m_content->AppendString(family);
+    }
+  }
+  if (mask & psEllipsisMask) {
+    m_content->AppendInt(static_cast<int32_t>(ellipsis.size()));
+    m_content->AppendBytes(ellipsis.data(), ellipsis.size() * sizeof(char16_t));
+  }
+  if (mask & psLocaleMask) {
+    m_content->AppendString(locale);
+  }
 }
 
 ParagraphBuilder::~ParagraphBuilder() = default;
 
-void decodeFontFeatures(uint8_t* font_features_data,
+void decodeFontFeatures(const uint8_t* font_features_data,
                         int font_features_data_size,
                         txt::FontFeatures& font_features) {
-  uint8_t* byte_data(font_features_data);
   FML_CHECK(font_features_data_size % kBytesPerFontFeature == 0);
 
   size_t feature_count = font_features_data_size / kBytesPerFontFeature;
@@ -281,24 +366,28 @@ void decodeFontFeatures(uint8_t* font_features_data,
   }
 }
 
-void ParagraphBuilder::pushStyle(
-    int* encoded, int encodedSize, char** fontFamilies, int fontFamiliesSize,
-    float fontSize, float letterSpacing, float wordSpacing, float height,
-    float decorationThickness, const std::string& locale,
-    void** background_objects, uint8_t* background_data,
-    void** foreground_objects, uint8_t* foreground_data, uint8_t* shadows_data,
-    int shadow_data_size, uint8_t* font_features_data,
-    int font_feature_data_size) {
-  FML_DCHECK(encodedSize == 8);
-
+void decodeTextStyle(int* encoded, char** fontFamilies, int fontFamiliesSize,
+                     float fontSize, float letterSpacing, float wordSpacing,
+                     float height, float decorationThickness,
+                     const std::string& locale, void** background_objects,
+                     uint8_t* background_data, void** foreground_objects,
+                     uint8_t* foreground_data, uint8_t* shadows_data,
+                     int shadow_data_size, uint8_t* font_features_data,
+                     int font_feature_data_size, TextStyleDelta& delta,
+                     ContentKey* key) {
   int32_t mask = encoded[0];
+  txt::TextStyle& style = delta.style;
+  delta.mask = mask;
+
+  if (key) {
+    key->AppendInt(mask);
+    for (int i = tsColorIndex; i <= tsTextBaselineIndex; i++) {
+      if (mask & (1 << i)) {
+        key->AppendInt(encoded[i]);
+      }
+    }
+  }
 
-  // Set to use the properties of the previous style if the property is not
-  // explicitly given.
-  txt::TextStyle style = m_paragraphBuilder->PeekStyle();
-
-  // Only change the style property from the previous value if a new explicitly
-  // set value is available
   if (mask & tsColorMask) {
     style.color = encoded[tsColorIndex];
   }
@@ -319,6 +408,7 @@ void ParagraphBuilder::pushStyle(
 
   if (mask & tsTextDecorationThicknessMask) {
     style.decoration_thickness_multiplier = decorationThickness;
+    if (key) key->AppendFloat(decorationThickness);
   }
 
   if (mask & tsTextBaselineMask) {
@@ -340,15 +430,23 @@ void ParagraphBuilder::pushStyle(
     if (mask & tsLetterSpacingMask) style.letter_spacing = letterSpacing;
 
     if (mask & tsWordSpacingMask) style.word_spacing = wordSpacing;
+
+    if (key) {
+      if (mask & tsFontSizeMask) key->AppendFloat(fontSize);
+      if (mask & tsLetterSpacingMask) key->AppendFloat(letterSpacing);
+      if (mask & tsWordSpacingMask) key->AppendFloat(wordSpacing);
+    }
   }
 
   if (mask & tsHeightMask) {
     style.height = height;
     style.has_height_override = true;
+    if (key) key->AppendFloat(height);
   }
 
   if (mask & tsLocaleMask) {
     style.locale = locale;
+    if (key) key->AppendString(locale);
   }
 
   if (mask & tsBackgroundMask) {
@@ -357,6 +455,7 @@ void ParagraphBuilder::pushStyle(
       style.has_background = true;
       style.background = *background.paint();
     }
+    if (key) key->AppendPaint(background.shared_paint());
   }
 
   if (mask & tsForegroundMask) {
@@ -365,50 +464,182 @@ void ParagraphBuilder::pushStyle(
       style.has_foreground = true;
       style.foreground = *foreground.paint();
     }
+    if (key) key->AppendPaint(foreground.shared_paint());
   }
 
   if (mask & tsTextShadowsMask) {
     decodeTextShadows(shadows_data, shadow_data_size, style.text_shadows);
+    if (key) {
+      key->AppendInt(shadow_data_size);
+      key->AppendBytes(shadows_data, shadow_data_size);
+    }
+  }
+
+  if (mask & tsFontFamilyMask) {
+    style.font_families =
+        std::vector<std::string>(fontFamilies, fontFamilies + fontFamiliesSize);
+    if (key) {
+      key->AppendInt(fontFamiliesSize);
+      for (const auto& family : style.font_families) {
+        key->AppendString(family);
+      }
+    }
+  }
+
+  if (mask & tsFontFeaturesMask) {
+    // Font features are added to the ones of the enclosing style, so they are
+    // kept encoded until the style is applied.
+    delta.font_features_data.assign(
+        font_features_data, font_features_data + font_feature_data_size);
+    if (key) {
+      key->AppendInt(font_feature_data_size);
+      key->AppendBytes(font_features_data, font_feature_data_size);
+    }
+  }
+}
+
+void applyTextStyle(const TextStyleDelta& delta, txt::TextStyle& style) {
+  const int32_t mask = delta.mask;
+  const txt::TextStyle& values = delta.style;
+
+  // Only change the style property from the previous value if a new explicitly
+  // set value is available
+  if (mask & tsColorMask) {
+    style.color = values.color;
+  }
+
+  if (mask & tsTextDecorationMask) {
+    style.decoration = values.decoration;
+  }
+
+  if (mask & tsTextDecorationColorMask) {
+    style.decoration_color = values.decoration_color;
+  }
+
+  if (mask & tsTextDecorationStyleMask) {
+    style.decoration_style = values.decoration_style;
+  }
+
+  if (mask & tsTextDecorationThicknessMask) {
+    style.decoration_thickness_multiplier =
+        values.decoration_thickness_multiplier;
+  }
+
+  if (mask & tsFontWeightMask) style.font_weight = values.font_weight;
+
+  if (mask & tsFontStyleMask) style.font_style = values.font_style;
+
+  if (mask & tsFontSizeMask) style.font_size = values.font_size;
+
+  if (mask & tsLetterSpacingMask) style.letter_spacing = values.letter_spacing;
+
+  if (mask & tsWordSpacingMask) style.word_spacing = values.word_spacing;
+
+  if (mask & tsHeightMask) {
+    style.height = values.height;
+    style.has_height_override = true;
+  }
+
+  if (mask & tsLocaleMask) {
+    style.locale = values.locale;
+  }
+
+  if ((mask & tsBackgroundMask) && values.has_background) {
+    style.has_background = true;
+    style.background = values.background;
+  }
+
+  if ((mask & tsForegroundMask) && values.has_foreground) {
+    style.has_foreground = true;
+    style.foreground = values.foreground;
+  }
+
+  if (mask & tsTextShadowsMask) {
+    style.text_shadows = values.text_shadows;
   }
 
   if (mask & tsFontFamilyMask) {
     // The child style's font families override the parent's font families.
     // If the child's fonts are not available, then the font collection will
     // use the system fallback fonts (not the parent's fonts).
-    style.font_families =
-        std::vector<std::string>(fontFamilies, fontFamilies + fontFamiliesSize);
+    style.font_families = values.font_families;
   }
 
   if (mask & tsFontFeaturesMask) {
-    decodeFontFeatures(font_features_data, font_feature_data_size,
-                       style.font_features);
+    decodeFontFeatures(delta.font_features_data.data(),
+                       delta.font_features_data.size(), style.font_features);
+  }
+}
+
+void ParagraphBuilder::pushStyle(
+    int* encoded, int encodedSize, char** fontFamilies, int fontFamiliesSize,
+    float fontSize, float letterSpacing, float wordSpacing, float height,
+    float decorationThickness, const std::string& locale,
+    void** background_objects, uint8_t* background_data,
+    void** foreground_objects, uint8_t* foreground_data, uint8_t* shadows_data,
+    int shadow_data_size, uint8_t* font_features_data,
+    int font_feature_data_size) {
+  FML_DCHECK(encodedSize == 8);
+
+  TextStyleDelta delta;
+  decodeTextStyle(encoded, fontFamilies, fontFamiliesSize, fontSize,
+                  letterSpacing, wordSpacing, height, decorationThickness,
+                  locale, background_objects, background_data,
+                  foreground_objects, foreground_data, shadows_data,
+                  shadow_data_size, font_features_data, font_feature_data_size,
+                  delta, m_content.get());
+  pushStyle(delta);
+}
+
+const char* ParagraphBuilder::pushStyleById(int id) {
+  FontCollection& font_collection =
+      UIMonoState::Current()->window()->client()->GetFontCollection();
+  const TextStyleDelta* delta = font_collection.text_style_table().Get(id);
+  if (delta == nullptr) return "text style id is not registered";
+
+  if (m_content) {
+    // Masks are never negative, so this cannot collide with a decoded style.
+    m_content->AppendInt(-1);
+    m_content->AppendInt(id);
   }
+  pushStyle(*delta);
+  return nullptr;
+}
+
+void ParagraphBuilder::pushStyle(const TextStyleDelta& delta) {
+  // Set to use the properties of the previous style if the property is not
+  // explicitly given.
+  txt::TextStyle style = m_paragraphBuilder->PeekStyle();
+  applyTextStyle(delta, style);
 
   m_paragraphBuilder->PushStyle(style);
+  if (m_content) m_content->PushStyle(style);
 }
 
-void ParagraphBuilder::pop() { m_paragraphBuilder->Pop(); }
+void ParagraphBuilder::pop() {
+  m_paragraphBuilder->Pop();
+  if (m_content) m_content->Pop();
+}
 
-const char* ParagraphBuilder::addText(const std::u16string& text) {
-  if (text.empty()) return nullptr;
+const char* ParagraphBuilder::addText(const char16_t* text, size_t length) {
+  if (text == nullptr || length == 0) return nullptr;
 
-  // Use ICU to validate the UTF-16 input.  Calling u_strToUTF8 with a null
-  // output buffer will return U_BUFFER_OVERFLOW_ERROR if the input is well
-  // formed.
-  const UChar* text_ptr = reinterpret_cast<const UChar*>(text.data());
-  UErrorCode error_code = U_ZERO_ERROR;
-  u_strToUTF8(nullptr, 0, nullptr, text_ptr, text.size(), &error_code);
-  if (error_code != U_BUFFER_OVERFLOW_ERROR)
+  // Validate in place, so that the text is only copied once on our side.
+  if (!IsWellFormedUTF16(text, length))
     return "string is not well-formed UTF-16";
 
-  m_paragraphBuilder->AddText(text);
+  std::u16string text_s(text, length);
+  m_paragraphBuilder->AddText(text_s);
+  if (m_content) m_content->AddText(std::move(text_s));
 
   return nullptr;
 }
 
 fml::RefPtr<Paragraph> ParagraphBuilder::build(
     /*Dart_Handle paragraph_handle*/) {
-  return Paragraph::Create(/*paragraph_handle,*/ m_paragraphBuilder->Build());
+  // The content is shared with the paragraph and must not change afterwards.
+  return Paragraph::Create(/*paragraph_handle,*/ m_paragraphBuilder->Build(),
+                           std::move(m_content));
 }
 
 const char* ParagraphBuilder::addPlaceholder(float width, float height,
@@ -420,6 +651,7 @@ const char* ParagraphBuilder::addPlaceholder(float width, float height,
       static_cast<txt::TextBaseline>(baseline), baseline_offset);
 
   m_paragraphBuilder->AddPlaceholder(placeholder_run);
+  if (m_content) m_content->AddPlaceholder(placeholder_run);
 
   return nullptr;
 }
@@ -464,11 +696,55 @@ ParagraphBuilder_pushStyle(ParagraphBuilder* ptr, int* encoded, int encodedSize,
                  foreground_objects, foreground_data, shadows_data,
                  shadow_data_size, font_features_data, font_feature_data_size);
 }
+
+UIWIDGETS_API(int)
+ParagraphBuilder_registerStyle(int* encoded, int encodedSize,
+                               char** fontFamilies, int fontFamiliesSize,
+                               float fontSize, float letterSpacing,
+                               float wordSpacing, float height,
+                               float decorationThickness, char* locale,
+                               void** background_objects,
+                               uint8_t* background_data,
+                               void** foreground_objects,
+                               uint8_t* foreground_data, uint8_t* shadows_data,
+                               int shadow_data_size,
+                               uint8_t* font_features_data,
+                               int font_feature_data_size) {
+  FML_DCHECK(encodedSize == 8);
+
+  TextStyleDelta delta;
+  ContentKey key;
+  decodeTextStyle(encoded, fontFamilies, fontFamiliesSize, fontSize,
+                  letterSpacing, wordSpacing, height, decorationThickness,
+                  locale, background_objects, background_data,
+                  foreground_objects, foreground_data, shadows_data,
+                  shadow_data_size, font_features_data, font_feature_data_size,
+                  delta, &key);
+
+  FontCollection& font_collection =
+      UIMonoState::Current()->window()->client()->GetFontCollection();
+  return font_collection.text_style_table().Register(std::move(key),
+                                                     std::move(delta));
+}
+
+UIWIDGETS_API(const char*)
+ParagraphBuilder_pushStyleById(ParagraphBuilder* ptr, int id) {
+  return ptr->pushStyleById(id);
+}
+
 UIWIDGETS_API(void) ParagraphBuilder_pop(ParagraphBuilder* ptr) { ptr->pop(); }
 
 UIWIDGETS_API(const char*)
 ParagraphBuilder_addText(ParagraphBuilder* ptr, char16_t* text) {
-  return ptr->addText(std::u16string(text));
+  return ptr->addText(text,
+                      text ? std::char_traits<char16_t>::length(text) : 0);
+}
+
+UIWIDGETS_API(const char*)
+ParagraphBuilder_addTextWithLength(ParagraphBuilder* ptr, char16_t* text,
+                                   int length) {
+  if (length < 0) return "text length must not be negative";
+  return ptr->addText(text, static_cast<size_t>(length));
 }
 
 UIWIDGETS_API(const char*)
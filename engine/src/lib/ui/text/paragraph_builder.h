@@ -1,10 +1,14 @@
 #pragma once
 
+#include <memory>
+
 #include "flutter/fml/memory/ref_counted.h"
 #include "txt/paragraph.h"
 #include "txt/paragraph_builder.h"
 #include "font_collection.h"
 #include "paragraph.h"
+#include "paragraph_layout_cache.h"
+#include "text_style_table.h"
 #include "lib/ui/painting/canvas.h"
 
 namespace uiwidgets {
@@ -19,6 +23,14 @@ class ParagraphBuilder : public fml::RefCountedThreadSafe<ParagraphBuilder> {
       const std::vector<std::string>& strutFontFamilies, float fontSize,
       float height, const std::u16string& ellipsis, const std::string& locale);
 
+  // Builds with |font_collection| instead of the one of the current window.
+  static fml::RefPtr<ParagraphBuilder> create(
+      int* encoded, uint8_t* structData, int structDataSize,
+      const std::string& fontFamily,
+      const std::vector<std::string>& strutFontFamilies, float fontSize,
+      float height, const std::u16string& ellipsis, const std::string& locale,
+      std::shared_ptr<txt::FontCollection> font_collection);
+
   void pushStyle(int* encoded, int encodedSize, char** fontFamilies,
                  int fontFamiliesSize, float fontSize, float letterSpacing,
                  float wordSpacing, float height, float decorationThickness,
@@ -28,7 +40,11 @@ class ParagraphBuilder : public fml::RefCountedThreadSafe<ParagraphBuilder> {
                  int shadow_data_size, uint8_t* font_features_data,
                  int font_feature_data_size);
 
-  const char* addText(const std::u16string& text);
+  // Pushes a style returned by ParagraphBuilder_registerStyle.
+  const char* pushStyleById(int id);
+
+  // |text| holds |length| UTF-16 code units and may contain NULs.
+  const char* addText(const char16_t* text, size_t length);
   const char* addPlaceholder(float width, float height, unsigned alignment,
                              float baseline_offset, unsigned baseline);
   fml::RefPtr<Paragraph> build(/*Dart_Handle paragraph_handle*/);
@@ -37,13 +53,22 @@ class ParagraphBuilder : public fml::RefCountedThreadSafe<ParagraphBuilder> {
   void pop();
 
  private:
-  explicit ParagraphBuilder(int* encoded, uint8_t* strutData,
-                            int strutData_size, const std::string& fontFamily,
-                            const std::vector<std::string>& strutFontFamilies,
-                            float fontSize, float height,
-                            const std::u16string& ellipsis,
-                            const std::string& locale);
+  explicit ParagraphBuilder(
+      int* encoded, uint8_t* strutData, int strutData_size,
+      const std::string& fontFamily,
+      const std::vector<std::string>& strutFontFamilies, float fontSize,
+      float height, const std::u16string& ellipsis, const std::string& locale,
+      std::shared_ptr<txt::FontCollection> font_collection);
+
+  void pushStyle(const TextStyleDelta& delta);
 
   std::unique_ptr<txt::ParagraphBuilder> m_paragraphBuilder;
+  // Records the calls above so that the built paragraph can share layouts
+  // with equal paragraphs.
+  std::shared_ptr<ParagraphContent> m_content;
 };
+
+// Returns whether the |length| code units at |text| are well formed UTF-16.
+bool IsWellFormedUTF16(const char16_t* text, size_t length);
+
 }  // namespace uiwidgets
\ No newline at end of file
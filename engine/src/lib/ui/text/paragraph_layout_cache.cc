@@ -0,0 +1,240 @@
+#include "paragraph_layout_cache.h"
+
+#include <cstring>
+
+#include "lib/ui/ui_mono_state.h"
+#include "txt/paragraph_builder.h"
+
+namespace uiwidgets {
+
+namespace {
+
+// We don't have an accurate accounting of the memory of a laid out
+// paragraph, so charge a fixed size (matching Paragraph::GetAllocationSize)
+// plus the glyphs, positions and runs kept for each code unit.
+constexpr size_t kEntryBytes = 2000;
+constexpr size_t kBytesPerCodeUnit = 48;
+
+constexpr uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+inline uint64_t HashCombine(uint64_t hash, uint64_t value) {
+  hash = (hash ^ value) * 0x100000001b3ull;
+  return hash ^ (hash >> 29);
+}
+
+}  // namespace
+
+ContentKey::ContentKey() : hash_(kHashSeed) {}
+
+ContentKey::~ContentKey() = default;
+
+void ContentKey::AppendInt(int32_t value) {
+  AppendBytes(&value, sizeof(value));
+}
+
+void ContentKey::AppendFloat(float value) {
+  AppendBytes(&value, sizeof(value));
+}
+
+void ContentKey::AppendBytes(const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  bytes_.append(reinterpret_cast<const char*>(bytes), size);
+
+  uint64_t hash = hash_;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(word));
+    hash = HashCombine(hash, word);
+  }
+  for (; i < size; i++) {
+    hash = HashCombine(hash, bytes[i]);
+  }
+  hash_ = static_cast<size_t>(hash);
+}
+
+void ContentKey::AppendString(const std::string& value) {
+  AppendInt(static_cast<int32_t>(value.size()));
+  AppendBytes(value.data(), value.size());
+}
+
+void ContentKey::AppendPaint(std::shared_ptr<const SkPaint> paint) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(paint.get());
+  AppendBytes(&address, sizeof(address));
+  paints_.push_back(std::move(paint));
+}
+
+bool ContentKey::operator==(const ContentKey& other) const {
+  return hash_ == other.hash_ && bytes_ == other.bytes_ &&
+         paints_ == other.paints_;
+}
+
+ParagraphContent::ParagraphContent(const txt::ParagraphStyle& paragraph_style)
+    : paragraph_style_(paragraph_style) {}
+
+ParagraphContent::~ParagraphContent() = default;
+
+void ParagraphContent::AppendOp(Op::Kind kind, size_t index) {
+  AppendInt(static_cast<int32_t>(kind));
+  ops_.push_back({kind, index});
+}
+
+void ParagraphContent::PushStyle(const txt::TextStyle& style) {
+  AppendOp(Op::kPushStyle, styles_.size());
+  styles_.push_back(style);
+}
+
+void ParagraphContent::Pop() { AppendOp(Op::kPop, 0); }
+
+void ParagraphContent::AddText(std::u16string text) {
+  AppendOp(Op::kAddText, texts_.size());
+  AppendInt(static_cast<int32_t>(text.size()));
+  AppendBytes(text.data(), text.size() * sizeof(char16_t));
+  text_length_ += text.size();
+  texts_.push_back(std::move(text));
+}
+
+void ParagraphContent::AddPlaceholder(const txt::PlaceholderRun& placeholder) {
+  AppendOp(Op::kAddPlaceholder, placeholders_.size());
+  AppendFloat(static_cast<float>(placeholder.width));
+  AppendFloat(static_cast<float>(placeholder.height));
+  AppendInt(static_cast<int32_t>(placeholder.alignment));
+  AppendInt(static_cast<int32_t>(placeholder.baseline));
+  AppendFloat(static_cast<float>(placeholder.baseline_offset));
+  placeholders_.push_back(placeholder);
+}
+
+std::unique_ptr<txt::Paragraph> ParagraphContent::Build(
+    std::shared_ptr<txt::FontCollection> font_collection) const {
+  auto builder = txt::ParagraphBuilder::CreateTxtBuilder(
+      paragraph_style_, std::move(font_collection));
+
+  for (const auto& op : ops_) {
+    switch (op.kind) {
+      case Op::kPushStyle:
+        builder->PushStyle(styles_[op.index]);
+        break;
+      case Op::kPop:
+        builder->Pop();
+        break;
+      case Op::kAddText:
+        builder->AddText(texts_[op.index]);
+        break;
+      case Op::kAddPlaceholder: {
+        txt::PlaceholderRun placeholder = placeholders_[op.index];
+        builder->AddPlaceholder(placeholder);
+        break;
+      }
+    }
+  }
+
+  return builder->Build();
+}
+
+bool ParagraphLayoutCache::Key::operator==(const Key& other) const {
+  return width == other.width &&
+         (content == other.content || *content == *other.content);
+}
+
+size_t ParagraphLayoutCache::KeyHash::operator()(const Key& key) const {
+  uint32_t width_bits;
+  memcpy(&width_bits, &key.width, sizeof(width_bits));
+  return static_cast<size_t>(HashCombine(key.content->hash(), width_bits));
+}
+
+ParagraphLayoutCache::ParagraphLayoutCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+ParagraphLayoutCache::~ParagraphLayoutCache() = default;
+
+std::shared_ptr<txt::Paragraph> ParagraphLayoutCache::Get(
+    const std::shared_ptr<const ParagraphContent>& content, float width) {
+  auto found = index_.find({content, width});
+  if (found == index_.end()) {
+    miss_count_++;
+    return nullptr;
+  }
+
+  hit_count_++;
+  entries_.splice(entries_.begin(), entries_, found->second);
+  return found->second->paragraph;
+}
+
+bool ParagraphLayoutCache::Put(
+    const std::shared_ptr<const ParagraphContent>& content, float width,
+    std::shared_ptr<txt::Paragraph> paragraph) {
+  const size_t bytes = EstimateBytes(*content);
+  // A single paragraph taking more than a quarter of the cache would evict
+  // most of the labels that are worth keeping.
+  if (bytes > max_bytes_ / 4) {
+    return false;
+  }
+
+  Key key = {content, width};
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    bytes_ -= found->second->bytes;
+    entries_.erase(found->second);
+    index_.erase(found);
+  }
+
+  EvictToFit(max_bytes_ - bytes);
+
+  entries_.push_front({key, std::move(paragraph), bytes});
+  index_.emplace(std::move(key), entries_.begin());
+  bytes_ += bytes;
+  return true;
+}
+
+void ParagraphLayoutCache::SetFontGeneration(size_t font_generation) {
+  if (font_generation != font_generation_) {
+    font_generation_ = font_generation;
+    Clear();
+  }
+}
+
+void ParagraphLayoutCache::SetMaxBytes(size_t max_bytes) {
+  max_bytes_ = max_bytes;
+  EvictToFit(max_bytes_);
+}
+
+void ParagraphLayoutCache::Clear() {
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+size_t ParagraphLayoutCache::EstimateBytes(const ParagraphContent& content) {
+  return kEntryBytes + content.text_length() * kBytesPerCodeUnit;
+}
+
+void ParagraphLayoutCache::EvictToFit(size_t max_bytes) {
+  while (bytes_ > max_bytes && !entries_.empty()) {
+    const Entry& entry = entries_.back();
+    bytes_ -= entry.bytes;
+    index_.erase(entry.key);
+    entries_.pop_back();
+  }
+}
+
+UIWIDGETS_API(size_t) ParagraphLayoutCache_entryCount() {
+  return UIMonoState::Current()->GetParagraphLayoutCache().GetEntryCount();
+}
+
+UIWIDGETS_API(size_t) ParagraphLayoutCache_byteSize() {
+  return UIMonoState::Current()->GetParagraphLayoutCache().GetByteSize();
+}
+
+UIWIDGETS_API(size_t) ParagraphLayoutCache_hitCount() {
+  return UIMonoState::Current()->GetParagraphLayoutCache().hit_count();
+}
+
+UIWIDGETS_API(size_t) ParagraphLayoutCache_missCount() {
+  return UIMonoState::Current()->GetParagraphLayoutCache().miss_count();
+}
+
+UIWIDGETS_API(void) ParagraphLayoutCache_setMaxBytes(size_t max_bytes) {
+  UIMonoState::Current()->GetParagraphLayoutCache().SetMaxBytes(max_bytes);
+}
+
+}  // namespace uiwidgets
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "include/core/SkPaint.h"
+#include "txt/font_collection.h"
+#include "txt/paragraph.h"
+#include "txt/paragraph_style.h"
+#include "txt/placeholder_run.h"
+#include "txt/text_style.h"
+
+namespace uiwidgets {
+
+// The encoded arguments of builder calls, compared byte for byte.
+class ContentKey {
+ public:
+  ContentKey();
+
+  ~ContentKey();
+
+  void AppendInt(int32_t value);
+
+  void AppendFloat(float value);
+
+  void AppendBytes(const void* data, size_t size);
+
+  void AppendString(const std::string& value);
+
+  // Paints are compared by identity. The key holds a reference to each of
+  // them, so their addresses cannot be reused while it is alive.
+  void AppendPaint(std::shared_ptr<const SkPaint> paint);
+
+  size_t hash() const { return hash_; }
+
+  bool operator==(const ContentKey& other) const;
+
+  struct Hash {
+    size_t operator()(const ContentKey& key) const { return key.hash(); }
+  };
+
+ private:
+  std::string bytes_;
+  std::vector<std::shared_ptr<const SkPaint>> paints_;
+  size_t hash_;
+};
+
+// The encoded arguments of the builder calls a paragraph was made from, and
+// enough of the decoded styles to build it again. Paragraphs with equal
+// contents lay out identically at the same width.
+class ParagraphContent : public ContentKey {
+ public:
+  explicit ParagraphContent(const txt::ParagraphStyle& paragraph_style);
+
+  ~ParagraphContent();
+
+  void PushStyle(const txt::TextStyle& style);
+
+  void Pop();
+
+  void AddText(std::u16string text);
+
+  void AddPlaceholder(const txt::PlaceholderRun& placeholder);
+
+  std::unique_ptr<txt::Paragraph> Build(
+      std::shared_ptr<txt::FontCollection> font_collection) const;
+
+  size_t text_length() const { return text_length_; }
+
+ private:
+  struct Op {
+    enum Kind { kPushStyle, kPop, kAddText, kAddPlaceholder };
+
+    Kind kind;
+    size_t index;
+  };
+
+  const txt::ParagraphStyle paragraph_style_;
+  std::vector<Op> ops_;
+  std::vector<txt::TextStyle> styles_;
+  std::vector<std::u16string> texts_;
+  std::vector<txt::PlaceholderRun> placeholders_;
+  size_t text_length_ = 0;
+
+  void AppendOp(Op::Kind kind, size_t index);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ParagraphContent);
+};
+
+// Keeps laid out paragraphs so that paragraphs built from the same content
+// and laid out at the same width share one shaped and line broken result.
+// The cached paragraphs are never laid out again. Owned by the UIMonoState
+// and only used on the UI thread.
+class ParagraphLayoutCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+  explicit ParagraphLayoutCache(size_t max_bytes = kDefaultMaxBytes);
+
+  ~ParagraphLayoutCache();
+
+  // Returns the paragraph laid out from |content| at |width|, or null.
+  std::shared_ptr<txt::Paragraph> Get(
+      const std::shared_ptr<const ParagraphContent>& content, float width);
+
+  // Takes |paragraph|, which was just laid out from |content| at |width|.
+  // Returns false if the paragraph does not fit in the cache.
+  bool Put(const std::shared_ptr<const ParagraphContent>& content, float width,
+           std::shared_ptr<txt::Paragraph> paragraph);
+
+  // Drops every entry if the fonts changed since they were laid out.
+  void SetFontGeneration(size_t font_generation);
+
+  void SetMaxBytes(size_t max_bytes);
+
+  void Clear();
+
+  size_t GetEntryCount() const { return entries_.size(); }
+
+  size_t GetByteSize() const { return bytes_; }
+
+  size_t hit_count() const { return hit_count_; }
+
+  size_t miss_count() const { return miss_count_; }
+
+ private:
+  struct Key {
+    std::shared_ptr<const ParagraphContent> content;
+    float width;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<txt::Paragraph> paragraph;
+    size_t bytes;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  size_t max_bytes_;
+  size_t bytes_ = 0;
+  size_t font_generation_ = 0;
+  EntryList entries_;  // Most recently used first.
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+
+  static size_t EstimateBytes(const ParagraphContent& content);
+
+  void EvictToFit(size_t max_bytes);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ParagraphLayoutCache);
+};
+
+}  // namespace uiwidgets
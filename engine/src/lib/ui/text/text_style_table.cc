@@ -0,0 +1,21 @@
+#include "text_style_table.h"
+
+namespace uiwidgets {
+
+TextStyleTable::TextStyleTable() = default;
+
+TextStyleTable::~TextStyleTable() = default;
+
+int TextStyleTable::Register(ContentKey key, TextStyleDelta style) {
+  auto found = ids_.find(key);
+  if (found != ids_.end()) {
+    return found->second;
+  }
+
+  styles_.push_back(std::make_unique<TextStyleDelta>(std::move(style)));
+  const int id = static_cast<int>(styles_.size());
+  ids_.emplace(std::move(key), id);
+  return id;
+}
+
+}  // namespace uiwidgets
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "paragraph_layout_cache.h"
+#include "txt/text_style.h"
+
+namespace uiwidgets {
+
+// The properties set by one pushStyle call. The properties outside of |mask|
+// are inherited from the enclosing style when it is pushed.
+struct TextStyleDelta {
+  int32_t mask = 0;
+  txt::TextStyle style;
+  std::vector<uint8_t> font_features_data;
+};
+
+// Text styles that are registered once and then pushed by id, which saves
+// decoding their arguments for every run. Registering the same arguments
+// again returns the same id. Ids stay valid for the lifetime of the owning
+// FontCollection. Only used on the UI thread.
+class TextStyleTable {
+ public:
+  TextStyleTable();
+
+  ~TextStyleTable();
+
+  int Register(ContentKey key, TextStyleDelta style);
+
+  // Returns null if |id| was not returned by Register.
+  const TextStyleDelta* Get(int id) const {
+    if (id <= 0 || static_cast<size_t>(id) > styles_.size()) {
+      return nullptr;
+    }
+    return styles_[id - 1].get();
+  }
+
+  size_t GetCount() const { return styles_.size(); }
+
+ private:
+  std::unordered_map<ContentKey, int, ContentKey::Hash> ids_;
+  std::vector<std::unique_ptr<const TextStyleDelta>> styles_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TextStyleTable);
+};
+
+}  // namespace uiwidgets
@@ -10,6 +10,8 @@
 #include "snapshot_delegate.h"
 #include "lib/ui/window/window.h"
 #include "lib/ui/painting/image_decoder.h"
+#include "lib/ui/painting/paint_cache.h"
+#include "lib/ui/text/paragraph_layout_cache.h"
 
 namespace uiwidgets {
 class UIMonoState : public MonoState {
@@ -37,6 +39,12 @@ class UIMonoState : public MonoState {
 
   fml::WeakPtr<ImageDecoder> GetImageDecoder() const;
 
+  PaintCache& GetPaintCache() { return paint_cache_; }
+
+  ParagraphLayoutCache& GetParagraphLayoutCache() {
+    return paragraph_layout_cache_;
+  }
+
   template <class T>
   static SkiaGPUObject<T> CreateGPUObject(sk_sp<T> object) {
     if (!object) {
@@ -70,6 +78,8 @@ class UIMonoState : public MonoState {
   fml::WeakPtr<ImageDecoder> image_decoder_;
   std::unique_ptr<Window> window_;
   MonoMicrotaskQueue microtask_queue_;
+  PaintCache paint_cache_;
+  ParagraphLayoutCache paragraph_layout_cache_;
 
   void AddOrRemoveTaskObserver(bool add);
 };
@@ -0,0 +1,97 @@
+#include <memory>
+#include <vector>
+
+#include "benchmarking/benchmarking.h"
+#include "lib/ui/window/pointer_data_packet_converter.h"
+
+namespace uiwidgets {
+
+namespace {
+
+PointerData MakePointerData(PointerData::Change change,
+                            PointerData::DeviceKind kind, int64_t device,
+                            double x, double y, int64_t buttons) {
+  PointerData data;
+  data.Clear();
+  data.change = change;
+  data.kind = kind;
+  data.device = device;
+  data.physical_x = x;
+  data.physical_y = y;
+  data.buttons = buttons;
+  return data;
+}
+
+std::unique_ptr<PointerDataPacket> MakePacket(
+    const std::vector<PointerData>& events) {
+  auto packet = std::make_unique<PointerDataPacket>(events.size());
+  for (size_t i = 0; i < events.size(); i++) {
+    packet->SetPointerData(i, events[i]);
+  }
+  return packet;
+}
+
+}  // namespace
+
+// A mouse moving without a button down, one packet per frame.
+static void BM_PointerConvertHover(benchmark::State& state) {
+  const int count = state.range(0);
+  PointerDataPacketConverter converter;
+  converter.Convert(MakePacket({MakePointerData(
+      PointerData::Change::kAdd, PointerData::DeviceKind::kMouse, 0, 0, 0,
+      0)}));
+
+  std::vector<PointerData> events;
+  for (int i = 0; i < count; i++) {
+    events.push_back(MakePointerData(PointerData::Change::kHover,
+                                     PointerData::DeviceKind::kMouse, 0, i,
+                                     i * 2, 0));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(converter.Convert(MakePacket(events)));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PointerConvertHover)->Arg(1)->Arg(16)->Arg(256);
+
+// Ten fingers each going down, moving and going up within a packet.
+static void BM_PointerConvertTouch(benchmark::State& state) {
+  const int moves = state.range(0);
+  const int kFingers = 10;
+  PointerDataPacketConverter converter;
+  std::vector<PointerData> add_events;
+  for (int finger = 0; finger < kFingers; finger++) {
+    add_events.push_back(MakePointerData(PointerData::Change::kAdd,
+                                         PointerData::DeviceKind::kTouch,
+                                         finger, 0, 0, 0));
+  }
+  converter.Convert(MakePacket(add_events));
+
+  std::vector<PointerData> events;
+  for (int finger = 0; finger < kFingers; finger++) {
+    events.push_back(MakePointerData(PointerData::Change::kDown,
+                                     PointerData::DeviceKind::kTouch, finger,
+                                     finger * 10, 0, 1));
+  }
+  for (int i = 1; i <= moves; i++) {
+    for (int finger = 0; finger < kFingers; finger++) {
+      events.push_back(MakePointerData(PointerData::Change::kMove,
+                                       PointerData::DeviceKind::kTouch,
+                                       finger, finger * 10, i, 1));
+    }
+  }
+  for (int finger = 0; finger < kFingers; finger++) {
+    events.push_back(MakePointerData(PointerData::Change::kUp,
+                                     PointerData::DeviceKind::kTouch, finger,
+                                     finger * 10, moves, 0));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(converter.Convert(MakePacket(events)));
+  }
+  state.SetItemsProcessed(state.iterations() * events.size());
+}
+BENCHMARK(BM_PointerConvertTouch)->Arg(1)->Arg(16);
+
+}  // namespace uiwidgets
@@ -14,7 +14,9 @@
 #include "flutter/fml/unique_fd.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPictureRecorder.h"
+#include "lib/ui/painting/skottie_frame_cache.h"
 #include "lib/ui/text/font_collection.h"
+#include "runtime/mono_isolate.h"
 #include "rapidjson/document.h"
 #include "shell/common/animator.h"
 #include "shell/common/platform_view.h"
@@ -173,6 +175,17 @@ void Engine::NotifyIdle(int64_t deadline) {
   runtime_controller_->NotifyIdle(deadline);
 }
 
+void Engine::NotifyLowMemoryWarning() {
+  TRACE_EVENT0("uiwidgets", "Engine::NotifyLowMemoryWarning");
+  // Cached paragraphs hold on to the typefaces they were laid out with.
+  if (auto root_isolate = runtime_controller_->GetRootIsolate().lock()) {
+    root_isolate->GetParagraphLayoutCache().Clear();
+  }
+  font_collection_.PurgeUnusedTypefaces();
+  image_decoder_.PurgeCache();
+  SkottieFrameCache::GetInstance().Purge();
+}
+
 void Engine::OnOutputSurfaceCreated() {
   have_surface_ = true;
   StartAnimatorIfPossible();
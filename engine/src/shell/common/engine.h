@@ -67,6 +67,8 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
 
   void NotifyIdle(int64_t deadline);
 
+  void NotifyLowMemoryWarning();
+
   void ReportTimings(std::vector<int64_t> timings);
 
   void OnOutputSurfaceCreated();
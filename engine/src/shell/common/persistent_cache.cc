@@ -179,6 +179,13 @@ sk_sp<SkData> PersistentCache::load(const SkData& key) {
   return result;
 }
 
+sk_sp<SkData> PersistentCache::LoadData(const std::string& file_name) {
+  if (!IsValid()) {
+    return nullptr;
+  }
+  return PersistentCache::LoadFile(*cache_directory_, file_name);
+}
+
 static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
                                  std::shared_ptr<fml::UniqueFD> cache_directory,
                                  std::string key,
@@ -239,6 +246,18 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
                        std::move(file_name), std::move(mapping));
 }
 
+void PersistentCache::StoreData(const std::string& file_name,
+                                const SkData& data) {
+  if (is_read_only_ || !IsValid() || data.size() == 0) {
+    return;
+  }
+
+  auto mapping = std::make_unique<fml::DataMapping>(
+      std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
+  PersistentCacheStore(GetWorkerTaskRunner(), cache_directory_, file_name,
+                       std::move(mapping));
+}
+
 void PersistentCache::DumpSkp(const SkData& data) {
   if (is_read_only_ || !IsValid()) {
     FML_LOG(ERROR) << "Could not dump SKP from read-only or invalid persistent "
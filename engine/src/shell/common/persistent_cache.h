@@ -55,6 +55,11 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // |GrContextOptions::PersistentCache|
   sk_sp<SkData> load(const SkData& key) override;
 
+  // Reads and writes engine data that does not come from Skia, such as the
+  // font fallback index, as |file_name| in the cache directory.
+  sk_sp<SkData> LoadData(const std::string& file_name);
+  void StoreData(const std::string& file_name, const SkData& data);
+
   using SkSLCache = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
 
   /// Load all the SkSL shader caches in the right directory.
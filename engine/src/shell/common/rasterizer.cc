@@ -9,6 +9,7 @@
 #include "include/core/SkSurface.h"
 #include "include/core/SkSurfaceCharacterization.h"
 #include "include/utils/SkBase64.h"
+#include "lib/ui/painting/pixel_buffer_pool.h"
 #include "persistent_cache.h"
 
 namespace uiwidgets {
@@ -30,6 +31,15 @@ Rasterizer::Rasterizer(Delegate& delegate, TaskRunners task_runners,
       user_override_resource_cache_bytes_(false),
       weak_factory_(this) {
   FML_DCHECK(compositor_context_);
+  const Settings& settings = delegate_.GetSettings();
+  if (settings.raster_cache_max_bytes > 0) {
+    compositor_context_->raster_cache().SetMaxBytes(
+        settings.raster_cache_max_bytes);
+  }
+  if (settings.raster_cache_max_unused_frames > 0) {
+    compositor_context_->raster_cache().SetMaxUnusedFrames(
+        settings.raster_cache_max_unused_frames);
+  }
 }
 
 Rasterizer::~Rasterizer() = default;
@@ -65,6 +75,7 @@ void Rasterizer::Teardown() {
 }
 
 void Rasterizer::NotifyLowMemoryWarning() const {
+  PixelBufferPool::GetInstance().Trim();
   if (!surface_) {
     FML_DLOG(INFO) << "Rasterizer::PurgeCaches called with no surface.";
     return;
@@ -77,6 +88,12 @@ void Rasterizer::NotifyLowMemoryWarning() const {
   context->freeGpuResources();
 }
 
+void Rasterizer::SetRasterCacheTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  compositor_context_->raster_cache().SetConcurrentTaskRunner(
+      std::move(task_runner));
+}
+
 TextureRegistry* Rasterizer::GetTextureRegistry() {
   return &compositor_context_->texture_registry();
 }
@@ -141,9 +158,28 @@ sk_sp<SkImage> Rasterizer::DoMakeRasterSnapshot(
   SkImageInfo image_info = SkImageInfo::MakeN32Premul(
       size.width(), size.height(), SkColorSpace::MakeSRGB());
   if (surface_ == nullptr || surface_->GetContext() == nullptr) {
-    // Raster surface is fine if there is no on screen surface. This might
-    // happen in case of software rendering.
-    surface = SkSurface::MakeRaster(image_info);
+    // Raster canvas is fine if there is no on screen surface. This might
+    // happen in case of software rendering. It draws into pooled pixels,
+    // which the returned image shares.
+    SkBitmap bitmap;
+    if (!PixelBufferPool::GetInstance().TryAllocPixels(&bitmap, image_info)) {
+      if (surface_) {
+        surface_->ClearContext();
+      }
+      return nullptr;
+    }
+    // Pooled pixels keep what was drawn into them before.
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    {
+      SkCanvas canvas(bitmap);
+      draw_callback(&canvas);
+      canvas.flush();
+    }
+    if (surface_) {
+      surface_->ClearContext();
+    }
+    bitmap.setImmutable();
+    return SkImage::MakeFromBitmap(bitmap);
   } else {
     if (!surface_->MakeRenderContextCurrent()) {
       surface_->ClearContext();
@@ -179,9 +215,13 @@ sk_sp<SkImage> Rasterizer::DoMakeRasterSnapshot(
 
   {
     TRACE_EVENT0("uiwidgets", "DeviceHostTransfer");
-    if (auto raster_image = device_snapshot->makeRasterImage()) {
+    SkBitmap bitmap;
+    if (PixelBufferPool::GetInstance().TryAllocPixels(
+            &bitmap, device_snapshot->imageInfo()) &&
+        device_snapshot->readPixels(bitmap.pixmap(), 0, 0)) {
       surface_->ClearContext();
-      return raster_image;
+      bitmap.setImmutable();
+      return SkImage::MakeFromBitmap(bitmap);
     }
   }
 
@@ -254,6 +294,15 @@ RasterStatus Rasterizer::DoDraw(std::unique_ptr<LayerTree> layer_tree) {
   // for Fuchsia to capture SceneUpdateContext::ExecutePaintTasks.
   timing.Set(FrameTiming::kRasterFinish, fml::TimePoint::Now());
   delegate_.OnFrameRasterized(timing);
+  PixelBufferPool::GetInstance().TraceStatsToTimeline();
+
+  FrameStageTimings& stage_timings = compositor_context_->stage_timings();
+  stage_timings.Add(FrameStageTimings::kBuild,
+                    timing.Get(FrameTiming::kBuildFinish) -
+                        timing.Get(FrameTiming::kBuildStart));
+  stage_timings.Add(FrameStageTimings::kRaster,
+                    timing.Get(FrameTiming::kRasterFinish) -
+                        timing.Get(FrameTiming::kRasterStart));
 
   // Pipeline pressure is applied from a couple of places:
   // rasterizer: When there are more items as of the time of Consume.
@@ -326,10 +375,20 @@ RasterStatus Rasterizer::DrawToSurface(LayerTree& layer_tree) {
   );
 
   if (compositor_frame) {
-    RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
+    // Damage can only be limited when the surface still holds the pixels of
+    // the previously submitted layer tree.
+    const LayerTree* previous_layer_tree =
+        frame->preserves_contents() && external_view_embedder == nullptr &&
+                last_layer_tree_.get() != &layer_tree
+            ? last_layer_tree_.get()
+            : nullptr;
+    RasterStatus raster_status = compositor_frame->Raster(
+        layer_tree, false, true, previous_layer_tree);
     if (raster_status == RasterStatus::kFailed) {
       return raster_status;
     }
+    frame->set_damage(compositor_frame->damage());
+    const fml::TimePoint submit_start = fml::TimePoint::Now();
     if (external_view_embedder != nullptr) {
       external_view_embedder->SubmitFrame(surface_->GetContext(),
                                           root_surface_canvas);
@@ -342,6 +401,8 @@ RasterStatus Rasterizer::DrawToSurface(LayerTree& layer_tree) {
     } else {
       frame->Submit();
     }
+    compositor_context_->stage_timings().Add(
+        FrameStageTimings::kSubmit, fml::TimePoint::Now() - submit_start);
 
     FireNextFrameCallbackIfPresent();
 
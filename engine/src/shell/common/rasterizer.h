@@ -8,6 +8,7 @@
 #include "flow/compositor_context.h"
 #include "flow/layers/layer_tree.h"
 #include "flutter/fml/closure.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/raster_thread_merger.h"
 #include "flutter/fml/synchronization/waitable_event.h"
@@ -23,6 +24,7 @@ class Rasterizer final : public SnapshotDelegate {
    public:
     virtual void OnFrameRasterized(const FrameTiming& frame_timing) = 0;
     virtual fml::Milliseconds GetFrameBudget() = 0;
+    virtual const Settings& GetSettings() const = 0;
   };
 
   Rasterizer(Delegate& delegate, TaskRunners task_runners);
@@ -38,6 +40,11 @@ class Rasterizer final : public SnapshotDelegate {
 
   void NotifyLowMemoryWarning() const;
 
+  // Lets the raster cache populate its entries on |task_runner|. See
+  // RasterCache::SetConcurrentTaskRunner.
+  void SetRasterCacheTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
   fml::WeakPtr<Rasterizer> GetWeakPtr() const;
 
   fml::WeakPtr<SnapshotDelegate> GetSnapshotDelegate() const;
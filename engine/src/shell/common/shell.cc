@@ -365,6 +365,12 @@ void Shell::NotifyLowMemoryWarning() const {
   // running.
   // ::Dart_NotifyLowMemory();
 
+  task_runners_.GetUITaskRunner()->PostTask(
+      [engine = weak_engine_]() {
+        if (engine) {
+          engine->NotifyLowMemoryWarning();
+        }
+      });
   task_runners_.GetRasterTaskRunner()->PostTask(
       [rasterizer = rasterizer_->GetWeakPtr()]() {
         if (rasterizer) {
@@ -460,6 +466,19 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
   // https://github.com/flutter/flutter/issues/42947
   display_refresh_rate_ = weak_engine_.getUnsafe()->GetDisplayRefreshRate();
 
+  if (settings_.raster_cache_async_population) {
+    fml::TaskRunner::RunNowOrPostTask(
+        task_runners_.GetRasterTaskRunner(),
+        [rasterizer = weak_rasterizer_,
+         task_runner = weak_engine_.getUnsafe()
+                           ->GetConcurrentMessageLoop()
+                           ->GetTaskRunner()]() {
+          if (rasterizer) {
+            rasterizer->SetRasterCacheTaskRunner(task_runner);
+          }
+        });
+  }
+
   return true;
 }
 
@@ -1044,6 +1063,30 @@ Rasterizer::Screenshot Shell::Screenshot(
   return screenshot;
 }
 
+std::string Shell::GetFrameStageTimings(bool reset) {
+  TRACE_EVENT0("uiwidgets", "Shell::GetFrameStageTimings");
+  fml::AutoResetWaitableEvent latch;
+  std::string timings;
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners_.GetRasterTaskRunner(), [&latch,                        //
+                                            rasterizer = GetRasterizer(),  //
+                                            &timings,                      //
+                                            reset                          //
+  ]() {
+        if (rasterizer) {
+          FrameStageTimings& stage_timings =
+              rasterizer->compositor_context()->stage_timings();
+          timings = stage_timings.ToJSON();
+          if (reset) {
+            stage_timings.Reset();
+          }
+        }
+        latch.Signal();
+      });
+  latch.Wait();
+  return timings;
+}
+
 fml::Status Shell::WaitForFirstFrame(fml::TimeDelta timeout) {
   FML_DCHECK(is_setup_);
   if (task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread() ||
@@ -51,7 +51,8 @@ class Shell final : public PlatformView::Delegate,
   void RunEngine(RunConfiguration run_configuration,
                  const std::function<void(Engine::RunStatus)>& result_callback);
 
-  const Settings& GetSettings() const;
+  // |Rasterizer::Delegate|
+  const Settings& GetSettings() const override;
 
   const TaskRunners& GetTaskRunners() const;
 
@@ -70,6 +71,11 @@ class Shell final : public PlatformView::Delegate,
 
   fml::Status WaitForFirstFrame(fml::TimeDelta timeout);
 
+  // Returns the per stage timings of the frames rasterized so far as JSON.
+  // With |reset|, the next call only covers the frames rasterized after this
+  // one.
+  std::string GetFrameStageTimings(bool reset);
+
   bool ReloadSystemFonts();
 
   std::shared_ptr<fml::SyncSwitch> GetIsGpuDisabledSyncSwitch() const;
@@ -15,6 +15,14 @@ SurfaceFrame::SurfaceFrame(sk_sp<SkSurface> surface,
   FML_DCHECK(submit_callback_);
 }
 
+SurfaceFrame::SurfaceFrame(sk_sp<SkSurface> surface,
+                           SkCanvas* canvas,
+                           bool supports_readback,
+                           const SubmitCallback& submit_callback)
+    : SurfaceFrame(std::move(surface), supports_readback, submit_callback) {
+  canvas_ = canvas;
+}
+
 SurfaceFrame::~SurfaceFrame() {
   if (submit_callback_ && !submitted_) {
     // Dropping without a Submit.
@@ -33,6 +41,9 @@ bool SurfaceFrame::Submit() {
 }
 
 SkCanvas* SurfaceFrame::SkiaCanvas() {
+  if (canvas_ != nullptr) {
+    return canvas_;
+  }
   return surface_ != nullptr ? surface_->getCanvas() : nullptr;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
 #include "flow/compositor_context.h"
 #include "flow/embedded_views.h"
@@ -20,6 +21,14 @@ class SurfaceFrame {
                bool supports_readback,
                const SubmitCallback& submit_callback);
 
+  /// Creates a frame that is drawn into |canvas| instead of the canvas of
+  /// |surface|. The submit callback is responsible for transferring what was
+  /// drawn to |surface|.
+  SurfaceFrame(sk_sp<SkSurface> surface,
+               SkCanvas* canvas,
+               bool supports_readback,
+               const SubmitCallback& submit_callback);
+
   ~SurfaceFrame();
 
   bool Submit();
@@ -30,10 +39,27 @@ class SurfaceFrame {
 
   bool supports_readback() { return supports_readback_; }
 
+  /// Whether the surface still holds the pixels of the previously submitted
+  /// frame, so that only the region that changed needs to be repainted.
+  bool preserves_contents() const { return preserves_contents_; }
+
+  void set_preserves_contents(bool preserves_contents) {
+    preserves_contents_ = preserves_contents;
+  }
+
+  /// The region of the surface that was repainted for this frame, or nullopt
+  /// if the whole surface was repainted.
+  const std::optional<SkIRect>& damage() const { return damage_; }
+
+  void set_damage(const std::optional<SkIRect>& damage) { damage_ = damage; }
+
  private:
   bool submitted_;
   sk_sp<SkSurface> surface_;
+  SkCanvas* canvas_ = nullptr;
   bool supports_readback_;
+  bool preserves_contents_ = false;
+  std::optional<SkIRect> damage_;
   SubmitCallback submit_callback_;
 
   bool PerformSubmit();
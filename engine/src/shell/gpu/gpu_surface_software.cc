@@ -1,15 +1,57 @@
 #include "gpu_surface_software.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/utils/SkNWayCanvas.h"
 
 namespace uiwidgets {
 
+namespace {
+
+// Forwards to the picture recorder of a tiled frame and notes whether
+// anything reads back from the destination. Backdrop filters near a tile
+// edge would need pixels of the neighbouring tiles, so such frames are
+// rasterized in one piece.
+class TileRecordingCanvas final : public SkNWayCanvas {
+ public:
+  TileRecordingCanvas(int width, int height) : SkNWayCanvas(width, height) {}
+
+  bool reads_backdrop() const { return reads_backdrop_; }
+
+ protected:
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+    if (rec.fBackdrop != nullptr) {
+      reads_backdrop_ = true;
+    }
+    return SkNWayCanvas::getSaveLayerStrategy(rec);
+  }
+
+ private:
+  bool reads_backdrop_ = false;
+};
+
+struct TiledFrameRecording {
+  SkPictureRecorder recorder;
+  std::unique_ptr<TileRecordingCanvas> canvas;
+};
+
+}  // namespace
+
 GPUSurfaceSoftware::GPUSurfaceSoftware(GPUSurfaceSoftwareDelegate* delegate,
-                                       bool render_to_surface)
+                                       bool render_to_surface,
+                                       const GPUSurfaceSoftwareTiling& tiling)
     : delegate_(delegate),
       render_to_surface_(render_to_surface),
+      tiling_(tiling),
       weak_factory_(this) {}
 
 GPUSurfaceSoftware::~GPUSurfaceSoftware() = default;
@@ -53,6 +95,17 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   SkCanvas* canvas = backing_store->getCanvas();
   canvas->resetMatrix();
 
+  const bool preserves_contents =
+      delegate_->BackingStorePreservesContents() &&
+      backing_store == last_backing_store_ &&
+      backing_store->generationID() == last_generation_id_;
+
+  if (tiling_.tile_size > 0) {
+    auto frame = AcquireTiledFrame(std::move(backing_store));
+    frame->set_preserves_contents(preserves_contents);
+    return frame;
+  }
+
   SurfaceFrame::SubmitCallback on_submit =
       [self = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) -> bool {
@@ -63,10 +116,139 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
 
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    return self->PresentFrame(surface_frame);
+  };
+
+  auto frame = std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  frame->set_preserves_contents(preserves_contents);
+  return frame;
+}
+
+std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireTiledFrame(
+    sk_sp<SkSurface> backing_store) {
+  const SkIRect bounds =
+      SkIRect::MakeWH(backing_store->width(), backing_store->height());
+
+  auto recording = std::make_shared<TiledFrameRecording>();
+  // The bounding box hierarchy lets each tile skip the ops outside of it.
+  SkRTreeFactory rtree_factory;
+  SkCanvas* recorder_canvas =
+      recording->recorder.beginRecording(SkRect::Make(bounds), &rtree_factory);
+  recording->canvas = std::make_unique<TileRecordingCanvas>(bounds.width(),
+                                                            bounds.height());
+  recording->canvas->addCanvas(recorder_canvas);
+  SkCanvas* frame_canvas = recording->canvas.get();
+
+  SurfaceFrame::SubmitCallback on_submit =
+      [self = weak_factory_.GetWeakPtr(), recording, bounds](
+          const SurfaceFrame& surface_frame, SkCanvas* canvas) -> bool {
+    // If the surface itself went away, there is nothing more to do.
+    if (!self || !self->IsValid() || canvas == nullptr) {
+      return false;
+    }
+
+    sk_sp<SkPicture> picture = recording->recorder.finishRecordingAsPicture();
+    if (!picture) {
+      return false;
+    }
+
+    SkIRect dirty_rect = bounds;
+    if (const auto& damage = surface_frame.damage()) {
+      if (!dirty_rect.intersect(*damage)) {
+        dirty_rect.setEmpty();
+      }
+    }
+
+    if (!dirty_rect.isEmpty()) {
+      self->RasterizeTiles(surface_frame.SkiaSurface().get(), *picture,
+                           dirty_rect, !recording->canvas->reads_backdrop());
+    }
+
+    return self->PresentFrame(surface_frame);
+  };
+
+  return std::make_unique<SurfaceFrame>(std::move(backing_store), frame_canvas,
+                                        true, on_submit);
+}
+
+void GPUSurfaceSoftware::RasterizeTiles(SkSurface* backing_store,
+                                        const SkPicture& picture,
+                                        const SkIRect& dirty_rect,
+                                        bool can_split) {
+  TRACE_EVENT0("uiwidgets", "GPUSurfaceSoftware::RasterizeTiles");
+
+  // The tiles write to the pixels behind the back of |backing_store|, so
+  // invalidate anything derived from its previous contents.
+  backing_store->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+
+  SkPixmap pixmap;
+  if (!can_split || !backing_store->peekPixels(&pixmap)) {
+    SkCanvas* canvas = backing_store->getCanvas();
+    canvas->drawPicture(&picture);
+    canvas->flush();
+    return;
+  }
+
+  const int tile_size = tiling_.tile_size;
+  std::vector<SkIRect> tiles;
+  for (int top = dirty_rect.top(); top < dirty_rect.bottom();
+       top += tile_size) {
+    for (int left = dirty_rect.left(); left < dirty_rect.right();
+         left += tile_size) {
+      tiles.push_back(SkIRect::MakeLTRB(
+          left, top, std::min(left + tile_size, dirty_rect.right()),
+          std::min(top + tile_size, dirty_rect.bottom())));
+    }
+  }
+
+  size_t thread_count = tiling_.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const size_t helper_count = std::min(thread_count, tiles.size()) - 1;
+  if (helper_count > 0 && !tile_loop_) {
+    tile_loop_ = fml::ConcurrentMessageLoop::Create(thread_count - 1);
+  }
+
+  // The raster thread and the helpers take tiles until none are left.
+  std::atomic<size_t> next_tile(0);
+  auto rasterize_tiles = [&tiles, &next_tile, &pixmap, &picture]() {
+    for (size_t index = next_tile++; index < tiles.size();
+         index = next_tile++) {
+      const SkIRect& tile = tiles[index];
+      sk_sp<SkSurface> tile_surface = SkSurface::MakeRasterDirect(
+          pixmap.info().makeWH(tile.width(), tile.height()),
+          pixmap.writable_addr(tile.left(), tile.top()), pixmap.rowBytes());
+      if (!tile_surface) {
+        continue;
+      }
+      SkCanvas* canvas = tile_surface->getCanvas();
+      canvas->translate(-tile.left(), -tile.top());
+      canvas->drawPicture(&picture);
+    }
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  fml::CountDownLatch latch(helper_count);
+  auto task_runner = tile_loop_ ? tile_loop_->GetTaskRunner() : nullptr;
+  for (size_t i = 0; i < helper_count; i++) {
+    task_runner->PostTask([&rasterize_tiles, &latch]() {
+      rasterize_tiles();
+      latch.CountDown();
+    });
+  }
+  rasterize_tiles();
+  latch.Wait();
+}
+
+bool GPUSurfaceSoftware::PresentFrame(const SurfaceFrame& surface_frame) {
+  sk_sp<SkSurface> surface = surface_frame.SkiaSurface();
+  last_backing_store_ = surface;
+  last_generation_id_ = surface->generationID();
+
+  if (const auto& damage = surface_frame.damage()) {
+    return delegate_->PresentBackingStoreRegion(std::move(surface), *damage);
+  }
+  return delegate_->PresentBackingStore(std::move(surface));
 }
 
 // |Surface|
@@ -1,16 +1,31 @@
 #pragma once
 
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "include/core/SkPicture.h"
 #include "shell/common/surface.h"
 #include "shell/gpu/gpu_surface_software_delegate.h"
 
 namespace uiwidgets {
 
+// Lets GPUSurfaceSoftware record each frame and play it back in tiles on
+// several threads instead of rasterizing it on the raster thread alone.
+struct GPUSurfaceSoftwareTiling {
+  // Edge length of the square tiles in pixels. Zero disables tiling.
+  int tile_size = 0;
+  // Threads that rasterize tiles, including the raster thread. Zero uses one
+  // thread per CPU core.
+  size_t thread_count = 0;
+};
+
 class GPUSurfaceSoftware : public Surface {
  public:
   GPUSurfaceSoftware(GPUSurfaceSoftwareDelegate* delegate,
-                     bool render_to_surface);
+                     bool render_to_surface,
+                     const GPUSurfaceSoftwareTiling& tiling = {});
 
   ~GPUSurfaceSoftware() override;
 
@@ -38,8 +53,25 @@ class GPUSurfaceSoftware : public Surface {
   // hack to make avoid allocating resources for the root surface when an
   // external view embedder is present.
   const bool render_to_surface_;
+  const GPUSurfaceSoftwareTiling tiling_;
+  // Workers helping the raster thread with tiles. Created on first use.
+  std::shared_ptr<fml::ConcurrentMessageLoop> tile_loop_;
+  // The backing store presented last and its generation at that time. If the
+  // delegate hands it out again unchanged, its pixels can be reused.
+  sk_sp<SkSurface> last_backing_store_;
+  uint32_t last_generation_id_ = 0;
   fml::WeakPtrFactory<GPUSurfaceSoftware> weak_factory_;
 
+  std::unique_ptr<SurfaceFrame> AcquireTiledFrame(
+      sk_sp<SkSurface> backing_store);
+
+  // Plays |picture| back into the part of |backing_store| covered by
+  // |dirty_rect|, split into tiles when |can_split| is set.
+  void RasterizeTiles(SkSurface* backing_store, const SkPicture& picture,
+                      const SkIRect& dirty_rect, bool can_split);
+
+  bool PresentFrame(const SurfaceFrame& surface_frame);
+
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceSoftware);
 };
 
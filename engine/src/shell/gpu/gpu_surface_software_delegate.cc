@@ -4,6 +4,15 @@ namespace uiwidgets {
 
 GPUSurfaceSoftwareDelegate::~GPUSurfaceSoftwareDelegate() = default;
 
+bool GPUSurfaceSoftwareDelegate::PresentBackingStoreRegion(
+    sk_sp<SkSurface> backing_store, const SkIRect& damage) {
+  return PresentBackingStore(std::move(backing_store));
+}
+
+bool GPUSurfaceSoftwareDelegate::BackingStorePreservesContents() const {
+  return false;
+}
+
 ExternalViewEmbedder* GPUSurfaceSoftwareDelegate::GetExternalViewEmbedder() {
   return nullptr;
 }
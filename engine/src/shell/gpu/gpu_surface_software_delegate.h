@@ -17,6 +17,15 @@ class GPUSurfaceSoftwareDelegate : public GPUSurfaceDelegate {
   virtual sk_sp<SkSurface> AcquireBackingStore(const SkISize& size) = 0;
 
   virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store) = 0;
+
+  // Presents a backing store of which only |damage| changed since it was last
+  // presented. Delegates that can update just that region should override it.
+  virtual bool PresentBackingStoreRegion(sk_sp<SkSurface> backing_store,
+                                         const SkIRect& damage);
+
+  // Whether a backing store returned again by AcquireBackingStore still holds
+  // the pixels it had when it was last presented.
+  virtual bool BackingStorePreservesContents() const;
 };
 
 }  // namespace uiwidgets
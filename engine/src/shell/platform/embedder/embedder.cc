@@ -2,6 +2,7 @@
 
 #include "embedder.h"
 
+#include <cstddef>
 #include <iostream>
 
 #include "assets/directory_asset_bundle.h"
@@ -76,11 +77,15 @@ static bool IsSoftwareRendererConfigValid(
 
   const UIWidgetsSoftwareRendererConfig* software_config = &config->software;
 
-  if (software_config->surface_present_callback == nullptr) {
-    return false;
+  if (software_config->surface_present_callback != nullptr) {
+    return true;
   }
 
-  return true;
+  return software_config->struct_size >=
+             offsetof(UIWidgetsSoftwareRendererConfig,
+                      surface_present_frame_callback) +
+                 sizeof(SoftwareSurfacePresentFrameCallback) &&
+         software_config->surface_present_frame_callback != nullptr;
 }
 
 static bool IsRendererValid(const UIWidgetsRendererConfig* config) {
@@ -217,23 +222,67 @@ InferSoftwarePlatformViewCreationCallback(
     return nullptr;
   }
 
-  auto software_present_backing_store =
-      [ptr = config->software.surface_present_callback, user_data](
-          const void* allocation, size_t row_bytes, size_t height) -> bool {
-    return ptr(user_data, allocation, row_bytes, height);
-  };
+  std::function<bool(const void*, size_t, size_t, size_t)>
+      software_present_backing_store;
+  if (config->software.struct_size >=
+          offsetof(UIWidgetsSoftwareRendererConfig,
+                   surface_present_frame_callback) +
+              sizeof(SoftwareSurfacePresentFrameCallback) &&
+      config->software.surface_present_frame_callback != nullptr) {
+    software_present_backing_store =
+        [ptr = config->software.surface_present_frame_callback, user_data](
+            const void* allocation, size_t row_bytes, size_t width,
+            size_t height) -> bool {
+      return ptr(user_data, allocation, row_bytes, width, height);
+    };
+  } else {
+    software_present_backing_store =
+        [ptr = config->software.surface_present_callback, user_data](
+            const void* allocation, size_t row_bytes, size_t width,
+            size_t height) -> bool {
+      return ptr(user_data, allocation, row_bytes, height);
+    };
+  }
+
+  std::function<bool(const void*, size_t, size_t, const SkIRect&)>
+      software_present_backing_store_region;
+  if (config->software.struct_size >=
+          offsetof(UIWidgetsSoftwareRendererConfig,
+                   surface_present_region_callback) +
+              sizeof(SoftwareSurfacePresentRegionCallback) &&
+      config->software.surface_present_region_callback != nullptr) {
+    software_present_backing_store_region =
+        [ptr = config->software.surface_present_region_callback, user_data](
+            const void* allocation, size_t row_bytes, size_t height,
+            const SkIRect& damage) -> bool {
+      UIWidgetsDamageRect rect = {damage.left(), damage.top(), damage.right(),
+                                  damage.bottom()};
+      return ptr(user_data, allocation, row_bytes, height, &rect);
+    };
+  }
 
   EmbedderSurfaceSoftware::SoftwareDispatchTable software_dispatch_table = {
-      software_present_backing_store,  // required
+      software_present_backing_store,         // required
+      software_present_backing_store_region,  // optional
   };
 
-  return fml::MakeCopyable([software_dispatch_table, platform_dispatch_table,
+  GPUSurfaceSoftwareTiling tiling;
+  if (config->software.struct_size >=
+      offsetof(UIWidgetsSoftwareRendererConfig, raster_thread_count) +
+          sizeof(size_t)) {
+    tiling.tile_size = static_cast<int>(config->software.raster_tile_size);
+    tiling.thread_count = config->software.raster_thread_count;
+  }
+
+  return fml::MakeCopyable([software_dispatch_table, tiling,
+                            platform_dispatch_table,
                             external_view_embedder = std::move(
                                 external_view_embedder)](Shell& shell) mutable {
     return std::make_unique<PlatformViewEmbedder>(
         shell,                             // delegate
         shell.GetTaskRunners(),            // task runners
         software_dispatch_table,           // software dispatch table
+        tiling,                            // software tiling
         platform_dispatch_table,           // platform dispatch table
         std::move(external_view_embedder)  // external view embedder
     );
@@ -563,6 +612,15 @@ UIWidgetsEngineResult UIWidgetsEngineInitialize(
   settings.assets_path = args->assets_path;
   settings.font_data = args->font_asset;
 
+  if (config->type == kSoftware &&
+      config->software.struct_size >=
+          offsetof(UIWidgetsSoftwareRendererConfig,
+                   raster_cache_async_population) +
+              sizeof(bool)) {
+    settings.raster_cache_async_population =
+        config->software.raster_cache_async_population;
+  }
+
   settings.task_observer_add = [task_observer_add = args->task_observer_add,
                                 user_data](intptr_t key,
                                            fml::closure callback) {
@@ -81,6 +81,19 @@ typedef bool (*SoftwareSurfacePresentCallback)(void* /* user data */,
                                                const void* /* allocation */,
                                                size_t /* row bytes */,
                                                size_t /* height */);
+typedef struct {
+  int32_t left;
+  int32_t top;
+  int32_t right;
+  int32_t bottom;
+} UIWidgetsDamageRect;
+typedef bool (*SoftwareSurfacePresentRegionCallback)(
+    void* /* user data */, const void* /* allocation */,
+    size_t /* row bytes */, size_t /* height */,
+    const UIWidgetsDamageRect* /* damage */);
+typedef bool (*SoftwareSurfacePresentFrameCallback)(
+    void* /* user data */, const void* /* allocation */,
+    size_t /* row bytes */, size_t /* width */, size_t /* height */);
 typedef void* (*ProcResolver)(void* /* user data */, const char* /* name */);
 typedef bool (*TextureFrameCallback)(void* /* user data */,
                                      int64_t /* texture identifier */,
@@ -104,6 +117,22 @@ typedef struct {
 typedef struct {
   size_t struct_size;
   SoftwareSurfacePresentCallback surface_present_callback;
+  // Optional. Called instead of surface_present_callback when only the pixels
+  // inside the damage rect changed since the previous present. The allocation
+  // always holds the whole frame.
+  SoftwareSurfacePresentRegionCallback surface_present_region_callback;
+  // Optional. When non-zero, each frame is recorded and then rasterized in
+  // square tiles with this edge length in pixels on several threads.
+  size_t raster_tile_size;
+  // Optional. The number of threads rasterizing tiles, including the raster
+  // thread. Zero uses one thread per CPU core.
+  size_t raster_thread_count;
+  // Optional. Called instead of surface_present_callback, with the width of
+  // the frame in pixels as well.
+  SoftwareSurfacePresentFrameCallback surface_present_frame_callback;
+  // Optional. Rasterizes raster cache entries on the concurrent worker threads
+  // instead of during the frame that first uses them.
+  bool raster_cache_async_population;
 } UIWidgetsSoftwareRendererConfig;
 
 typedef struct {
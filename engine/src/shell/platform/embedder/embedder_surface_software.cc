@@ -7,8 +7,10 @@ namespace uiwidgets {
 
 EmbedderSurfaceSoftware::EmbedderSurfaceSoftware(
     SoftwareDispatchTable software_dispatch_table,
+    const GPUSurfaceSoftwareTiling& tiling,
     std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder)
     : software_dispatch_table_(software_dispatch_table),
+      tiling_(tiling),
       external_view_embedder_(std::move(external_view_embedder)) {
   if (!software_dispatch_table_.software_present_backing_store) {
     return;
@@ -27,7 +29,8 @@ std::unique_ptr<Surface> EmbedderSurfaceSoftware::CreateGPUSurface() {
     return nullptr;
   }
   const bool render_to_surface = !external_view_embedder_;
-  auto surface = std::make_unique<GPUSurfaceSoftware>(this, render_to_surface);
+  auto surface =
+      std::make_unique<GPUSurfaceSoftware>(this, render_to_surface, tiling_);
 
   if (!surface->IsValid()) {
     return nullptr;
@@ -69,37 +72,74 @@ sk_sp<SkSurface> EmbedderSurfaceSoftware::AcquireBackingStore(
   return sk_surface_;
 }
 
-// |GPUSurfaceSoftwareDelegate|
-bool EmbedderSurfaceSoftware::PresentBackingStore(
-    sk_sp<SkSurface> backing_store) {
+bool EmbedderSurfaceSoftware::PeekBackingStore(
+    const sk_sp<SkSurface>& backing_store, SkPixmap* pixmap) const {
   if (!IsValid()) {
     FML_LOG(ERROR) << "Tried to present an invalid software surface.";
     return false;
   }
 
-  SkPixmap pixmap;
-  if (!backing_store->peekPixels(&pixmap)) {
+  if (!backing_store->peekPixels(pixmap)) {
     FML_LOG(ERROR) << "Could not peek the pixels of the backing store.";
     return false;
   }
 
   // Some basic sanity checking.
-  uint64_t expected_pixmap_data_size = pixmap.width() * pixmap.height() * 4;
+  uint64_t expected_pixmap_data_size = pixmap->width() * pixmap->height() * 4;
 
-  const size_t pixmap_size = pixmap.computeByteSize();
+  const size_t pixmap_size = pixmap->computeByteSize();
 
   if (expected_pixmap_data_size != pixmap_size) {
     FML_LOG(ERROR) << "Software backing store had unexpected size.";
     return false;
   }
 
+  return true;
+}
+
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::PresentBackingStore(
+    sk_sp<SkSurface> backing_store) {
+  SkPixmap pixmap;
+  if (!PeekBackingStore(backing_store, &pixmap)) {
+    return false;
+  }
+
   return software_dispatch_table_.software_present_backing_store(
       pixmap.addr(),      //
       pixmap.rowBytes(),  //
+      pixmap.width(),     //
       pixmap.height()     //
   );
 }
 
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::PresentBackingStoreRegion(
+    sk_sp<SkSurface> backing_store, const SkIRect& damage) {
+  if (!software_dispatch_table_.software_present_backing_store_region) {
+    return PresentBackingStore(std::move(backing_store));
+  }
+
+  SkPixmap pixmap;
+  if (!PeekBackingStore(backing_store, &pixmap)) {
+    return false;
+  }
+
+  return software_dispatch_table_.software_present_backing_store_region(
+      pixmap.addr(),      //
+      pixmap.rowBytes(),  //
+      pixmap.height(),    //
+      damage              //
+  );
+}
+
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::BackingStorePreservesContents() const {
+  // The backing store is owned by this surface and reused as long as the
+  // frame size does not change.
+  return true;
+}
+
 // |GPUSurfaceSoftwareDelegate|
 ExternalViewEmbedder* EmbedderSurfaceSoftware::GetExternalViewEmbedder() {
   return external_view_embedder_.get();
@@ -11,12 +11,17 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
                                       public GPUSurfaceSoftwareDelegate {
  public:
   struct SoftwareDispatchTable {
-    std::function<bool(const void* allocation, size_t row_bytes, size_t height)>
+    std::function<bool(const void* allocation, size_t row_bytes, size_t width,
+                       size_t height)>
         software_present_backing_store;  // required
+    std::function<bool(const void* allocation, size_t row_bytes, size_t height,
+                       const SkIRect& damage)>
+        software_present_backing_store_region;  // optional
   };
 
   EmbedderSurfaceSoftware(
       SoftwareDispatchTable software_dispatch_table,
+      const GPUSurfaceSoftwareTiling& tiling,
       std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder);
 
   ~EmbedderSurfaceSoftware() override;
@@ -24,6 +29,7 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
  private:
   bool valid_ = false;
   SoftwareDispatchTable software_dispatch_table_;
+  const GPUSurfaceSoftwareTiling tiling_;
   sk_sp<SkSurface> sk_surface_;
   std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder_;
 
@@ -42,9 +48,19 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
   // |GPUSurfaceSoftwareDelegate|
   bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
 
+  // |GPUSurfaceSoftwareDelegate|
+  bool PresentBackingStoreRegion(sk_sp<SkSurface> backing_store,
+                                 const SkIRect& damage) override;
+
+  // |GPUSurfaceSoftwareDelegate|
+  bool BackingStorePreservesContents() const override;
+
   // |GPUSurfaceSoftwareDelegate|
   ExternalViewEmbedder* GetExternalViewEmbedder() override;
 
+  bool PeekBackingStore(const sk_sp<SkSurface>& backing_store,
+                        SkPixmap* pixmap) const;
+
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderSurfaceSoftware);
 };
 
@@ -16,11 +16,12 @@ PlatformViewEmbedder::PlatformViewEmbedder(
 PlatformViewEmbedder::PlatformViewEmbedder(
     Delegate& delegate, TaskRunners task_runners,
     EmbedderSurfaceSoftware::SoftwareDispatchTable software_dispatch_table,
+    const GPUSurfaceSoftwareTiling& tiling,
     PlatformDispatchTable platform_dispatch_table,
     std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder)
     : PlatformView(delegate, std::move(task_runners)),
       embedder_surface_(std::make_unique<EmbedderSurfaceSoftware>(
-          software_dispatch_table, std::move(external_view_embedder))),
+          software_dispatch_table, tiling, std::move(external_view_embedder))),
       platform_dispatch_table_(platform_dispatch_table) {}
 
 PlatformViewEmbedder::~PlatformViewEmbedder() = default;
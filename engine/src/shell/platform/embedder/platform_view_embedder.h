@@ -35,6 +35,7 @@ class PlatformViewEmbedder final : public PlatformView {
   PlatformViewEmbedder(
       PlatformView::Delegate& delegate, TaskRunners task_runners,
       EmbedderSurfaceSoftware::SoftwareDispatchTable software_dispatch_table,
+      const GPUSurfaceSoftwareTiling& tiling,
       PlatformDispatchTable platform_dispatch_table,
       std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder);
 
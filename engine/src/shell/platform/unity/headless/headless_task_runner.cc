@@ -0,0 +1,134 @@
+#include "headless_task_runner.h"
+
+#include <flutter/fml/logging.h>
+#include <flutter/fml/time/time_point.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace uiwidgets {
+
+HeadlessTaskRunner::HeadlessTaskRunner(
+    const TaskExpiredCallback& on_task_expired)
+    : on_task_expired_(on_task_expired) {
+  thread_ = std::thread([this]() { Run(); });
+}
+
+HeadlessTaskRunner::~HeadlessTaskRunner() {
+  {
+    std::lock_guard<std::mutex> lock(task_queue_mutex_);
+    terminated_ = true;
+  }
+  task_queue_cv_.notify_one();
+
+  FML_DCHECK(!RunsTasksOnCurrentThread());
+  thread_.join();
+}
+
+bool HeadlessTaskRunner::RunsTasksOnCurrentThread() const {
+  return std::this_thread::get_id() == thread_.get_id();
+}
+
+void HeadlessTaskRunner::Run() {
+  std::vector<Task> expired_tasks;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(task_queue_mutex_);
+      while (!terminated_ && expired_tasks.empty()) {
+        const TaskTimePoint now = TaskTimePoint::clock::now();
+        while (!task_queue_.empty() && task_queue_.top().fire_time <= now) {
+          expired_tasks.push_back(task_queue_.top());
+          task_queue_.pop();
+        }
+        if (!expired_tasks.empty()) {
+          break;
+        }
+
+        if (task_queue_.empty()) {
+          task_queue_cv_.wait(lock);
+        } else {
+          task_queue_cv_.wait_until(lock, task_queue_.top().fire_time);
+        }
+      }
+      if (terminated_) {
+        return;
+      }
+    }
+
+    // Fire expired tasks without holding onto the task queue mutex so that
+    // other threads do not block on posting tasks to this thread.
+    for (const auto& task : expired_tasks) {
+      if (task.closure) {
+        task.closure();
+      } else {
+        on_task_expired_(&task.task);
+      }
+
+      for (const auto& observer : task_observers_) {
+        observer.second();
+      }
+    }
+    expired_tasks.clear();
+  }
+}
+
+HeadlessTaskRunner::TaskTimePoint
+HeadlessTaskRunner::TimePointFromUIWidgetsTime(
+    uint64_t uiwidgets_target_time_nanos) {
+  const auto fml_now = fml::TimePoint::Now().ToEpochDelta().ToNanoseconds();
+  if (uiwidgets_target_time_nanos <= fml_now) {
+    return {};
+  }
+  const auto uiwidgets_duration = uiwidgets_target_time_nanos - fml_now;
+  const auto now = TaskTimePoint::clock::now();
+  return now + std::chrono::nanoseconds(uiwidgets_duration);
+}
+
+void HeadlessTaskRunner::PostTask(UIWidgetsTask uiwidgets_task,
+                                  uint64_t uiwidgets_target_time_nanos) {
+  Task task;
+  task.fire_time = TimePointFromUIWidgetsTime(uiwidgets_target_time_nanos);
+  task.task = uiwidgets_task;
+  Enqueue(std::move(task));
+}
+
+void HeadlessTaskRunner::PostTask(const fml::closure& closure,
+                                  TaskTimePoint fire_time) {
+  Task task;
+  task.fire_time = fire_time;
+  task.task = {};
+  task.closure = closure;
+  Enqueue(std::move(task));
+}
+
+void HeadlessTaskRunner::Enqueue(Task task) {
+  static std::atomic_uint64_t sGlobalTaskOrder(0);
+  task.order = ++sGlobalTaskOrder;
+
+  {
+    std::lock_guard<std::mutex> lock(task_queue_mutex_);
+    task_queue_.push(std::move(task));
+
+    // Make sure the queue mutex is unlocked before waking up the loop. In case
+    // the wake causes this thread to be descheduled for the runner thread to
+    // process tasks, the acquisition of the lock on that thread while holding
+    // the lock here momentarily till the end of the scope is a pessimization.
+  }
+
+  task_queue_cv_.notify_one();
+}
+
+void HeadlessTaskRunner::AddTaskObserver(intptr_t key,
+                                         const fml::closure& callback) {
+  FML_DCHECK(RunsTasksOnCurrentThread());
+  task_observers_[key] = callback;
+}
+
+void HeadlessTaskRunner::RemoveTaskObserver(intptr_t key) {
+  FML_DCHECK(RunsTasksOnCurrentThread());
+  task_observers_.erase(key);
+}
+
+}  // namespace uiwidgets
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <flutter/fml/closure.h>
+#include <flutter/fml/macros.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include "shell/platform/embedder/embedder.h"
+
+namespace uiwidgets {
+
+// Runs engine tasks on a thread of its own. Unlike the panels driven by the
+// Unity player loop, nothing has to pump this runner.
+class HeadlessTaskRunner {
+ public:
+  using TaskExpiredCallback = std::function<void(const UIWidgetsTask*)>;
+
+  explicit HeadlessTaskRunner(const TaskExpiredCallback& on_task_expired);
+
+  // Drops the pending tasks and joins the thread.
+  ~HeadlessTaskRunner();
+
+  // Returns if the current thread is the thread owned by this runner.
+  bool RunsTasksOnCurrentThread() const;
+
+  // Post a UIWidgets engine task to the loop for delayed execution.
+  void PostTask(UIWidgetsTask uiwidgets_task,
+                uint64_t uiwidgets_target_time_nanos);
+
+  // Post an embedder closure to the loop, ordered with the engine tasks.
+  void PostTask(const fml::closure& closure,
+                std::chrono::steady_clock::time_point fire_time = {});
+
+  // Only called on the runner thread.
+  void AddTaskObserver(intptr_t key, const fml::closure& callback);
+
+  // Only called on the runner thread.
+  void RemoveTaskObserver(intptr_t key);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(HeadlessTaskRunner);
+
+ private:
+  using TaskTimePoint = std::chrono::steady_clock::time_point;
+
+  struct Task {
+    uint64_t order;
+    TaskTimePoint fire_time;
+    UIWidgetsTask task;
+    fml::closure closure;
+
+    struct Comparer {
+      bool operator()(const Task& a, const Task& b) {
+        if (a.fire_time == b.fire_time) {
+          return a.order > b.order;
+        }
+        return a.fire_time > b.fire_time;
+      }
+    };
+  };
+
+  void Run();
+
+  void Enqueue(Task task);
+
+  TaskExpiredCallback on_task_expired_;
+  std::mutex task_queue_mutex_;
+  std::priority_queue<Task, std::deque<Task>, Task::Comparer> task_queue_;
+  std::condition_variable task_queue_cv_;
+  bool terminated_ = false;
+
+  using TaskObservers = std::map<intptr_t, fml::closure>;
+  TaskObservers task_observers_;
+
+  std::thread thread_;
+
+  static TaskTimePoint TimePointFromUIWidgetsTime(
+      uint64_t uiwidgets_target_time_nanos);
+};
+
+}  // namespace uiwidgets
@@ -0,0 +1,355 @@
+#include "uiwidgets_headless_panel.h"
+
+#include <flutter/fml/build_config.h>
+#include <flutter/fml/synchronization/waitable_event.h>
+#include <flutter/fml/time/time_point.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "shell/common/switches.h"
+#include "shell/platform/embedder/embedder_engine.h"
+
+namespace uiwidgets {
+
+namespace {
+
+constexpr std::chrono::nanoseconds kDefaultFrameInterval(1000000000 / 60);
+
+}  // namespace
+
+fml::RefPtr<UIWidgetsHeadlessPanel> UIWidgetsHeadlessPanel::Create(
+    Mono_Handle handle, EntrypointCallback entrypoint_callback,
+    FrameCallback frame_callback) {
+  return fml::MakeRefCounted<UIWidgetsHeadlessPanel>(
+      handle, entrypoint_callback, frame_callback);
+}
+
+UIWidgetsHeadlessPanel::UIWidgetsHeadlessPanel(
+    Mono_Handle handle, EntrypointCallback entrypoint_callback,
+    FrameCallback frame_callback)
+    : handle_(handle),
+      entrypoint_callback_(entrypoint_callback),
+      frame_callback_(frame_callback) {}
+
+UIWidgetsHeadlessPanel::~UIWidgetsHeadlessPanel() = default;
+
+bool UIWidgetsHeadlessPanel::OnEnable(size_t width, size_t height,
+                                      float device_pixel_ratio,
+                                      const char* streaming_assets_path,
+                                      const char* settings,
+                                      int max_frame_rate,
+                                      size_t raster_tile_size,
+                                      bool raster_cache_async_population) {
+  FML_DCHECK(!task_runner_);
+
+  frame_interval_ =
+      max_frame_rate > 0
+          ? std::chrono::nanoseconds(1000000000 / max_frame_rate)
+          : std::chrono::nanoseconds::zero();
+  next_vsync_time_ = {};
+  frame_count_ = 0;
+
+  task_runner_ =
+      std::make_unique<HeadlessTaskRunner>([this](const auto* task) {
+        if (engine_ == nullptr) {
+          return;
+        }
+        if (UIWidgetsEngineRunTask(engine_, task) != kSuccess) {
+          std::cerr << "Could not post an engine task." << std::endl;
+        }
+      });
+
+  // The engine is created on the thread that serves as its platform thread,
+  // as the other panels do on the Unity main thread.
+  bool started = false;
+  fml::AutoResetWaitableEvent latch;
+  task_runner_->PostTask([&]() {
+    started = StartEngine(width, height, device_pixel_ratio,
+                          streaming_assets_path, settings, raster_tile_size,
+                          raster_cache_async_population);
+    latch.Signal();
+  });
+  latch.Wait();
+
+  if (!started) {
+    task_runner_ = nullptr;
+  }
+  return started;
+}
+
+bool UIWidgetsHeadlessPanel::StartEngine(size_t width, size_t height,
+                                         float device_pixel_ratio,
+                                         const char* streaming_assets_path,
+                                         const char* settings,
+                                         size_t raster_tile_size,
+                                         bool raster_cache_async_population) {
+  UIWidgetsRendererConfig config = {};
+  config.type = kSoftware;
+  config.software.struct_size = sizeof(config.software);
+  config.software.surface_present_frame_callback =
+      [](void* user_data, const void* allocation, size_t row_bytes,
+         size_t width, size_t height) -> bool {
+    auto* panel = static_cast<UIWidgetsHeadlessPanel*>(user_data);
+    return panel->PresentFrame(allocation, row_bytes, width, height);
+  };
+  config.software.raster_tile_size = raster_tile_size;
+  config.software.raster_cache_async_population =
+      raster_cache_async_population;
+
+  UIWidgetsTaskRunnerDescription ui_task_runner = {};
+  ui_task_runner.struct_size = sizeof(UIWidgetsTaskRunnerDescription);
+  ui_task_runner.identifier = 1;
+  ui_task_runner.user_data = task_runner_.get();
+  ui_task_runner.runs_task_on_current_thread_callback =
+      [](void* user_data) -> bool {
+    return static_cast<HeadlessTaskRunner*>(user_data)
+        ->RunsTasksOnCurrentThread();
+  };
+  ui_task_runner.post_task_callback = [](UIWidgetsTask task,
+                                         uint64_t target_time_nanos,
+                                         void* user_data) -> void {
+    static_cast<HeadlessTaskRunner*>(user_data)->PostTask(task,
+                                                          target_time_nanos);
+  };
+
+  // Leaving out the render task runner makes the engine start a raster
+  // thread of its own.
+  UIWidgetsCustomTaskRunners custom_task_runners = {};
+  custom_task_runners.struct_size = sizeof(UIWidgetsCustomTaskRunners);
+  custom_task_runners.platform_task_runner = &ui_task_runner;
+  custom_task_runners.ui_task_runner = &ui_task_runner;
+
+  UIWidgetsProjectArgs args = {};
+  args.struct_size = sizeof(UIWidgetsProjectArgs);
+
+  args.assets_path = streaming_assets_path;
+  args.font_asset = settings;
+#if OS_ANDROID || OS_WIN
+  args.icu_mapper = GetICUStaticMapping;
+#endif
+  // Elsewhere the ICU data is linked into the library, as for the macOS and
+  // iOS panels, and ICU finds it without being initialized by the shell.
+  args.command_line_argc = 0;
+  args.command_line_argv = nullptr;
+
+  args.platform_message_callback =
+      [](const UIWidgetsPlatformMessage* engine_message,
+         void* user_data) -> void {};
+
+  args.custom_task_runners = &custom_task_runners;
+  args.task_observer_add = [](intptr_t key, void* callback,
+                              void* user_data) -> void {
+    auto* panel = static_cast<UIWidgetsHeadlessPanel*>(user_data);
+    panel->task_runner_->AddTaskObserver(key,
+                                         *static_cast<fml::closure*>(callback));
+  };
+  args.task_observer_remove = [](intptr_t key, void* user_data) -> void {
+    auto* panel = static_cast<UIWidgetsHeadlessPanel*>(user_data);
+    panel->task_runner_->RemoveTaskObserver(key);
+  };
+
+  args.custom_mono_entrypoint = [](void* user_data) -> void {
+    auto* panel = static_cast<UIWidgetsHeadlessPanel*>(user_data);
+    panel->MonoEntrypoint();
+  };
+
+  args.vsync_callback = [](void* user_data, intptr_t baton) -> void {
+    auto* panel = static_cast<UIWidgetsHeadlessPanel*>(user_data);
+    panel->VSyncCallback(baton);
+  };
+
+  args.initial_window_metrics.width = width;
+  args.initial_window_metrics.height = height;
+  args.initial_window_metrics.pixel_ratio = device_pixel_ratio;
+
+  UIWidgetsEngine engine = nullptr;
+  auto result = UIWidgetsEngineRun(&config, &args, this, &engine);
+
+  if (result != kSuccess || engine == nullptr) {
+    std::cerr << "Failed to start UIWidgets engine: error " << result
+              << std::endl;
+    if (engine != nullptr) {
+      UIWidgetsEngineShutdown(engine);
+    }
+    return false;
+  }
+
+  std::scoped_lock lock(engine_mutex_);
+  engine_ = engine;
+  return true;
+}
+
+void UIWidgetsHeadlessPanel::MonoEntrypoint() { entrypoint_callback_(handle_); }
+
+void UIWidgetsHeadlessPanel::OnDisable() {
+  if (!task_runner_) {
+    return;
+  }
+
+  fml::AutoResetWaitableEvent latch;
+  task_runner_->PostTask([this, &latch]() {
+    if (engine_) {
+      std::scoped_lock lock(engine_mutex_);
+      UIWidgetsEngineShutdown(engine_);
+      engine_ = nullptr;
+    }
+    latch.Signal();
+  });
+  latch.Wait();
+
+  // Joins the thread; the vsync and engine tasks still queued are dropped.
+  task_runner_ = nullptr;
+}
+
+void UIWidgetsHeadlessPanel::SetViewport(size_t width, size_t height,
+                                         float device_pixel_ratio) {
+  if (!task_runner_) {
+    return;
+  }
+
+  UIWidgetsWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = width;
+  event.height = height;
+  event.pixel_ratio = device_pixel_ratio;
+
+  task_runner_->PostTask([this, event]() {
+    if (engine_) {
+      UIWidgetsEngineSendWindowMetricsEvent(engine_, &event);
+    }
+  });
+}
+
+void UIWidgetsHeadlessPanel::SendPointerEvents(
+    const UIWidgetsPointerEvent* events, size_t count) {
+  if (!task_runner_ || events == nullptr || count == 0) {
+    return;
+  }
+
+  std::vector<UIWidgetsPointerEvent> pending(events, events + count);
+  for (auto& event : pending) {
+    event.struct_size = sizeof(event);
+  }
+
+  task_runner_->PostTask([this, pending = std::move(pending)]() {
+    if (engine_) {
+      UIWidgetsEngineSendPointerEvent(engine_, pending.data(), pending.size());
+    }
+  });
+}
+
+void UIWidgetsHeadlessPanel::VSyncCallback(intptr_t baton) {
+  // Called on the ui thread, which is also the thread answering the request.
+  const auto now = std::chrono::steady_clock::now();
+  const auto fire_time = std::max(now, next_vsync_time_);
+  next_vsync_time_ = fire_time + frame_interval_;
+
+  const auto target_interval = frame_interval_.count() > 0
+                                   ? frame_interval_
+                                   : kDefaultFrameInterval;
+
+  task_runner_->PostTask(
+      [this, baton, target_interval]() {
+        if (engine_ == nullptr) {
+          return;
+        }
+        const uint64_t frame_start_time_nanos =
+            fml::TimePoint::Now().ToEpochDelta().ToNanoseconds();
+        UIWidgetsEngineOnVsync(
+            engine_, baton, frame_start_time_nanos,
+            frame_start_time_nanos + target_interval.count());
+      },
+      fire_time);
+}
+
+std::string UIWidgetsHeadlessPanel::GetFrameStageTimings(bool reset) {
+  std::scoped_lock lock(engine_mutex_);
+  if (engine_ == nullptr) {
+    return std::string();
+  }
+  return reinterpret_cast<EmbedderEngine*>(engine_)
+      ->GetShell()
+      .GetFrameStageTimings(reset);
+}
+
+bool UIWidgetsHeadlessPanel::PresentFrame(const void* allocation,
+                                          size_t row_bytes, size_t width,
+                                          size_t height) {
+  const int64_t frame_number = ++frame_count_;
+  if (frame_callback_) {
+    frame_callback_(handle_, allocation, row_bytes, width, height,
+                    frame_number);
+  }
+  return true;
+}
+
+UIWIDGETS_API(UIWidgetsHeadlessPanel*)
+UIWidgetsHeadlessPanel_constructor(
+    Mono_Handle handle,
+    UIWidgetsHeadlessPanel::EntrypointCallback entrypoint_callback,
+    UIWidgetsHeadlessPanel::FrameCallback frame_callback) {
+  const auto panel = UIWidgetsHeadlessPanel::Create(
+      handle, entrypoint_callback, frame_callback);
+  panel->AddRef();
+  return panel.get();
+}
+
+UIWIDGETS_API(void)
+UIWidgetsHeadlessPanel_dispose(UIWidgetsHeadlessPanel* panel) {
+  panel->Release();
+}
+
+UIWIDGETS_API(bool)
+UIWidgetsHeadlessPanel_onEnable(UIWidgetsHeadlessPanel* panel, size_t width,
+                                size_t height, float device_pixel_ratio,
+                                const char* streaming_assets_path,
+                                const char* settings, int max_frame_rate,
+                                size_t raster_tile_size,
+                                bool raster_cache_async_population) {
+  return panel->OnEnable(width, height, device_pixel_ratio,
+                         streaming_assets_path, settings, max_frame_rate,
+                         raster_tile_size, raster_cache_async_population);
+}
+
+UIWIDGETS_API(void)
+UIWidgetsHeadlessPanel_onDisable(UIWidgetsHeadlessPanel* panel) {
+  panel->OnDisable();
+}
+
+UIWIDGETS_API(void)
+UIWidgetsHeadlessPanel_setViewport(UIWidgetsHeadlessPanel* panel, int width,
+                                   int height, float device_pixel_ratio) {
+  panel->SetViewport(width, height, device_pixel_ratio);
+}
+
+UIWIDGETS_API(void)
+UIWidgetsHeadlessPanel_sendPointerEvents(UIWidgetsHeadlessPanel* panel,
+                                         const UIWidgetsPointerEvent* events,
+                                         int count) {
+  if (count > 0) {
+    panel->SendPointerEvents(events, count);
+  }
+}
+
+UIWIDGETS_API(int64_t)
+UIWidgetsHeadlessPanel_getFrameCount(UIWidgetsHeadlessPanel* panel) {
+  return panel->GetFrameCount();
+}
+
+UIWIDGETS_API(char*)
+UIWidgetsHeadlessPanel_getFrameStageTimings(UIWidgetsHeadlessPanel* panel,
+                                            bool reset) {
+  const std::string timings = panel->GetFrameStageTimings(reset);
+  size_t size = timings.length() + 1;
+  char* result = static_cast<char*>(malloc(size));
+  strcpy(result, timings.c_str());
+  return result;
+}
+
+UIWIDGETS_API(void)
+UIWidgetsHeadlessPanel_freeFrameStageTimings(char* timings) { free(timings); }
+
+}  // namespace uiwidgets
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <flutter/fml/memory/ref_counted.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "headless_task_runner.h"
+#include "runtime/mono_api.h"
+
+namespace uiwidgets {
+
+// Runs an engine without a Unity graphics device. Frames are rasterized in
+// software and handed out through |FrameCallback|, and vsync is synthesized
+// so that the UI can run at a fixed or at the maximum frame rate.
+//
+// The platform and ui tasks run on a thread owned by the panel, and the
+// raster thread is created by the engine.
+class UIWidgetsHeadlessPanel
+    : public fml::RefCountedThreadSafe<UIWidgetsHeadlessPanel> {
+  FML_FRIEND_MAKE_REF_COUNTED(UIWidgetsHeadlessPanel);
+
+ public:
+  typedef void (*EntrypointCallback)(Mono_Handle handle);
+
+  // Called on the raster thread for every presented frame. The pixels are
+  // kN32 premultiplied and point into the backing store of the engine, so
+  // they are only valid until the callback returns.
+  typedef void (*FrameCallback)(Mono_Handle handle, const void* pixels,
+                                size_t row_bytes, size_t width, size_t height,
+                                int64_t frame_number);
+
+  static fml::RefPtr<UIWidgetsHeadlessPanel> Create(
+      Mono_Handle handle, EntrypointCallback entrypoint_callback,
+      FrameCallback frame_callback);
+
+  ~UIWidgetsHeadlessPanel();
+
+  // A |max_frame_rate| of zero answers every vsync request immediately.
+  bool OnEnable(size_t width, size_t height, float device_pixel_ratio,
+                const char* streaming_assets_path, const char* settings,
+                int max_frame_rate, size_t raster_tile_size,
+                bool raster_cache_async_population);
+
+  void OnDisable();
+
+  void SetViewport(size_t width, size_t height, float device_pixel_ratio);
+
+  void SendPointerEvents(const UIWidgetsPointerEvent* events, size_t count);
+
+  int64_t GetFrameCount() const { return frame_count_; }
+
+  // Returns the per stage timings of the frames rendered since the last call
+  // with |reset| as JSON, or an empty string while the engine is not running.
+  std::string GetFrameStageTimings(bool reset);
+
+ private:
+  UIWidgetsHeadlessPanel(Mono_Handle handle,
+                         EntrypointCallback entrypoint_callback,
+                         FrameCallback frame_callback);
+
+  bool StartEngine(size_t width, size_t height, float device_pixel_ratio,
+                   const char* streaming_assets_path, const char* settings,
+                   size_t raster_tile_size,
+                   bool raster_cache_async_population);
+
+  void MonoEntrypoint();
+
+  void VSyncCallback(intptr_t baton);
+
+  bool PresentFrame(const void* allocation, size_t row_bytes, size_t width,
+                    size_t height);
+
+  Mono_Handle handle_;
+  EntrypointCallback entrypoint_callback_;
+  FrameCallback frame_callback_;
+
+  std::unique_ptr<HeadlessTaskRunner> task_runner_;
+  // Set and cleared on the panel thread, which reads it without the lock.
+  // Other threads read it with |engine_mutex_| held.
+  std::mutex engine_mutex_;
+  UIWidgetsEngine engine_ = nullptr;
+
+  std::chrono::nanoseconds frame_interval_ = std::chrono::nanoseconds::zero();
+  std::chrono::steady_clock::time_point next_vsync_time_;
+  std::atomic<int64_t> frame_count_ = 0;
+};
+
+}  // namespace uiwidgets